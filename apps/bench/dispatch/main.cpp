@@ -0,0 +1,332 @@
+// Static vs dynamic dispatch microbenchmark.
+//
+// Counts the nodes of an N-Queens or UTS (binomial) tree twice with the same
+// skeleton: once with the generator and enumerator deriving from the CRTP
+// StaticNodeGenerator/StaticEnumerator bases, and once deriving from the
+// virtual NodeGenerator/Enumerator adapters. The node code is shared, so the
+// difference in time is the cost of dispatch (and of the inlining it blocks)
+// in the skeleton's inner loop. Results are reported as JSON.
+//
+// Generators only provide next() so both variants generate children one call
+// at a time.
+
+#include <hpx/hpx_init.hpp>
+#include <hpx/include/iostreams.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include <boost/format.hpp>
+
+// We just use the default RNG for simplicity
+#define BRG_RNG
+#include "uts-rng/rng.h"
+
+#include "YewPar.hpp"
+#include "util/BitwiseNode.hpp"
+#include "skeletons/Seq.hpp"
+#include "skeletons/StackStealing.hpp"
+#include "skeletons/Budget.hpp"
+
+#ifndef BENCH_MAX_TREE_DEPTH
+#define BENCH_MAX_TREE_DEPTH 20000
+#endif
+
+const std::vector<std::string> skeletonNames = {"seq", "stacksteal", "budget"};
+
+// The same generator or enumerator, statically or dynamically dispatched
+template <bool Virtual, typename Derived, typename Node, typename Space>
+using GeneratorBase = std::conditional_t<Virtual,
+                                         YewPar::NodeGenerator<Node, Space>,
+                                         YewPar::StaticNodeGenerator<Derived, Node, Space> >;
+
+template <bool Virtual, typename Derived, typename Node, typename Result>
+using EnumeratorBase = std::conditional_t<Virtual,
+                                          YewPar::Enumerator<Node, Result>,
+                                          YewPar::StaticEnumerator<Derived, Node, Result> >;
+
+template <bool Virtual, typename Node>
+struct CountNodes : EnumeratorBase<Virtual, CountNodes<Virtual, Node>, Node, std::uint64_t> {
+  std::uint64_t count = 0;
+
+  void accumulate(const Node & n) { count++; }
+  void combine(const std::uint64_t & other) { count += other; }
+  std::uint64_t get() { return count; }
+};
+
+// N-Queens, as apps/enumeration/nqueens
+struct Empty {};
+
+struct QueensNode {
+  std::uint32_t all;
+  std::uint32_t ld;
+  std::uint32_t cols;
+  std::uint32_t rd;
+  std::uint32_t poss;
+};
+
+namespace hpx { namespace serialization {
+  template<class Archive>
+  void serialize(Archive & ar, QueensNode & x, const unsigned int version) {
+    ar & x.all;
+    ar & x.ld;
+    ar & x.cols;
+    ar & x.rd;
+    ar & x.poss;
+  }
+}}
+
+YEWPAR_BITWISE_NODE(QueensNode)
+
+template <bool Virtual>
+struct QueensGen : GeneratorBase<Virtual, QueensGen<Virtual>, QueensNode, Empty> {
+  QueensNode parent;
+
+  QueensGen(const Empty &, const QueensNode & parent) : parent(parent) {
+    this->numChildren = __builtin_popcount(parent.poss);
+  }
+
+  QueensNode next() {
+    auto bit = parent.poss & -parent.poss;
+    parent.poss -= bit;
+
+    auto ld = (parent.ld | bit) << 1;
+    auto cols = parent.cols | bit;
+    auto rd = (parent.rd | bit) >> 1;
+    return QueensNode { parent.all, ld, cols, rd, ~(ld | cols | rd) & parent.all };
+  }
+};
+
+// UTS binomial trees, as apps/enumeration/uts
+struct UTSParams {
+  double rootBF;
+  double nonLeafBF;
+  double nonLeafProb;
+
+  template <class Archive>
+  void serialize(Archive & ar, const unsigned int version) {
+    ar & rootBF;
+    ar & nonLeafBF;
+    ar & nonLeafProb;
+  }
+};
+
+namespace hpx { namespace serialization {
+template<class Archive>
+void serialize(Archive & ar, state_t & x, const unsigned int version) {
+  ar & x.state;
+}}}
+
+struct UTSNode {
+  bool isRoot;
+  int depth;
+  state_t rngstate;
+
+  template <class Archive>
+  void serialize(Archive & ar, const unsigned int version) {
+    ar & isRoot;
+    ar & depth;
+    ar & rngstate;
+  }
+};
+
+YEWPAR_BITWISE_NODE(UTSNode)
+
+template <bool Virtual>
+struct UTSGen : GeneratorBase<Virtual, UTSGen<Virtual>, UTSNode, UTSParams> {
+  UTSNode parent;
+  int i = 0;
+
+  UTSGen(const UTSParams & params, const UTSNode & parent) : parent(parent) {
+    if (parent.isRoot) {
+      this->numChildren = params.rootBF;
+    } else {
+      // Interpret the 31 bit random number as a value on [0,1)
+      auto d = rng_rand(this->parent.rngstate.state) / 2147483648.0;
+      this->numChildren = d < params.nonLeafProb ? params.nonLeafBF : 0;
+    }
+  }
+
+  UTSNode next() {
+    UTSNode child { false, parent.depth + 1 };
+    rng_spawn(parent.rngstate.state, child.rngstate.state, i);
+    ++i;
+    return child;
+  }
+};
+
+typedef YewPar::Skeletons::API::MaxStackDepth<std::integral_constant<unsigned, BENCH_MAX_TREE_DEPTH> > StackDepth;
+
+template <typename Generator, typename Enum>
+std::uint64_t runSearch(const std::string & skeleton,
+                        const typename Generator::Spacetype & space,
+                        const typename Generator::Nodetype & root,
+                        boost::program_options::variables_map & opts) {
+  YewPar::Skeletons::API::Params<> searchParameters;
+  if (skeleton == "seq") {
+    return YewPar::Skeletons::Seq<Generator,
+                                  YewPar::Skeletons::API::Enumeration,
+                                  YewPar::Skeletons::API::Enumerator<Enum>,
+                                  StackDepth>
+        ::search(space, root, searchParameters);
+  } else if (skeleton == "stacksteal") {
+    searchParameters.stealAll = static_cast<bool>(opts.count("chunked"));
+    return YewPar::Skeletons::StackStealing<Generator,
+                                            YewPar::Skeletons::API::Enumeration,
+                                            YewPar::Skeletons::API::Enumerator<Enum>,
+                                            StackDepth>
+        ::search(space, root, searchParameters);
+  } else if (skeleton == "budget") {
+    searchParameters.backtrackBudget = opts["backtrack-budget"].as<unsigned>();
+    return YewPar::Skeletons::Budget<Generator,
+                                     YewPar::Skeletons::API::Enumeration,
+                                     YewPar::Skeletons::API::Enumerator<Enum>,
+                                     StackDepth>
+        ::search(space, root, searchParameters);
+  }
+
+  throw std::invalid_argument("Invalid skeleton type: " + skeleton);
+}
+
+struct Run {
+  std::string dispatch;
+  std::uint64_t nodes;
+  std::vector<double> timesMs;
+  double bestMs;
+};
+
+template <typename Generator, typename Enum>
+Run timeSearch(const std::string & dispatch,
+               const std::string & skeleton,
+               const typename Generator::Spacetype & space,
+               const typename Generator::Nodetype & root,
+               boost::program_options::variables_map & opts) {
+  Run run { dispatch, 0 };
+  run.bestMs = 0;
+  auto repeats = std::max(opts["repeats"].as<unsigned>(), 1u);
+  for (auto i = 0u; i < repeats; ++i) {
+    auto start_time = std::chrono::steady_clock::now();
+    auto nodes = runSearch<Generator, Enum>(skeleton, space, root, opts);
+    auto time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+
+    run.timesMs.push_back(time);
+    if (i == 0 || time < run.bestMs) {
+      run.nodes = nodes;
+      run.bestMs = time;
+    }
+  }
+  return run;
+}
+
+std::string toJSON(const std::string & problem, const std::string & skeleton, const std::vector<Run> & runs) {
+  std::ostringstream os;
+  os << "{\n";
+  os << "  \"benchmark\": \"dispatch\",\n";
+  os << "  \"problem\": " << problem << ",\n";
+  os << "  \"skeleton\": \"" << skeleton << "\",\n";
+  os << "  \"threads\": " << hpx::get_os_thread_count() << ",\n";
+  os << "  \"runs\": [\n";
+  for (auto r = 0u; r < runs.size(); ++r) {
+    const auto & run = runs[r];
+    os << "    {\"dispatch\": \"" << run.dispatch << "\", ";
+    os << "\"nodes\": " << run.nodes << ", ";
+    os << "\"times_ms\": [";
+    for (auto i = 0u; i < run.timesMs.size(); ++i) {
+      os << (i ? ", " : "") << run.timesMs[i];
+    }
+    os << "], ";
+    os << "\"best_ms\": " << run.bestMs << ", ";
+    os << "\"nodes_per_sec\": " << static_cast<std::uint64_t>(run.nodes / (run.bestMs / 1000.0)) << "}";
+    os << (r + 1 < runs.size() ? "," : "") << "\n";
+  }
+  os << "  ],\n";
+
+  // Time of the virtual adapters relative to the static interfaces
+  const auto & stat = runs[0];
+  const auto & virt = runs[1];
+  os << "  \"summary\": {\"nodes\": " << stat.nodes
+     << ", \"consistent\": " << std::boolalpha << (stat.nodes == virt.nodes)
+     << ", \"speedup\": " << virt.bestMs / stat.bestMs << "}\n";
+  os << "}\n";
+  return os.str();
+}
+
+int hpx_main(boost::program_options::variables_map & opts) {
+  auto problem  = opts["problem"].as<std::string>();
+  auto skeleton = opts["skeleton"].as<std::string>();
+
+  if (std::find(skeletonNames.begin(), skeletonNames.end(), skeleton) == skeletonNames.end()) {
+    hpx::cout << "Invalid skeleton type: " << skeleton << hpx::endl;
+    return hpx::finalize();
+  }
+
+  std::vector<Run> runs;
+  std::string description;
+  if (problem == "nqueens") {
+    auto size = opts["size"].as<unsigned>();
+    auto all = (1u << size) - 1;
+    QueensNode root { all, 0, 0, 0, all };
+
+    runs.push_back(timeSearch<QueensGen<false>, CountNodes<false, QueensNode> >("static", skeleton, Empty(), root, opts));
+    runs.push_back(timeSearch<QueensGen<true>, CountNodes<true, QueensNode> >("virtual", skeleton, Empty(), root, opts));
+    description = (boost::format("{\"name\": \"nqueens\", \"size\": %1%}") % size).str();
+  } else if (problem == "uts") {
+    UTSParams params { opts["uts-b"].as<double>(), opts["uts-m"].as<double>(), opts["uts-q"].as<double>() };
+    UTSNode root { true, 0 };
+    rng_init(root.rngstate.state, opts["uts-r"].as<int>());
+
+    runs.push_back(timeSearch<UTSGen<false>, CountNodes<false, UTSNode> >("static", skeleton, params, root, opts));
+    runs.push_back(timeSearch<UTSGen<true>, CountNodes<true, UTSNode> >("virtual", skeleton, params, root, opts));
+    description = (boost::format("{\"name\": \"uts\", \"b\": %1%, \"m\": %2%, \"q\": %3%, \"r\": %4%}")
+                   % params.rootBF % params.nonLeafBF % params.nonLeafProb % opts["uts-r"].as<int>()).str();
+  } else {
+    hpx::cout << "Invalid problem: " << problem << hpx::endl;
+    return hpx::finalize();
+  }
+
+  hpx::cout << toJSON(description, skeleton, runs) << hpx::flush;
+
+  return hpx::finalize();
+}
+
+int main(int argc, char* argv[]) {
+  boost::program_options::options_description
+    desc_commandline("Usage: " HPX_APPLICATION_STRING " [options]");
+
+  desc_commandline.add_options()
+    ( "problem",
+      boost::program_options::value<std::string>()->default_value("nqueens"),
+      "Tree to count: nqueens or uts"
+    )
+    ( "skeleton",
+      boost::program_options::value<std::string>()->default_value("seq"),
+      "Which skeleton to use: seq, stacksteal or budget"
+    )
+    ( "size,n",
+      boost::program_options::value<unsigned>()->default_value(14),
+      "N-Queens board size"
+    )
+    ( "uts-b", boost::program_options::value<double>()->default_value(2000.0), "UTS: Root branching factor" )
+    ( "uts-q", boost::program_options::value<double>()->default_value(0.124875), "UTS: Probability of non-leaf node" )
+    ( "uts-m", boost::program_options::value<double>()->default_value(8.0), "UTS: Number of children for non-leaf node" )
+    ( "uts-r", boost::program_options::value<int>()->default_value(42), "UTS: Root seed" )
+    ( "repeats,r",
+      boost::program_options::value<unsigned>()->default_value(1),
+      "Times to run each variant (the fastest is reported)"
+    )
+    ( "backtrack-budget,b",
+      boost::program_options::value<unsigned>()->default_value(500),
+      "Number of backtracks before spawning work (budget only)"
+    )
+    ("chunked", "Use chunking with stack stealing");
+
+  YewPar::registerPerformanceCounters();
+
+  return hpx::init(desc_commandline, argc, argv);
+}
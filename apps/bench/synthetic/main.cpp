@@ -0,0 +1,513 @@
+// Synthetic tree search microbenchmarks.
+//
+// Searches (counts) trees of several shapes with every enumeration skeleton and
+// reports throughput and work stealing statistics as JSON. Trees are generated
+// deterministically from a seed, so every skeleton searches the same tree and
+// the node counts and checksums must agree.
+//
+// Shapes:
+//   uniform   - every node above --depth has --branching children
+//   geometric - UTS style: geometrically distributed children with mean
+//               --branching, shrinking linearly to 0 at --depth
+//   binomial  - UTS style: the root has --branching children, every other node
+//               has --m children with probability --q (and is a leaf otherwise)
+//   skewed    - child i of a node of height h has height h - 1 - i * --skew, so
+//               the first subtree of every node holds most of its nodes
+//   deep      - narrow and deep: nodes above --depth have a single child except
+//               one in every --period (on average), which has --branching
+//
+// Each expanded node costs --work rounds of hashing and nodes carry --payload
+// bytes, to model expensive node processing and large nodes.
+//
+// Threads are fixed for the life of an HPX process, so scaling runs launch this
+// benchmark once per thread count (see scaling.py next to this file).
+
+#include <hpx/hpx_init.hpp>
+#include <hpx/include/iostreams.hpp>
+#include <hpx/include/performance_counters.hpp>
+#include <hpx/runtime/serialization/vector.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <boost/algorithm/string.hpp>
+#include <boost/format.hpp>
+
+#include "YewPar.hpp"
+#include "skeletons/Seq.hpp"
+#include "skeletons/DepthBounded.hpp"
+#include "skeletons/StackStealing.hpp"
+#include "skeletons/Budget.hpp"
+#include "skeletons/Hybrid.hpp"
+
+#ifndef BENCH_MAX_TREE_DEPTH
+#define BENCH_MAX_TREE_DEPTH 20000
+#endif
+
+enum class Shape {
+  UNIFORM, GEOMETRIC, BINOMIAL, SKEWED, DEEP
+};
+
+const std::vector<std::string> shapeNames = {"uniform", "geometric", "binomial", "skewed", "deep"};
+const std::vector<std::string> skeletonNames = {"seq", "depthbounded", "stacksteal", "budget", "hybrid"};
+
+struct TreeParams {
+  Shape shape;
+  unsigned branching;
+  unsigned depth;
+  double q;
+  unsigned m;
+  unsigned skew;
+  unsigned period;
+  std::uint64_t work;
+  unsigned payload;
+
+  template <class Archive>
+  void serialize(Archive & ar, const unsigned int version) {
+    ar & shape;
+    ar & branching;
+    ar & depth;
+    ar & q;
+    ar & m;
+    ar & skew;
+    ar & period;
+    ar & work;
+    ar & payload;
+  }
+};
+
+struct BenchNode {
+  unsigned depth;
+  // Remaining height (skewed trees only)
+  unsigned height;
+  std::uint64_t state;
+  // Result of the node's work, folded into the checksum so it can't be elided
+  std::uint64_t work;
+  std::vector<std::uint8_t> payload;
+
+  template <class Archive>
+  void serialize(Archive & ar, const unsigned int version) {
+    ar & depth;
+    ar & height;
+    ar & state;
+    ar & work;
+    ar & payload;
+  }
+};
+
+// splitmix64 finaliser
+inline std::uint64_t mix(std::uint64_t x) {
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
+// Value on [0, 1) from the top 53 bits
+inline double toProb(std::uint64_t x) {
+  return (x >> 11) * (1.0 / 9007199254740992.0);
+}
+
+struct NodeGen : YewPar::StaticNodeGenerator<NodeGen, BenchNode, TreeParams> {
+  const TreeParams * params;
+  unsigned depth;
+  unsigned height;
+  std::uint64_t state;
+  std::uint64_t work;
+  unsigned i = 0;
+
+  NodeGen() { this->numChildren = 0; }
+
+  NodeGen(const TreeParams & params, const BenchNode & parent)
+      : params(&params), depth(parent.depth), height(parent.height), state(parent.state) {
+    work = state;
+    for (std::uint64_t w = 0; w < params.work; ++w) {
+      work = mix(work);
+    }
+    this->numChildren = calcNumChildren();
+  }
+
+  unsigned calcNumChildren() const {
+    switch (params->shape) {
+      case Shape::UNIFORM:
+        return depth < params->depth ? params->branching : 0;
+      case Shape::GEOMETRIC: {
+        if (depth >= params->depth) {
+          return 0;
+        }
+        auto bf = params->branching * (1.0 - static_cast<double>(depth) / params->depth);
+        auto p = 1.0 / (1.0 + bf);
+        auto u = toProb(mix(state));
+        return static_cast<unsigned>(std::floor(std::log(1 - u) / std::log(1 - p)));
+      }
+      case Shape::BINOMIAL:
+        if (depth == 0) {
+          return params->branching;
+        }
+        return toProb(mix(state)) < params->q ? params->m : 0;
+      case Shape::SKEWED:
+        if (height == 0) {
+          return 0;
+        }
+        return std::min(params->branching, (height - 1) / params->skew + 1);
+      case Shape::DEEP:
+        if (depth >= params->depth) {
+          return 0;
+        }
+        return mix(state) % params->period == 0 ? params->branching : 1;
+    }
+    return 0;
+  }
+
+  BenchNode next() {
+    BenchNode child { depth + 1,
+                      params->shape == Shape::SKEWED ? height - 1 - i * params->skew : 0,
+                      mix(state ^ (0x9E3779B97F4A7C15ull * (i + 1))),
+                      work,
+                      std::vector<std::uint8_t>(params->payload, static_cast<std::uint8_t>(i)) };
+    ++i;
+    return child;
+  }
+};
+
+struct Totals {
+  std::uint64_t nodes = 0;
+  std::uint64_t checksum = 0;
+
+  template <class Archive>
+  void serialize(Archive & ar, const unsigned int version) {
+    ar & nodes;
+    ar & checksum;
+  }
+};
+
+struct CountNodes : YewPar::StaticEnumerator<CountNodes, BenchNode, Totals> {
+  Totals t;
+
+  void accumulate(const BenchNode & n) {
+    t.nodes++;
+    t.checksum += n.work;
+  }
+
+  void combine(const Totals & other) {
+    t.nodes += other.nodes;
+    t.checksum += other.checksum;
+  }
+
+  Totals get() { return t; }
+};
+
+typedef YewPar::Skeletons::API::MaxStackDepth<std::integral_constant<unsigned, BENCH_MAX_TREE_DEPTH> > StackDepth;
+
+Totals runSearch(const std::string & skeleton,
+                 const TreeParams & tree,
+                 const BenchNode & root,
+                 boost::program_options::variables_map & opts) {
+  YewPar::Skeletons::API::Params<> searchParameters;
+  if (opts.count("trace")) {
+    searchParameters.traceFile = opts["trace"].as<std::string>() + "." + skeleton + ".trace";
+  }
+  if (skeleton == "seq") {
+    return YewPar::Skeletons::Seq<NodeGen,
+                                  YewPar::Skeletons::API::Enumeration,
+                                  YewPar::Skeletons::API::Enumerator<CountNodes>,
+                                  StackDepth>
+        ::search(tree, root, searchParameters);
+  } else if (skeleton == "depthbounded") {
+    searchParameters.spawnDepth = opts["spawn-depth"].as<unsigned>();
+    return YewPar::Skeletons::DepthBounded<NodeGen,
+                                           YewPar::Skeletons::API::Enumeration,
+                                           YewPar::Skeletons::API::Enumerator<CountNodes> >
+        ::search(tree, root, searchParameters);
+  } else if (skeleton == "stacksteal") {
+    searchParameters.stealAll = static_cast<bool>(opts.count("chunked"));
+    return YewPar::Skeletons::StackStealing<NodeGen,
+                                            YewPar::Skeletons::API::Enumeration,
+                                            YewPar::Skeletons::API::Enumerator<CountNodes>,
+                                            StackDepth>
+        ::search(tree, root, searchParameters);
+  } else if (skeleton == "budget") {
+    searchParameters.backtrackBudget = opts["backtrack-budget"].as<unsigned>();
+    return YewPar::Skeletons::Budget<NodeGen,
+                                     YewPar::Skeletons::API::Enumeration,
+                                     YewPar::Skeletons::API::Enumerator<CountNodes>,
+                                     StackDepth>
+        ::search(tree, root, searchParameters);
+  } else if (skeleton == "hybrid") {
+    searchParameters.spawnDepth = opts["spawn-depth"].as<unsigned>();
+    searchParameters.stealAll = static_cast<bool>(opts.count("chunked"));
+    return YewPar::Skeletons::Hybrid<NodeGen,
+                                     YewPar::Skeletons::API::Enumeration,
+                                     YewPar::Skeletons::API::Enumerator<CountNodes>,
+                                     StackDepth>
+        ::search(tree, root, searchParameters);
+  }
+
+  throw std::invalid_argument("Invalid skeleton type: " + skeleton);
+}
+
+// Work stealing and scheduler counters, summed over every policy (only the
+// skeleton's own policy counts anything) and every locality
+const std::vector<std::pair<std::string, std::vector<std::string> > > schedulerCounters = {
+  {"spawns", {"/workstealing/Workpool/spawns", "/workstealing/depthpool/spawns"}},
+  {"local_steals", {"/workstealing/Workpool/localSteals", "/workstealing/depthpool/localSteals",
+                    "/workstealing/SearchManager/localSteals"}},
+  {"distributed_steals", {"/workstealing/Workpool/distributedSteals", "/workstealing/depthpool/distributedSteals",
+                          "/workstealing/SearchManager/distributedSteals"}},
+  {"failed_local_steals", {"/workstealing/Workpool/localFailedSteals", "/workstealing/depthpool/localFailedSteals",
+                           "/workstealing/SearchManager/localFailedSteals"}},
+  {"failed_distributed_steals", {"/workstealing/Workpool/distributedFailedSteals",
+                                 "/workstealing/depthpool/distributedFailedSteals",
+                                 "/workstealing/SearchManager/distributedFailedSteals"}},
+  {"busy_ns", {"/workstealing/Scheduler/busyTime"}},
+  {"get_work_ns", {"/workstealing/Scheduler/getWorkTime"}},
+  {"backoff_ns", {"/workstealing/Scheduler/backoffTime"}}
+};
+
+std::string counterName(const std::string & name, const hpx::naming::id_type & locality) {
+  return (boost::format("%1%{locality#%2%/total}")
+          % name % hpx::naming::get_locality_id_from_id(locality)).str();
+}
+
+// Values since the last read, which resets them
+std::vector<std::uint64_t> readSchedulerCounters() {
+  std::vector<std::uint64_t> totals;
+  for (const auto & c : schedulerCounters) {
+    std::uint64_t total = 0;
+    for (const auto & name : c.second) {
+      for (const auto & l : hpx::find_all_localities()) {
+        hpx::performance_counters::performance_counter cntr(counterName(name, l));
+        total += cntr.get_value<std::int64_t>(hpx::launch::sync, true);
+      }
+    }
+    totals.push_back(total);
+  }
+  return totals;
+}
+
+// Mean HPX idle rate (in 0.01%) since the last read. Negative when HPX was built
+// without idle rate support
+double readIdleRate() {
+  try {
+    double total = 0;
+    auto locs = hpx::find_all_localities();
+    for (const auto & l : locs) {
+      hpx::performance_counters::performance_counter cntr(
+          (boost::format("/threads{locality#%1%/total}/idle-rate")
+           % hpx::naming::get_locality_id_from_id(l)).str());
+      total += cntr.get_value<std::int64_t>(hpx::launch::sync, true);
+    }
+    return total / locs.size();
+  } catch (const hpx::exception &) {
+    return -1;
+  }
+}
+
+struct Run {
+  std::string skeleton;
+  Totals totals;
+  std::vector<double> timesMs;
+  double bestMs;
+  std::vector<std::uint64_t> counters;
+  double idleRate;
+};
+
+std::string toJSON(const TreeParams & tree, std::uint64_t seed, const std::vector<Run> & runs) {
+  std::ostringstream os;
+  os << "{\n";
+  os << "  \"benchmark\": \"synthetic\",\n";
+  os << boost::format("  \"tree\": {\"shape\": \"%1%\", \"branching\": %2%, \"depth\": %3%, \"q\": %4%, "
+                      "\"m\": %5%, \"skew\": %6%, \"period\": %7%, \"work\": %8%, \"payload\": %9%, \"seed\": %10%},\n")
+      % shapeNames[static_cast<int>(tree.shape)] % tree.branching % tree.depth % tree.q
+      % tree.m % tree.skew % tree.period % tree.work % tree.payload % seed;
+  os << "  \"localities\": " << hpx::get_num_localities(hpx::launch::sync) << ",\n";
+  os << "  \"threads\": " << hpx::get_os_thread_count() << ",\n";
+  os << "  \"runs\": [\n";
+  for (auto r = 0u; r < runs.size(); ++r) {
+    const auto & run = runs[r];
+    os << "    {\"skeleton\": \"" << run.skeleton << "\", ";
+    os << "\"nodes\": " << run.totals.nodes << ", ";
+    os << "\"checksum\": " << run.totals.checksum << ", ";
+    os << "\"times_ms\": [";
+    for (auto i = 0u; i < run.timesMs.size(); ++i) {
+      os << (i ? ", " : "") << run.timesMs[i];
+    }
+    os << "], ";
+    os << "\"best_ms\": " << run.bestMs << ", ";
+    os << "\"nodes_per_sec\": " << static_cast<std::uint64_t>(run.totals.nodes / (run.bestMs / 1000.0)) << ", ";
+    for (auto i = 0u; i < schedulerCounters.size(); ++i) {
+      os << "\"" << schedulerCounters[i].first << "\": " << run.counters[i] << ", ";
+    }
+    os << "\"idle_rate\": ";
+    if (run.idleRate < 0) {
+      os << "null";
+    } else {
+      os << run.idleRate / 100.0;
+    }
+    os << "}" << (r + 1 < runs.size() ? "," : "") << "\n";
+  }
+  os << "  ],\n";
+
+  auto consistent = std::all_of(runs.begin(), runs.end(), [&](const Run & r) {
+      return r.totals.nodes == runs.front().totals.nodes && r.totals.checksum == runs.front().totals.checksum;
+    });
+  os << "  \"summary\": {\"nodes\": " << (runs.empty() ? 0 : runs.front().totals.nodes)
+     << ", \"consistent\": " << std::boolalpha << consistent << "}\n";
+  os << "}\n";
+  return os.str();
+}
+
+int hpx_main(boost::program_options::variables_map & opts) {
+  auto shapeName = opts["shape"].as<std::string>();
+  auto shapeIt = std::find(shapeNames.begin(), shapeNames.end(), shapeName);
+  if (shapeIt == shapeNames.end()) {
+    hpx::cout << "Invalid shape: " << shapeName << hpx::endl;
+    return hpx::finalize();
+  }
+
+  TreeParams tree { static_cast<Shape>(shapeIt - shapeNames.begin()),
+                    opts["branching"].as<unsigned>(),
+                    opts["depth"].as<unsigned>(),
+                    opts["q"].as<double>(),
+                    opts["m"].as<unsigned>(),
+                    std::max(opts["skew"].as<unsigned>(), 1u),
+                    std::max(opts["period"].as<unsigned>(), 1u),
+                    opts["work"].as<std::uint64_t>(),
+                    opts["payload"].as<unsigned>() };
+
+  if (tree.depth >= BENCH_MAX_TREE_DEPTH) {
+    hpx::cout << "Depth must be below " << BENCH_MAX_TREE_DEPTH << hpx::endl;
+    return hpx::finalize();
+  }
+
+  auto seed = opts["seed"].as<std::uint64_t>();
+  BenchNode root { 0, tree.depth, mix(seed), 0, std::vector<std::uint8_t>(tree.payload, 0) };
+
+  std::vector<std::string> skeletons;
+  auto skeletonList = opts["skeletons"].as<std::string>();
+  if (skeletonList == "all") {
+    skeletons = skeletonNames;
+  } else {
+    boost::split(skeletons, skeletonList, boost::is_any_of(","));
+  }
+
+  auto repeats = std::max(opts["repeats"].as<unsigned>(), 1u);
+
+  std::vector<Run> runs;
+  for (const auto & skeleton : skeletons) {
+    Run run { skeleton };
+    run.bestMs = 0;
+    for (auto i = 0u; i < repeats; ++i) {
+      readSchedulerCounters();
+      readIdleRate();
+
+      auto start_time = std::chrono::steady_clock::now();
+      auto totals = runSearch(skeleton, tree, root, opts);
+      auto time = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+
+      auto counters = readSchedulerCounters();
+      auto idleRate = readIdleRate();
+
+      run.timesMs.push_back(time);
+      if (i == 0 || time < run.bestMs) {
+        run.totals = totals;
+        run.bestMs = time;
+        run.counters = counters;
+        run.idleRate = idleRate;
+      }
+    }
+    runs.push_back(run);
+  }
+
+  auto json = toJSON(tree, seed, runs);
+  if (opts.count("json")) {
+    std::ofstream out(opts["json"].as<std::string>());
+    out << json;
+  } else {
+    hpx::cout << json << hpx::flush;
+  }
+
+  return hpx::finalize();
+}
+
+int main(int argc, char* argv[]) {
+  boost::program_options::options_description
+    desc_commandline("Usage: " HPX_APPLICATION_STRING " [options]");
+
+  desc_commandline.add_options()
+    ( "skeletons",
+      boost::program_options::value<std::string>()->default_value("all"),
+      "Comma separated skeletons to run (seq, depthbounded, stacksteal, budget, hybrid), or all"
+    )
+    ( "shape",
+      boost::program_options::value<std::string>()->default_value("uniform"),
+      "Tree shape: uniform, geometric, binomial, skewed, or deep"
+    )
+    ( "branching,k",
+      boost::program_options::value<unsigned>()->default_value(4),
+      "Branching factor (mean branching for geometric trees, root branching for binomial trees)"
+    )
+    ( "depth",
+      boost::program_options::value<unsigned>()->default_value(10),
+      "Tree depth (height for skewed trees, unused for binomial trees)"
+    )
+    ( "q",
+      boost::program_options::value<double>()->default_value(0.2),
+      "Binomial: probability of a non-leaf node"
+    )
+    ( "m",
+      boost::program_options::value<unsigned>()->default_value(4),
+      "Binomial: children of a non-leaf node (q * m < 1 for a finite tree)"
+    )
+    ( "skew",
+      boost::program_options::value<unsigned>()->default_value(1),
+      "Skewed: height lost by each later sibling"
+    )
+    ( "period",
+      boost::program_options::value<unsigned>()->default_value(16),
+      "Deep: one in period nodes branch"
+    )
+    ( "work",
+      boost::program_options::value<std::uint64_t>()->default_value(0),
+      "Rounds of hashing per expanded node"
+    )
+    ( "payload",
+      boost::program_options::value<unsigned>()->default_value(0),
+      "Extra bytes carried by every node"
+    )
+    ( "seed",
+      boost::program_options::value<std::uint64_t>()->default_value(0),
+      "Tree seed"
+    )
+    ( "repeats,r",
+      boost::program_options::value<unsigned>()->default_value(1),
+      "Runs per skeleton, the fastest is reported"
+    )
+    ( "spawn-depth,d",
+      boost::program_options::value<unsigned>()->default_value(2),
+      "Depth in the tree to spawn until (depthbounded and hybrid only)"
+    )
+    ( "backtrack-budget,b",
+      boost::program_options::value<unsigned>()->default_value(500),
+      "Number of backtracks before spawning work"
+    )
+    ("chunked", "Use chunking with stack stealing")
+    ( "json",
+      boost::program_options::value<std::string>(),
+      "Write the results to this file rather than stdout"
+    )
+    ( "trace",
+      boost::program_options::value<std::string>(),
+      "Trace each parallel skeleton's last run to <trace>.<skeleton>.trace (see apps/bench/trace-view.py)"
+    );
+
+  YewPar::registerPerformanceCounters();
+
+  return hpx::init(desc_commandline, argc, argv);
+}
@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+"""Run synthetic-bench at several thread counts and combine the results.
+
+Every argument after "--" is passed to synthetic-bench (tree shape, skeletons,
+repeats, ...). The combined JSON holds the benchmark's output for each thread
+count plus, for every skeleton, its speedup over the sequential skeleton on one
+thread and its parallel efficiency.
+
+  ./scaling.py --binary ./synthetic-bench --threads 1,2,4,8 -o uniform.json \\
+      -- --shape uniform -k 4 --depth 11 --repeats 3
+"""
+
+import argparse
+import json
+import os
+import subprocess
+import sys
+import tempfile
+
+
+def default_threads():
+    threads = []
+    t = 1
+    while t <= (os.cpu_count() or 1):
+        threads.append(t)
+        t *= 2
+    return threads
+
+
+def run(binary, threads, bench_args):
+    with tempfile.NamedTemporaryFile(suffix=".json", delete=False) as f:
+        path = f.name
+    try:
+        cmd = [binary, "--hpx:threads", str(threads), "--json", path] + bench_args
+        subprocess.run(cmd, check=True, stdout=subprocess.DEVNULL)
+        with open(path) as f:
+            return json.load(f)
+    finally:
+        os.remove(path)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--binary", default="./synthetic-bench", help="Path to synthetic-bench")
+    parser.add_argument("--threads", help="Comma separated thread counts (default: powers of two up to the core count)")
+    parser.add_argument("-o", "--output", help="Write the combined JSON here rather than stdout")
+    parser.add_argument("bench_args", nargs=argparse.REMAINDER, help="Arguments for synthetic-bench, after --")
+    args = parser.parse_args()
+
+    threads = [int(t) for t in args.threads.split(",")] if args.threads else default_threads()
+    bench_args = args.bench_args[1:] if args.bench_args[:1] == ["--"] else args.bench_args
+
+    results = []
+    for t in threads:
+        print("Running with {} threads".format(t), file=sys.stderr)
+        results.append(run(args.binary, t, bench_args))
+
+    # Baseline: sequential skeleton on the fewest threads, else the fastest
+    # skeleton there
+    first = results[0]["runs"]
+    seq = [r for r in first if r["skeleton"] == "seq"]
+    baseline = seq[0]["best_ms"] if seq else min(r["best_ms"] for r in first)
+
+    scaling = {}
+    for res in results:
+        for r in res["runs"]:
+            scaling.setdefault(r["skeleton"], []).append({
+                "threads": res["threads"],
+                "best_ms": r["best_ms"],
+                "nodes_per_sec": r["nodes_per_sec"],
+                "speedup": baseline / r["best_ms"],
+                "efficiency": baseline / r["best_ms"] / (res["threads"] * res["localities"]),
+            })
+
+    combined = {
+        "benchmark": "synthetic-scaling",
+        "tree": results[0]["tree"],
+        "baseline_ms": baseline,
+        "consistent": all(res["summary"]["consistent"] for res in results)
+                      and len({res["summary"]["nodes"] for res in results}) == 1,
+        "results": results,
+        "scaling": scaling,
+    }
+
+    out = json.dumps(combined, indent=2)
+    if args.output:
+        with open(args.output, "w") as f:
+            f.write(out + "\n")
+    else:
+        print(out)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,311 @@
+#!/usr/bin/env python3
+"""Summarise and visualise search traces written by YewPar's parallel skeletons.
+
+Traces are recorded when API::Params::traceFile is set (see lib/util/Trace.hpp),
+e.g. with synthetic-bench --trace. Three views are available:
+
+  ./trace-view.py summary run.trace             per worker tasks, busy time, steals
+  ./trace-view.py gantt run.trace -o gantt.svg  tasks per worker over time
+  ./trace-view.py heatmap run.trace -o heat.svg workers busy at each depth over time
+
+In the Gantt chart tasks are coloured by the depth of their root, successful
+steals are marked above their worker's row and new incumbents are drawn as
+vertical lines. Localities' clocks are aligned by the wall clock time each
+started tracing, so are only as close as the machines' clocks.
+"""
+
+import argparse
+import struct
+import sys
+
+MAGIC = b"YPTRACE\0"
+EVENT = struct.Struct("<QqIHBB")
+NONE = 0xFFFFFFFF
+
+TASK_START, TASK_END, STEAL, SPAWN, INCUMBENT = range(5)
+
+
+class Buffer:
+    def __init__(self, locality, worker, recorded, events):
+        self.locality = locality
+        self.worker = worker
+        self.recorded = recorded
+        self.events = events
+
+    @property
+    def dropped(self):
+        return self.recorded - len(self.events)
+
+    @property
+    def name(self):
+        return "L{} W{}".format(self.locality, self.worker)
+
+
+class Task:
+    def __init__(self, buf, start, end, depth):
+        self.buf = buf
+        self.start = start
+        self.end = end
+        self.depth = depth
+
+
+def read_trace(path):
+    with open(path, "rb") as f:
+        data = f.read()
+
+    if data[:8] != MAGIC:
+        sys.exit("{}: not a trace file".format(path))
+    version, localities = struct.unpack_from("<II", data, 8)
+    if version != 1:
+        sys.exit("{}: unsupported trace version {}".format(path, version))
+
+    pos = 16
+    starts = []
+    raw = []
+    for _ in range(localities):
+        locality, buffers, start = struct.unpack_from("<IIQ", data, pos)
+        pos += 16
+        starts.append(start)
+        for _ in range(buffers):
+            worker, _, recorded, kept = struct.unpack_from("<IIQQ", data, pos)
+            pos += 24
+            events = [EVENT.unpack_from(data, pos + i * EVENT.size) for i in range(kept)]
+            pos += kept * EVENT.size
+            raw.append((locality, start, worker, recorded, events))
+
+    # Times relative to the first locality to start, as (time, value, arg, type)
+    first = min(starts) if starts else 0
+    buffers = []
+    for locality, start, worker, recorded, events in raw:
+        offset = start - first
+        events = [(t + offset, v, a, ty) for (t, v, a, _, ty, _) in events]
+        buffers.append(Buffer(locality, worker, recorded, events))
+
+    # Buffers shared by non-worker threads are usually empty
+    return [b for b in buffers if b.recorded > 0]
+
+
+def trace_span(buffers):
+    times = [e[0] for b in buffers for e in b.events]
+    return (min(times), max(times)) if times else (0, 0)
+
+
+def tasks_of(buf, span_end):
+    """Pair task starts and ends. Tasks whose start was overwritten begin at the
+    buffer's first event, tasks still open end with the trace."""
+    tasks = []
+    open_tasks = []
+    first = buf.events[0][0] if buf.events else 0
+    for t, _, arg, ty in buf.events:
+        if ty == TASK_START:
+            open_tasks.append((t, arg))
+        elif ty == TASK_END:
+            match = None
+            for i in range(len(open_tasks) - 1, -1, -1):
+                if open_tasks[i][1] == arg:
+                    match = i
+                    break
+            if match is None:
+                tasks.append(Task(buf, first, t, arg))
+            else:
+                start, depth = open_tasks.pop(match)
+                tasks.append(Task(buf, start, t, depth))
+    for start, depth in open_tasks:
+        tasks.append(Task(buf, start, span_end, depth))
+    return tasks
+
+
+def busy_time(tasks):
+    """Time covered by tasks, counting nested tasks once"""
+    total = 0
+    end = None
+    for task in sorted(tasks, key=lambda t: t.start):
+        if end is None or task.start > end:
+            total += task.end - task.start
+            end = task.end
+        elif task.end > end:
+            total += task.end - end
+            end = task.end
+    return total
+
+
+def summary(buffers, out):
+    start, end = trace_span(buffers)
+    span = max(end - start, 1)
+
+    out.write("Trace span: {:.3f} ms, {} localities, {} buffers\n".format(
+        span / 1e6, len({b.locality for b in buffers}), len(buffers)))
+    out.write("{:>10} {:>8} {:>8} {:>8} {:>8} {:>8} {:>8} {:>8}\n".format(
+        "Worker", "Events", "Dropped", "Tasks", "Busy%", "Spawns", "Steals", "Failed"))
+
+    incumbents = []
+    for b in buffers:
+        tasks = tasks_of(b, end)
+        spawns = sum(1 for e in b.events if e[3] == SPAWN)
+        steals = sum(1 for e in b.events if e[3] == STEAL and e[1] > 0)
+        failed = sum(1 for e in b.events if e[3] == STEAL and e[1] == 0)
+        incumbents += [(e[0], e[1]) for e in b.events if e[3] == INCUMBENT]
+        out.write("{:>10} {:>8} {:>8} {:>8} {:>8.1f} {:>8} {:>8} {:>8}\n".format(
+            b.name, b.recorded, b.dropped, len(tasks), 100.0 * busy_time(tasks) / span,
+            spawns, steals, failed))
+
+    if any(b.dropped for b in buffers):
+        out.write("Buffers wrapped: only the latest events are shown, "
+                  "raise Params::traceEvents to keep more\n")
+
+    for t, v in sorted(incumbents):
+        out.write("Incumbent {} at {:.3f} ms\n".format(v, (t - start) / 1e6))
+
+
+def depth_colour(depth, max_depth):
+    if depth == NONE:
+        return "#999999"
+    hue = 240 - 240 * min(depth, max_depth) / max(max_depth, 1)
+    return "hsl({:.0f},70%,55%)".format(hue)
+
+
+def svg_header(width, height):
+    return ['<svg xmlns="http://www.w3.org/2000/svg" width="{}" height="{}" '
+            'font-family="sans-serif" font-size="10">'.format(width, height),
+            '<rect width="100%" height="100%" fill="white"/>']
+
+
+def time_axis(lines, left, top, width, span):
+    lines.append('<line x1="{}" y1="{}" x2="{}" y2="{}" stroke="black"/>'.format(
+        left, top, left + width, top))
+    for i in range(11):
+        x = left + width * i / 10
+        lines.append('<line x1="{0:.1f}" y1="{1}" x2="{0:.1f}" y2="{2}" stroke="black"/>'.format(
+            x, top, top + 4))
+        lines.append('<text x="{:.1f}" y="{}" text-anchor="middle">{:.2f}</text>'.format(
+            x, top + 14, span * i / 10 / 1e6))
+    lines.append('<text x="{}" y="{}" text-anchor="middle">time (ms)</text>'.format(
+        left + width / 2, top + 28))
+
+
+def gantt(buffers, path, width, failed_steals):
+    start, end = trace_span(buffers)
+    span = max(end - start, 1)
+
+    left, top, row = 60, 20, 16
+    height = top + row * len(buffers) + 40
+    scale = width / span
+
+    tasks = [tasks_of(b, end) for b in buffers]
+    depths = [t.depth for ts in tasks for t in ts if t.depth != NONE]
+    max_depth = max(depths) if depths else 0
+
+    lines = svg_header(left + width + 20, height)
+    for i, (b, ts) in enumerate(zip(buffers, tasks)):
+        y = top + i * row
+        lines.append('<text x="{}" y="{}" text-anchor="end">{}</text>'.format(
+            left - 4, y + row - 5, b.name))
+
+        # Merge neighbouring tasks at the same depth that would be drawn as one
+        bars = []
+        for t in sorted(ts, key=lambda t: t.start):
+            x0 = (t.start - start) * scale
+            x1 = max((t.end - start) * scale, x0 + 0.5)
+            if bars and bars[-1][2] == t.depth and x0 - bars[-1][1] < 0.5:
+                bars[-1][1] = max(bars[-1][1], x1)
+            else:
+                bars.append([x0, x1, t.depth])
+        for x0, x1, depth in bars:
+            lines.append('<rect x="{:.1f}" y="{}" width="{:.1f}" height="{}" fill="{}">'
+                         '<title>depth {}</title></rect>'.format(
+                             left + x0, y + 3, x1 - x0, row - 4, depth_colour(depth, max_depth),
+                             "?" if depth == NONE else depth))
+
+        for t, value, arg, ty in b.events:
+            x = left + (t - start) * scale
+            if ty == STEAL and (value > 0 or failed_steals):
+                victim = "local" if arg == NONE or arg == b.locality else "L{}".format(arg)
+                colour = "black" if value > 0 else "#bbbbbb"
+                lines.append('<path d="M{0:.1f},{1} l-2,-3 h4 z" fill="{2}">'
+                             '<title>steal from {3}: {4} tasks</title></path>'.format(
+                                 x, y + 3, colour, victim, value))
+
+    for b in buffers:
+        for t, value, _, ty in b.events:
+            if ty == INCUMBENT:
+                x = left + (t - start) * scale
+                lines.append('<line x1="{0:.1f}" y1="{1}" x2="{0:.1f}" y2="{2}" stroke="red">'
+                             '<title>incumbent {3}</title></line>'.format(
+                                 x, top, top + row * len(buffers), value))
+
+    time_axis(lines, left, top + row * len(buffers) + 2, width, span)
+    lines.append("</svg>")
+    with open(path, "w") as f:
+        f.write("\n".join(lines) + "\n")
+
+
+def heatmap(buffers, path, width, bins):
+    start, end = trace_span(buffers)
+    span = max(end - start, 1)
+    bin_ns = span / bins
+
+    tasks = [t for b in buffers for t in tasks_of(b, end) if t.depth != NONE]
+    max_depth = max((t.depth for t in tasks), default=0)
+
+    # Average number of workers running a task rooted at each depth
+    busy = [[0.0] * bins for _ in range(max_depth + 1)]
+    for t in tasks:
+        first = min(int((t.start - start) / bin_ns), bins - 1)
+        last = min(int((t.end - start) / bin_ns), bins - 1)
+        for i in range(first, last + 1):
+            lo = max(t.start - start, i * bin_ns)
+            hi = min(t.end - start, (i + 1) * bin_ns)
+            if hi > lo:
+                busy[t.depth][i] += (hi - lo) / bin_ns
+    peak = max((v for row in busy for v in row), default=0) or 1
+
+    left, top, row = 60, 20, 14
+    cell = width / bins
+    height = top + row * (max_depth + 1) + 40
+
+    lines = svg_header(left + width + 20, height)
+    for d in range(max_depth + 1):
+        y = top + d * row
+        lines.append('<text x="{}" y="{}" text-anchor="end">depth {}</text>'.format(
+            left - 4, y + row - 3, d))
+        for i, v in enumerate(busy[d]):
+            if v <= 0:
+                continue
+            shade = int(255 * (1 - v / peak))
+            lines.append('<rect x="{:.1f}" y="{}" width="{:.1f}" height="{}" fill="rgb({},{},255)">'
+                         '<title>{:.2f} workers</title></rect>'.format(
+                             left + i * cell, y, cell + 0.1, row, shade, shade, v))
+
+    time_axis(lines, left, top + row * (max_depth + 1) + 2, width, span)
+    lines.append("</svg>")
+    with open(path, "w") as f:
+        f.write("\n".join(lines) + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("view", choices=["summary", "gantt", "heatmap"])
+    parser.add_argument("trace", help="Trace file")
+    parser.add_argument("-o", "--output", help="SVG file to write (gantt and heatmap)")
+    parser.add_argument("--width", type=int, default=1200, help="Width of the time axis in pixels")
+    parser.add_argument("--bins", type=int, default=200, help="Time bins in the heatmap")
+    parser.add_argument("--failed-steals", action="store_true", help="Also mark failed steals in the Gantt chart")
+    args = parser.parse_args()
+
+    buffers = read_trace(args.trace)
+
+    if args.view == "summary":
+        summary(buffers, sys.stdout)
+        return
+
+    output = args.output or "{}.{}.svg".format(args.trace, args.view)
+    if args.view == "gantt":
+        gantt(buffers, output, args.width, args.failed_steals)
+    else:
+        heatmap(buffers, output, args.width, max(args.bins, 1))
+    print("Wrote {}".format(output), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
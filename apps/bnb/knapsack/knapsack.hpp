@@ -89,6 +89,63 @@ struct GenNode : YewPar::NodeGenerator<KPNode, KPSpace<numItems> > {
   }
 };
 
+// In-place expansion, where a move is the item to add. A node's remaining
+// items are those after its last item that still fit, so they are found from
+// the solution alone and rem is left as it is (only GenNode reads it)
+template <unsigned numItems>
+struct InPlaceGenNode : YewPar::StaticNodeGenerator<InPlaceGenNode<numItems>, KPNode, KPSpace<numItems> > {
+  using Movetype = int;
+
+  std::reference_wrapper<const KPSpace<numItems> > space;
+  std::reference_wrapper<const KPNode> n;
+  int spare;
+  int nextItem;
+
+  InPlaceGenNode (const KPSpace<numItems> & space, const KPNode & n) :
+      space(std::cref(space)), n(std::cref(n)), spare(space.capacity - n.sol.weight) {
+    auto first = n.sol.items.empty() ? 0 : n.sol.items.back() + 1;
+    nextItem = first;
+    skipHeavy();
+
+    this->numChildren = 0;
+    for (auto i = nextItem; i < space.numItems; ++i) {
+      if (space.weights[i] <= spare) {
+        ++this->numChildren;
+      }
+    }
+  }
+
+  void skipHeavy() {
+    while (nextItem < space.get().numItems && space.get().weights[nextItem] > spare) {
+      ++nextItem;
+    }
+  }
+
+  Movetype nextMove() {
+    auto i = nextItem++;
+    skipHeavy();
+    return i;
+  }
+
+  static void apply(const KPSpace<numItems> & space, KPNode & n, const Movetype & i) {
+    n.sol.items.push_back(i);
+    n.sol.profit += space.profits[i];
+    n.sol.weight += space.weights[i];
+  }
+
+  static void undo(const KPSpace<numItems> & space, KPNode & n, const Movetype & i) {
+    n.sol.items.pop_back();
+    n.sol.profit -= space.profits[i];
+    n.sol.weight -= space.weights[i];
+  }
+
+  KPNode next() {
+    auto c = n.get();
+    apply(space.get(), c, nextMove());
+    return c;
+  }
+};
+
 template <unsigned numItems>
 int upperBound(const KPSpace<numItems> & space, const KPNode & n) {
   auto sol = n.sol;
@@ -5,6 +5,8 @@
 #include <regex>
 #include <exception>
 #include <chrono>
+#include <cstdint>
+#include <functional>
 
 #include <hpx/hpx_init.hpp>
 #include <hpx/include/iostreams.hpp>
@@ -25,6 +27,27 @@
 
 typedef func<decltype(&upperBound<NUMITEMS>), &upperBound<NUMITEMS> > bnd_func;
 
+// Stream improving solutions as they are found
+static bool printIncumbents = false;
+void incumbentFound(const KPNode & n) {
+  if (printIncumbents) {
+    hpx::cout << "Incumbent Profit: " << n.sol.profit << hpx::endl;
+  }
+}
+typedef func<decltype(&incumbentFound), &incumbentFound> incumbent_func;
+
+// Fold over every visited node alongside the search, keeping the most
+// profitable one seen
+int nodeProfit(const KPNode & n) { return n.sol.profit; }
+typedef func<decltype(&nodeProfit), &nodeProfit> profit_func;
+typedef YewPar::MinMaxEnumerator<KPNode, profit_func, std::greater<int> > BestVisited;
+
+void setSearchBudget(YewPar::Skeletons::API::Params<int> & searchParameters,
+                     boost::program_options::variables_map & opts) {
+  searchParameters.timeout = opts["timeout"].as<std::uint64_t>();
+  searchParameters.nodeLimit = opts["node-limit"].as<std::uint64_t>();
+}
+
 struct knapsackData {
   int capacity = 0;
   int expectedResult = 0;
@@ -66,6 +89,60 @@ knapsackData read_knapsack(const std::string & filename) {
   return kp;
 }
 
+// Search for the k best solutions (or all optimal solutions if k = 0)
+std::vector<KPNode> searchSolutions(const std::string & skeletonType,
+                                    const KPSpace<NUMITEMS> & space,
+                                    const KPNode & root,
+                                    boost::program_options::variables_map & opts) {
+  YewPar::Skeletons::API::Params<int> searchParameters;
+  searchParameters.numSolutions = opts["solutions"].as<unsigned>();
+  setSearchBudget(searchParameters, opts);
+
+  if (skeletonType == "seq") {
+    return YewPar::Skeletons::Seq<GenNode<NUMITEMS>,
+                                  YewPar::Skeletons::API::Optimisation,
+                                  YewPar::Skeletons::API::CollectSolutions,
+                                  YewPar::Skeletons::API::PruneLevel,
+                                  YewPar::Skeletons::API::BoundFunction<bnd_func> >
+        ::search(space, root, searchParameters);
+  } else if (skeletonType == "depthbounded") {
+    searchParameters.spawnDepth = opts["spawn-depth"].as<unsigned>();
+    return YewPar::Skeletons::DepthBounded<GenNode<NUMITEMS>,
+                                           YewPar::Skeletons::API::Optimisation,
+                                           YewPar::Skeletons::API::CollectSolutions,
+                                           YewPar::Skeletons::API::PruneLevel,
+                                           YewPar::Skeletons::API::BoundFunction<bnd_func> >
+        ::search(space, root, searchParameters);
+  } else if (skeletonType == "budget") {
+    searchParameters.backtrackBudget = opts["backtrack-budget"].as<unsigned>();
+    return YewPar::Skeletons::Budget<GenNode<NUMITEMS>,
+                                     YewPar::Skeletons::API::Optimisation,
+                                     YewPar::Skeletons::API::CollectSolutions,
+                                     YewPar::Skeletons::API::PruneLevel,
+                                     YewPar::Skeletons::API::BoundFunction<bnd_func> >
+        ::search(space, root, searchParameters);
+  } else if (skeletonType == "stacksteal" && inPlace) {
+    searchParameters.stealAll = static_cast<bool>(opts.count("chunked"));
+    sol = YewPar::Skeletons::StackStealing<InPlaceGenNode<NUMITEMS>,
+                                           YewPar::Skeletons::API::Optimisation,
+                                           YewPar::Skeletons::API::InPlace,
+                                           YewPar::Skeletons::API::PruneLevel,
+                                           YewPar::Skeletons::API::IncumbentCallback<incumbent_func>,
+                                           YewPar::Skeletons::API::BoundFunction<bnd_func> >
+        ::search(space, root, searchParameters);
+  } else if (skeletonType == "stacksteal") {
+    searchParameters.stealAll = static_cast<bool>(opts.count("chunked"));
+    return YewPar::Skeletons::StackStealing<GenNode<NUMITEMS>,
+                                            YewPar::Skeletons::API::Optimisation,
+                                            YewPar::Skeletons::API::CollectSolutions,
+                                            YewPar::Skeletons::API::PruneLevel,
+                                            YewPar::Skeletons::API::BoundFunction<bnd_func> >
+        ::search(space, root, searchParameters);
+  }
+  hpx::cout << "Invalid skeleton type for collecting solutions\n";
+  return {};
+}
+
 int hpx_main(boost::program_options::variables_map & opts) {
 
 
@@ -136,44 +213,100 @@ int hpx_main(boost::program_options::variables_map & opts) {
 
   auto sol = root;
   auto skeletonType = opts["skeleton"].as<std::string>();
-  if (skeletonType == "seq") {
+
+  if (opts.count("solutions")) {
+    auto sols = searchSolutions(skeletonType, space, root, opts);
+
+    auto overall_time = std::chrono::duration_cast<std::chrono::milliseconds>
+                        (std::chrono::steady_clock::now() - start_time);
+
+    hpx::cout << "Solutions collected: " << sols.size() << hpx::endl;
+    if (!sols.empty()) {
+      hpx::cout << "Final Profit: " << sols.front().sol.profit << hpx::endl;
+      hpx::cout << "Worst Collected Profit: " << sols.back().sol.profit << hpx::endl;
+    }
+    hpx::cout << "cpu = " << overall_time.count() << hpx::endl;
+
+    return hpx::finalize();
+  }
+
+  printIncumbents = static_cast<bool>(opts.count("print-incumbents"));
+
+  YewPar::Skeletons::API::Params<int> searchParameters;
+  setSearchBudget(searchParameters, opts);
+
+  auto inPlace = static_cast<bool>(opts.count("inplace"));
+
+  if (skeletonType == "seq" && inPlace) {
+    sol = YewPar::Skeletons::Seq<InPlaceGenNode<NUMITEMS>,
+                                 YewPar::Skeletons::API::Optimisation,
+                                 YewPar::Skeletons::API::InPlace,
+                                 YewPar::Skeletons::API::PruneLevel,
+                                 YewPar::Skeletons::API::IncumbentCallback<incumbent_func>,
+                                 YewPar::Skeletons::API::BoundFunction<bnd_func> >
+          ::search(space, root, searchParameters);
+  } else if (skeletonType == "seq") {
     sol = YewPar::Skeletons::Seq<GenNode<NUMITEMS>,
                                  YewPar::Skeletons::API::Optimisation,
                                  YewPar::Skeletons::API::PruneLevel,
+                                 YewPar::Skeletons::API::IncumbentCallback<incumbent_func>,
                                  YewPar::Skeletons::API::BoundFunction<bnd_func> >
-          ::search(space, root);
+          ::search(space, root, searchParameters);
+  } else if (skeletonType == "depthbounded" && opts.count("fold-stats")) {
+    auto spawnDepth = opts["spawn-depth"].as<unsigned>();
+    searchParameters.spawnDepth = spawnDepth;
+    auto res = YewPar::Skeletons::DepthBounded<GenNode<NUMITEMS>,
+                                         YewPar::Skeletons::API::Optimisation,
+                                         YewPar::Skeletons::API::Enumerator<BestVisited>,
+                                         YewPar::Skeletons::API::PruneLevel,
+                                         YewPar::Skeletons::API::IncumbentCallback<incumbent_func>,
+                                         YewPar::Skeletons::API::BoundFunction<bnd_func> >
+          ::search(space, root, searchParameters);
+    sol = res.result;
+    const auto & best = res.fold;
+    hpx::cout << "Best Visited Profit: " << best.value << hpx::endl;
+    hpx::cout << "Best Visited Weight: " << best.node.sol.weight << hpx::endl;
   } else if (skeletonType == "depthbounded") {
     auto spawnDepth = opts["spawn-depth"].as<unsigned>();
-    YewPar::Skeletons::API::Params<int> searchParameters;
     searchParameters.spawnDepth = spawnDepth;
     sol = YewPar::Skeletons::DepthBounded<GenNode<NUMITEMS>,
                                          YewPar::Skeletons::API::Optimisation,
                                          YewPar::Skeletons::API::PruneLevel,
+                                         YewPar::Skeletons::API::IncumbentCallback<incumbent_func>,
                                          YewPar::Skeletons::API::BoundFunction<bnd_func> >
           ::search(space, root, searchParameters);
   } else if (skeletonType == "ordered") {
     auto spawnDepth = opts["spawn-depth"].as<unsigned>();
-    YewPar::Skeletons::API::Params<int> searchParameters;
     searchParameters.spawnDepth = spawnDepth;
     sol = YewPar::Skeletons::Ordered<GenNode<NUMITEMS>,
                                      YewPar::Skeletons::API::Optimisation,
                                      YewPar::Skeletons::API::PruneLevel,
+                                     YewPar::Skeletons::API::IncumbentCallback<incumbent_func>,
                                      YewPar::Skeletons::API::BoundFunction<bnd_func> >
           ::search(space, root, searchParameters);
+  } else if (skeletonType == "budget" && inPlace) {
+    searchParameters.backtrackBudget = opts["backtrack-budget"].as<unsigned>();
+    sol = YewPar::Skeletons::Budget<InPlaceGenNode<NUMITEMS>,
+                                    YewPar::Skeletons::API::Optimisation,
+                                    YewPar::Skeletons::API::InPlace,
+                                    YewPar::Skeletons::API::PruneLevel,
+                                    YewPar::Skeletons::API::IncumbentCallback<incumbent_func>,
+                                    YewPar::Skeletons::API::BoundFunction<bnd_func> >
+        ::search(space, root, searchParameters);
   } else if (skeletonType == "budget") {
-    YewPar::Skeletons::API::Params<int> searchParameters;
     searchParameters.backtrackBudget = opts["backtrack-budget"].as<unsigned>();
     sol = YewPar::Skeletons::Budget<GenNode<NUMITEMS>,
                                     YewPar::Skeletons::API::Optimisation,
                                     YewPar::Skeletons::API::PruneLevel,
+                                    YewPar::Skeletons::API::IncumbentCallback<incumbent_func>,
                                     YewPar::Skeletons::API::BoundFunction<bnd_func> >
         ::search(space, root, searchParameters);
   } else if (skeletonType == "stacksteal") {
-    YewPar::Skeletons::API::Params<int> searchParameters;
     searchParameters.stealAll = static_cast<bool>(opts.count("chunked"));
     sol = YewPar::Skeletons::StackStealing<GenNode<NUMITEMS>,
                                            YewPar::Skeletons::API::Optimisation,
                                            YewPar::Skeletons::API::PruneLevel,
+                                           YewPar::Skeletons::API::IncumbentCallback<incumbent_func>,
                                            YewPar::Skeletons::API::BoundFunction<bnd_func> >
         ::search(space, root, searchParameters);
   } else {
@@ -187,6 +320,10 @@ int hpx_main(boost::program_options::variables_map & opts) {
 
   auto finalSol = sol.sol;
   hpx::cout << "Final Profit: " << finalSol.profit << hpx::endl;
+  if (YewPar::Anytime::exhausted()) {
+    hpx::cout << "Search budget exhausted" << hpx::endl;
+    hpx::cout << "Bound Gap: " << YewPar::getBoundGap<KPSpace<NUMITEMS>, KPNode, int>() << hpx::endl;
+  }
   hpx::cout << "Final Weight: " << finalSol.weight << hpx::endl;
   hpx::cout << "Expected Result: " << std::boolalpha << (finalSol.profit == problem.expectedResult) << hpx::endl;
   hpx::cout << "Items: ";
@@ -218,6 +355,21 @@ int main(int argc, char* argv[]) {
       "Number of backtracks before spawning work"
     )
     ("chunked", "Use chunking with stack stealing")
+    ( "solutions,k",
+      boost::program_options::value<unsigned>(),
+      "Collect the k best solutions rather than one (0 collects all optimal solutions)"
+    )
+    ( "timeout,t",
+      boost::program_options::value<std::uint64_t>()->default_value(0),
+      "Stop after this many milliseconds and report the best solution so far (0 is unlimited)"
+    )
+    ( "node-limit",
+      boost::program_options::value<std::uint64_t>()->default_value(0),
+      "Stop after (roughly) this many nodes and report the best solution so far (0 is unlimited)"
+    )
+    ("print-incumbents", "Print each improved solution as it is found")
+    ("inplace", "Expand nodes in place with apply/undo rather than copying them (seq, budget and stacksteal only)")
+    ("fold-stats", "Also report the most profitable node visited (depthbounded only)")
     ( "spawn-depth,d",
       boost::program_options::value<unsigned>()->default_value(0),
       "Depth in the tree to spawn until (for parallel skeletons only)"
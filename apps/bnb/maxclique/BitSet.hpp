@@ -7,6 +7,7 @@
  */
 
 #include <array>
+#include <cstddef>
 
 using BitWord = unsigned long long;
 static const constexpr int bits_per_word = sizeof(BitWord) * 8;
@@ -75,6 +76,17 @@ public:
     return -1;
   }
 
+  auto operator== (const BitSet<words_> & other) const -> bool {
+    return _bits == other._bits;
+  }
+
+  auto hash() const -> std::size_t {
+    std::size_t h = 0;
+    for (auto & p : _bits)
+      h = (h ^ p) * 0x100000001b3ull;
+    return h;
+  }
+
   template<class Archive>
   void serialize(Archive & ar, const unsigned version) {
     ar & _size;
@@ -4,6 +4,7 @@
 #include <vector>
 #include <map>
 #include <chrono>
+#include <functional>
 #include <memory>
 #include <typeinfo>
 
@@ -23,6 +24,8 @@
 #include "skeletons/StackStealing.hpp"
 #include "skeletons/Ordered.hpp"
 #include "skeletons/Budget.hpp"
+#include "skeletons/Hybrid.hpp"
+#include "skeletons/Portfolio.hpp"
 
 #include "util/func.hpp"
 #include "util/NodeGenerator.hpp"
@@ -133,6 +136,37 @@ struct MCNode {
 
 };
 
+// Nodes with the same size and candidates have the same subtrees, so once one
+// is searched the others can be pruned
+struct MCKey {
+  int size;
+  BitSet<NWORDS> remaining;
+
+  bool operator==(const MCKey & other) const {
+    return size == other.size && remaining == other.remaining;
+  }
+
+  template <class Archive>
+  void serialize(Archive & ar, const unsigned int version) {
+    ar & size;
+    ar & remaining;
+  }
+};
+
+namespace std {
+template <>
+struct hash<MCKey> {
+  std::size_t operator()(const MCKey & k) const {
+    return k.remaining.hash() ^ static_cast<std::size_t>(k.size);
+  }
+};
+}
+
+MCKey nogoodKey(const MCNode & n) {
+  return MCKey { n.size, n.remaining };
+}
+typedef func<decltype(&nogoodKey), &nogoodKey> nogoodKey_func;
+
 struct GenNode : YewPar::NodeGenerator<MCNode, BitGraph<NWORDS> > {
   std::array<unsigned, NWORDS * bits_per_word> p_order;
   std::array<unsigned, NWORDS * bits_per_word> colourClass;
@@ -263,7 +297,14 @@ int hpx_main(boost::program_options::variables_map & opts) {
       YewPar::Skeletons::API::Params<int> searchParameters;
       searchParameters.spawnDepth = spawnDepth;
       auto poolType = opts["poolType"].as<std::string>();
-      if (poolType == "deque") {
+      if (opts.count("nogoods")) {
+        sol = YewPar::Skeletons::DepthBounded<GenNode,
+                                             YewPar::Skeletons::API::Optimisation,
+                                             YewPar::Skeletons::API::BoundFunction<upperBound_func>,
+                                             YewPar::Skeletons::API::NogoodKey<nogoodKey_func>,
+                                             YewPar::Skeletons::API::PruneLevel>
+            ::search(graph, root, searchParameters);
+      } else if (poolType == "deque") {
         sol = YewPar::Skeletons::DepthBounded<GenNode,
                                              YewPar::Skeletons::API::Optimisation,
                                              YewPar::Skeletons::API::BoundFunction<upperBound_func>,
@@ -291,6 +332,15 @@ int hpx_main(boost::program_options::variables_map & opts) {
                                              YewPar::Skeletons::API::BoundFunction<upperBound_func>,
                                              YewPar::Skeletons::API::PruneLevel>
           ::search(graph, root, searchParameters);
+    } else if (opts.count("nogoods")) {
+      YewPar::Skeletons::API::Params<int> searchParameters;
+      searchParameters.stealAll = static_cast<bool>(opts.count("chunked"));
+      sol = YewPar::Skeletons::StackStealing<GenNode,
+                                             YewPar::Skeletons::API::Optimisation,
+                                             YewPar::Skeletons::API::BoundFunction<upperBound_func>,
+                                             YewPar::Skeletons::API::NogoodKey<nogoodKey_func>,
+                                             YewPar::Skeletons::API::PruneLevel>
+          ::search(graph, root, searchParameters);
     } else {
       YewPar::Skeletons::API::Params<int> searchParameters;
       searchParameters.stealAll = static_cast<bool>(opts.count("chunked"));
@@ -300,6 +350,24 @@ int hpx_main(boost::program_options::variables_map & opts) {
                                              YewPar::Skeletons::API::PruneLevel>
           ::search(graph, root, searchParameters);
     }
+  } else if (skeletonType == "hybrid") {
+    YewPar::Skeletons::API::Params<int> searchParameters;
+    searchParameters.spawnDepth = spawnDepth;
+    searchParameters.stealAll = static_cast<bool>(opts.count("chunked"));
+    if (decisionBound != 0) {
+      searchParameters.expectedObjective = decisionBound;
+      sol = YewPar::Skeletons::Hybrid<GenNode,
+                                      YewPar::Skeletons::API::Decision,
+                                      YewPar::Skeletons::API::BoundFunction<upperBound_func>,
+                                      YewPar::Skeletons::API::PruneLevel>
+          ::search(graph, root, searchParameters);
+    } else {
+      sol = YewPar::Skeletons::Hybrid<GenNode,
+                                      YewPar::Skeletons::API::Optimisation,
+                                      YewPar::Skeletons::API::BoundFunction<upperBound_func>,
+                                      YewPar::Skeletons::API::PruneLevel>
+          ::search(graph, root, searchParameters);
+    }
   } else if (skeletonType == "ordered") {
     YewPar::Skeletons::API::Params<int> searchParameters;
     searchParameters.spawnDepth = spawnDepth;
@@ -327,6 +395,15 @@ int hpx_main(boost::program_options::variables_map & opts) {
                                     YewPar::Skeletons::API::Decision,
                                     YewPar::Skeletons::API::PruneLevel>
         ::search(graph, root, searchParameters);
+    } else if (opts.count("nogoods")) {
+      YewPar::Skeletons::API::Params<int> searchParameters;
+      searchParameters.backtrackBudget = opts["backtrack-budget"].as<unsigned>();
+      sol = YewPar::Skeletons::Budget<GenNode,
+                                      YewPar::Skeletons::API::Optimisation,
+                                      YewPar::Skeletons::API::BoundFunction<upperBound_func>,
+                                      YewPar::Skeletons::API::NogoodKey<nogoodKey_func>,
+                                      YewPar::Skeletons::API::PruneLevel>
+          ::search(graph, root, searchParameters);
     } else {
       YewPar::Skeletons::API::Params<int> searchParameters;
       searchParameters.backtrackBudget = opts["backtrack-budget"].as<unsigned>();
@@ -336,8 +413,28 @@ int hpx_main(boost::program_options::variables_map & opts) {
                                       YewPar::Skeletons::API::PruneLevel>
           ::search(graph, root, searchParameters);
     }
+  } else if (skeletonType == "portfolio") {
+    YewPar::Skeletons::API::Params<int> searchParameters;
+    searchParameters.restartBase = opts["restart-base"].as<std::uint64_t>();
+    searchParameters.seed = opts["seed"].as<std::uint64_t>();
+    if (decisionBound != 0) {
+      searchParameters.expectedObjective = decisionBound;
+      sol = YewPar::Skeletons::Portfolio<GenNode,
+                                         YewPar::Skeletons::API::Decision,
+                                         YewPar::Skeletons::API::BoundFunction<upperBound_func>,
+                                         YewPar::Skeletons::API::NogoodKey<nogoodKey_func>,
+                                         YewPar::Skeletons::API::PruneLevel>
+          ::search(graph, root, searchParameters);
+    } else {
+      sol = YewPar::Skeletons::Portfolio<GenNode,
+                                         YewPar::Skeletons::API::Optimisation,
+                                         YewPar::Skeletons::API::BoundFunction<upperBound_func>,
+                                         YewPar::Skeletons::API::NogoodKey<nogoodKey_func>,
+                                         YewPar::Skeletons::API::PruneLevel>
+          ::search(graph, root, searchParameters);
+    }
   } else {
-    hpx::cout << "Invalid skeleton type option. Should be: seq, depthbound, stacksteal or ordered" << hpx::endl;
+    hpx::cout << "Invalid skeleton type option. Should be: seq, depthbound, stacksteal, budget, hybrid, ordered or portfolio" << hpx::endl;
     hpx::finalize();
     return EXIT_FAILURE;
   }
@@ -358,7 +455,7 @@ int main (int argc, char* argv[]) {
   desc_commandline.add_options()
     ( "skeleton",
       boost::program_options::value<std::string>()->default_value("seq"),
-      "Which skeleton to use: seq, depthbound, stacksteal, budget, or ordered"
+      "Which skeleton to use: seq, depthbound, stacksteal, budget, hybrid, ordered, or portfolio"
       )
     ( "spawn-depth,d",
       boost::program_options::value<std::uint64_t>()->default_value(0),
@@ -374,6 +471,15 @@ int main (int argc, char* argv[]) {
       )
     ("discrepancyOrder", "Use discrepancy order for the ordered skeleton")
     ("chunked", "Use chunking with stack stealing")
+    ("nogoods", "Share searched (size, candidates) states between workers (depthbounded, stacksteal and budget optimisation only)")
+    ( "restart-base",
+      boost::program_options::value<std::uint64_t>()->default_value(1000),
+      "Nodes per unit of the Luby restart sequence (portfolio only)"
+      )
+    ( "seed",
+      boost::program_options::value<std::uint64_t>()->default_value(0),
+      "Seed for the portfolio's random child orders"
+      )
     ("poolType",
      boost::program_options::value<std::string>()->default_value("depthpool"),
      "Pool type for depthbounded skeleton")
@@ -17,6 +17,7 @@
 
 //#include "skeletons/Seq.hpp"
 #include "skeletons/DepthBounded.hpp"
+#include "skeletons/Hybrid.hpp"
 //#include "skeletons/StackStealing.hpp"
 
 // Number of Words to use in our bitset representation
@@ -250,11 +251,21 @@ int hpx_main(boost::program_options::variables_map & opts) {
 
   YewPar::Skeletons::API::Params<int> searchParameters;
   searchParameters.spawnDepth = spawnDepth;
-  auto result = YewPar::Skeletons::DepthBounded<GenNode,
-                                               YewPar::Skeletons::API::Optimisation,
-                                               YewPar::Skeletons::API::BoundFunction<upperBound_func>,
-                                               YewPar::Skeletons::API::PruneLevel>
+  MCNode result;
+  if (opts["skeleton"].as<std::string>() == "hybrid") {
+    searchParameters.stealAll = static_cast<bool>(opts.count("chunked"));
+    result = YewPar::Skeletons::Hybrid<GenNode,
+                                       YewPar::Skeletons::API::Optimisation,
+                                       YewPar::Skeletons::API::BoundFunction<upperBound_func>,
+                                       YewPar::Skeletons::API::PruneLevel>
         ::search(graph, root, searchParameters);
+  } else {
+    result = YewPar::Skeletons::DepthBounded<GenNode,
+                                             YewPar::Skeletons::API::Optimisation,
+                                             YewPar::Skeletons::API::BoundFunction<upperBound_func>,
+                                             YewPar::Skeletons::API::PruneLevel>
+        ::search(graph, root, searchParameters);
+  }
 
   auto overall_time = std::chrono::duration_cast<std::chrono::milliseconds>
     (std::chrono::steady_clock::now() - start_time);
@@ -305,6 +316,11 @@ int main (int argc, char* argv[]) {
     desc_commandline("Usage: " HPX_APPLICATION_STRING " [options]");
 
   desc_commandline.add_options()
+    ( "skeleton",
+      boost::program_options::value<std::string>()->default_value("depthbounded"),
+      "Which skeleton to use: depthbounded or hybrid"
+      )
+    ("chunked", "Use chunking when stealing from stacks (hybrid only)")
     ( "spawn-depth,d",
       boost::program_options::value<std::uint64_t>()->default_value(0),
       "Depth in the tree to spawn at"
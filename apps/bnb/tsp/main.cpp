@@ -76,19 +76,20 @@ struct NodeGen : YewPar::NodeGenerator<TSPNode, TSPSpace> {
   std::reference_wrapper<const TSPSpace> space;
   std::reference_wrapper<const TSPNode> parent;
 
+  // Copied so that moves can be generated without looking at the parent
+  std::bitset<MAX_CITIES> unvisited;
   unsigned nextToVisit;
 
   NodeGen(const TSPSpace & space, const TSPNode & n) :
-      space(std::cref(space)), parent(std::cref(n)) {
+      space(std::cref(space)), parent(std::cref(n)), unvisited(n.unvisited) {
     lastCity = n.sol.cities.back();
     numChildren = n.unvisited.count();
-    const auto & bs = parent.get().unvisited;
-    nextToVisit = next_set<MAX_CITIES>(bs, this->space.get().numCities, 0);
+    nextToVisit = next_set<MAX_CITIES>(unvisited, this->space.get().numCities, 0);
   }
 
   TSPNode next() override {
     auto nextCity = nextToVisit;
-    nextToVisit = next_set<MAX_CITIES>(parent.get().unvisited, space.get().numCities, nextToVisit);
+    nextToVisit = next_set<MAX_CITIES>(unvisited, space.get().numCities, nextToVisit);
 
     // Not quite right since partial tours don't have a length
     auto newSol = parent.get().sol;
@@ -107,6 +108,40 @@ struct NodeGen : YewPar::NodeGenerator<TSPNode, TSPSpace> {
 
     return TSPNode { newSol, newUnvisited };
   }
+
+  // In-place expansion, a move is the next city to visit
+  using Movetype = unsigned;
+
+  Movetype nextMove() {
+    auto nextCity = nextToVisit;
+    nextToVisit = next_set<MAX_CITIES>(unvisited, space.get().numCities, nextToVisit);
+    return nextCity;
+  }
+
+  static void apply(const TSPSpace & space, TSPNode & n, const Movetype & city) {
+    auto last = n.sol.cities.back();
+    n.sol.cities.push_back(city);
+    n.sol.tourLength += space.distances[last][city];
+    n.unvisited.reset(city);
+
+    // Link back to the start if we have a complete tour
+    if (n.unvisited.none()) {
+      auto start = n.sol.cities.front();
+      n.sol.cities.push_back(start);
+      n.sol.tourLength += space.distances[city][start];
+    }
+  }
+
+  static void undo(const TSPSpace & space, TSPNode & n, const Movetype & city) {
+    if (n.unvisited.none()) {
+      n.sol.cities.pop_back();
+      n.sol.tourLength -= space.distances[city][n.sol.cities.front()];
+    }
+
+    n.sol.cities.pop_back();
+    n.sol.tourLength -= space.distances[n.sol.cities.back()][city];
+    n.unvisited.set(city);
+  }
 };
 
 // Very simple MST function, nothing fancy so not the fastest
@@ -243,13 +278,23 @@ int hpx_main(boost::program_options::variables_map & opts) {
   YewPar::Skeletons::API::Params<unsigned> searchParameters;
   searchParameters.initialBound = greedyNN(distances, allCities, 1);
 
-  if (skeletonType == "seq") {
+  auto inPlace = static_cast<bool>(opts.count("inplace"));
 
-    sol = YewPar::Skeletons::Seq<NodeGen,
-                                 YewPar::Skeletons::API::Optimisation,
-                                 YewPar::Skeletons::API::BoundFunction<upperBound_func>,
-                                 YewPar::Skeletons::API::ObjectiveComparison<std::less<unsigned>>>
-        ::search(space, root, searchParameters);
+  if (skeletonType == "seq") {
+    if (inPlace) {
+      sol = YewPar::Skeletons::Seq<NodeGen,
+                                   YewPar::Skeletons::API::Optimisation,
+                                   YewPar::Skeletons::API::InPlace,
+                                   YewPar::Skeletons::API::BoundFunction<upperBound_func>,
+                                   YewPar::Skeletons::API::ObjectiveComparison<std::less<unsigned>>>
+          ::search(space, root, searchParameters);
+    } else {
+      sol = YewPar::Skeletons::Seq<NodeGen,
+                                   YewPar::Skeletons::API::Optimisation,
+                                   YewPar::Skeletons::API::BoundFunction<upperBound_func>,
+                                   YewPar::Skeletons::API::ObjectiveComparison<std::less<unsigned>>>
+          ::search(space, root, searchParameters);
+    }
   } else if (skeletonType == "depthbounded") {
     searchParameters.spawnDepth = spawnDepth;
     sol = YewPar::Skeletons::DepthBounded<NodeGen,
@@ -275,18 +320,36 @@ int hpx_main(boost::program_options::variables_map & opts) {
     }
   } else if (skeletonType == "budget") {
     searchParameters.backtrackBudget = opts["backtrack-budget"].as<unsigned>();
-    sol = YewPar::Skeletons::Budget<NodeGen,
-                                    YewPar::Skeletons::API::Optimisation,
-                                    YewPar::Skeletons::API::BoundFunction<upperBound_func>,
-                                    YewPar::Skeletons::API::ObjectiveComparison<std::less<unsigned>>>
-        ::search(space, root, searchParameters);
+    if (inPlace) {
+      sol = YewPar::Skeletons::Budget<NodeGen,
+                                      YewPar::Skeletons::API::Optimisation,
+                                      YewPar::Skeletons::API::InPlace,
+                                      YewPar::Skeletons::API::BoundFunction<upperBound_func>,
+                                      YewPar::Skeletons::API::ObjectiveComparison<std::less<unsigned>>>
+          ::search(space, root, searchParameters);
+    } else {
+      sol = YewPar::Skeletons::Budget<NodeGen,
+                                      YewPar::Skeletons::API::Optimisation,
+                                      YewPar::Skeletons::API::BoundFunction<upperBound_func>,
+                                      YewPar::Skeletons::API::ObjectiveComparison<std::less<unsigned>>>
+          ::search(space, root, searchParameters);
+    }
   } else if (skeletonType == "stacksteal") {
     searchParameters.stealAll = static_cast<bool>(opts.count("chunked"));
-    sol = YewPar::Skeletons::StackStealing<NodeGen,
-                                           YewPar::Skeletons::API::Optimisation,
-                                           YewPar::Skeletons::API::BoundFunction<upperBound_func>,
-                                           YewPar::Skeletons::API::ObjectiveComparison<std::less<unsigned>>>
-        ::search(space, root, searchParameters);
+    if (inPlace) {
+      sol = YewPar::Skeletons::StackStealing<NodeGen,
+                                             YewPar::Skeletons::API::Optimisation,
+                                             YewPar::Skeletons::API::InPlace,
+                                             YewPar::Skeletons::API::BoundFunction<upperBound_func>,
+                                             YewPar::Skeletons::API::ObjectiveComparison<std::less<unsigned>>>
+          ::search(space, root, searchParameters);
+    } else {
+      sol = YewPar::Skeletons::StackStealing<NodeGen,
+                                             YewPar::Skeletons::API::Optimisation,
+                                             YewPar::Skeletons::API::BoundFunction<upperBound_func>,
+                                             YewPar::Skeletons::API::ObjectiveComparison<std::less<unsigned>>>
+          ::search(space, root, searchParameters);
+    }
   } else {
     hpx::cout << "Invalid skeleton type\n";
     return hpx::finalize();
@@ -326,6 +389,7 @@ int main(int argc, char* argv[]) {
         )
        ("discrepancyOrder", "Use discrepancy order for the ordered skeleton")
        ("chunked", "Use chunking with stack stealing")
+       ("inplace", "Expand nodes in place (seq, budget and stacksteal skeletons only)")
        ( "spawn-depth,d",
         boost::program_options::value<unsigned>()->default_value(0),
         "Depth in the tree to spawn until (for parallel skeletons only)"
@@ -3,10 +3,10 @@
 
 #include <utility>
 
-#include "dnc/dnc-seq.hpp"
-#include "dnc/dnc-par.hpp"
-#include "dnc/dnc-dist.hpp"
-#include "dnc/macros.hpp"
+#include "YewPar.hpp"
+
+#include "skeletons/DnC.hpp"
+#include "util/func.hpp"
 
 // Fib functionality
 std::uint64_t fib(std::uint64_t n) {
@@ -25,13 +25,10 @@ std::uint64_t fib_conquer(std::uint64_t n1, std::uint64_t n2) {
   return n1 + n2;
 }
 
-// Required Action definitions
-HPX_PLAIN_ACTION(fib, fib_action)
-HPX_PLAIN_ACTION(fib_trivial, fib_trivial_action)
-HPX_PLAIN_ACTION(fib_divide, fib_divide_action)
-HPX_PLAIN_ACTION(fib_conquer, fib_conquer_action)
-YEWPAR_CREATE_DNC_PAR_ACTION(fib_par_act, std::uint64_t, fib_divide_action, fib_conquer_action, fib_trivial_action, fib_action)
-YEWPAR_CREATE_DNC_DIST_ACTION(fib_dist_act, std::uint64_t, fib_divide_action, fib_conquer_action, fib_trivial_action, fib_action)
+typedef func<decltype(&fib), &fib> fib_func;
+typedef func<decltype(&fib_trivial), &fib_trivial> fib_trivial_func;
+typedef func<decltype(&fib_divide), &fib_divide> fib_divide_func;
+typedef func<decltype(&fib_conquer), &fib_conquer> fib_conquer_func;
 
 
 int hpx_main(boost::program_options::variables_map & opts) {
@@ -50,18 +47,18 @@ int hpx_main(boost::program_options::variables_map & opts) {
   std::uint64_t res = 0;
 
   if (skeletonType == "seq") {
-    res = skeletons::DnC::Seq::dnc<std::uint64_t>
-      (fib_divide, fib_conquer, fib_trivial, fib, n);
+    res = YewPar::Skeletons::DnC::Seq<std::uint64_t, fib_divide_func, fib_conquer_func, fib_trivial_func, fib_func>
+      ::search(n);
   }
 
   if (skeletonType == "par") {
-    res = skeletons::DnC::Par::dnc<std::uint64_t, fib_divide_action, fib_conquer_action, fib_trivial_action, fib_action, fib_par_act>
-      (n);
+    res = YewPar::Skeletons::DnC::Par<std::uint64_t, fib_divide_func, fib_conquer_func, fib_trivial_func, fib_func>
+      ::search(n);
   }
 
   if (skeletonType == "dist") {
-    res = skeletons::DnC::Dist::dnc<std::uint64_t, fib_divide_action, fib_conquer_action, fib_trivial_action, fib_action, fib_dist_act>
-      (n);
+    res = YewPar::Skeletons::DnC::Dist<std::uint64_t, fib_divide_func, fib_conquer_func, fib_trivial_func, fib_func>
+      ::search(n);
   }
 
   std::cout << "Fib(" << n << ") = " << res << std::endl;
@@ -83,5 +80,7 @@ int main(int argc, char* argv[]) {
       "Type of skeleton to use: seq, par, dist"
       );
 
+  YewPar::registerPerformanceCounters();
+
   return hpx::init(desc_commandline, argc, argv);
 }
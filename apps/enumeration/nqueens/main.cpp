@@ -11,10 +11,13 @@
 #include <hpx/include/iostreams.hpp>
 
 #include "YewPar.hpp"
+#include "util/BitwiseNode.hpp"
+#include "util/func.hpp"
 #include "skeletons/Seq.hpp"
 #include "skeletons/DepthBounded.hpp"
 #include "skeletons/StackStealing.hpp"
 #include "skeletons/Budget.hpp"
+#include "skeletons/Hybrid.hpp"
 
 // N-queens doesn't have a space
 struct Empty {};
@@ -43,7 +46,10 @@ namespace hpx { namespace serialization {
   }
 }}
 
-struct NodeGen : YewPar::NodeGenerator<Node, Empty> {
+// Nodes are sent as a single memcpy
+YEWPAR_BITWISE_NODE(Node)
+
+struct NodeGen : YewPar::StaticNodeGenerator<NodeGen, Node, Empty> {
   std::uint32_t all;
   std::uint32_t poss;
   std::uint32_t ld;
@@ -56,7 +62,7 @@ struct NodeGen : YewPar::NodeGenerator<Node, Empty> {
     this->numChildren = __builtin_popcount(poss);
   }
 
-  Node next() override {
+  Node next() {
       auto bit = poss & -poss;
       poss -= bit;
 
@@ -67,23 +73,63 @@ struct NodeGen : YewPar::NodeGenerator<Node, Empty> {
 
       return Node (all, new_ld, new_cols, new_rd, newP);
   }
+
+  // Generate all remaining children in one pass over the possible columns
+  unsigned nextBatch(Node * out, unsigned n) {
+    auto i = 0u;
+    for (; i < n && poss; ++i) {
+      auto bit = poss & -poss;
+      poss -= bit;
+
+      auto new_ld = (ld | bit) << 1;
+      auto new_cols = cols | bit;
+      auto new_rd = (rd | bit) >> 1;
+      out[i] = Node(all, new_ld, new_cols, new_rd, ~(new_ld | new_cols | new_rd) & all);
+    }
+    return i;
+  }
 };
 
-struct CountSols : YewPar::Enumerator<Node, std::uint64_t> {
+struct CountSols : YewPar::StaticEnumerator<CountSols, Node, std::uint64_t> {
   std::uint64_t count;
   CountSols() : count(0) {};
 
-  void accumulate(const Node & n) override {
+  void accumulate(const Node & n) {
     if (n.cols == n.all) { count++; }
   }
 
-  void combine(const std::uint64_t & other) override {
+  void combine(const std::uint64_t & other) {
     count += other;
   }
 
-  std::uint64_t get() override { return count; }
+  std::uint64_t get() { return count; }
 };
 
+// Folds over the whole tree: nodes by the number of queens placed, and a
+// uniform sample of the nodes
+std::size_t queensPlaced(const Node & n) { return __builtin_popcount(n.cols); }
+typedef func<decltype(&queensPlaced), &queensPlaced> queens_func;
+typedef YewPar::HistogramEnumerator<Node, queens_func> QueensHistogram;
+typedef YewPar::SampleEnumerator<Node, 16> NodeSample;
+
+template <typename Enum>
+typename Enum::ResT foldTree(const std::string & skeleton, const Node & root, unsigned spawnDepth) {
+  YewPar::Skeletons::API::Params<> searchParameters;
+  if (skeleton == "depthbounded") {
+    searchParameters.spawnDepth = spawnDepth;
+    return YewPar::Skeletons::DepthBounded<NodeGen,
+                                           YewPar::Skeletons::API::Enumeration,
+                                           YewPar::Skeletons::API::Enumerator<Enum>,
+                                           YewPar::Skeletons::API::DepthLimited>
+        ::search(Empty(), root, searchParameters);
+  }
+  return YewPar::Skeletons::Seq<NodeGen,
+                                YewPar::Skeletons::API::Enumeration,
+                                YewPar::Skeletons::API::Enumerator<Enum>,
+                                YewPar::Skeletons::API::DepthLimited>
+      ::search(Empty(), root, searchParameters);
+}
+
 int hpx_main(boost::program_options::variables_map & opts) {
   auto spawnDepth = opts["spawn-depth"].as<unsigned>();
   auto size = opts["size"].as<unsigned>();
@@ -92,6 +138,22 @@ int hpx_main(boost::program_options::variables_map & opts) {
   auto all = (1 << size) - 1;
   Node root(all, 0, 0, 0, all);
 
+  if (opts.count("fold")) {
+    auto fold = opts["fold"].as<std::string>();
+    if (fold == "histogram") {
+      auto counts = foldTree<QueensHistogram>(skeleton, root, spawnDepth);
+      for (auto i = 0u; i < counts.size(); ++i) {
+        hpx::cout << "Nodes with " << i << " queens: " << counts[i] << hpx::endl;
+      }
+    } else if (fold == "sample") {
+      auto sample = foldTree<NodeSample>(skeleton, root, spawnDepth);
+      hpx::cout << "Sampled " << sample.nodes.size() << " of " << sample.seen << " nodes" << hpx::endl;
+    } else {
+      hpx::cout << "Invalid fold: " << fold << hpx::endl;
+    }
+    return hpx::finalize();
+  }
+
   auto start_time = std::chrono::steady_clock::now();
 
   std::uint64_t count;
@@ -110,6 +172,15 @@ int hpx_main(boost::program_options::variables_map & opts) {
                                               YewPar::Skeletons::API::Enumerator<CountSols>,
                                               YewPar::Skeletons::API::DepthLimited>
              ::search(Empty(), root, searchParameters);
+  } else if (skeleton == "stacksteal" && opts["verbose"].as<bool>()){
+    YewPar::Skeletons::API::Params<> searchParameters;
+    searchParameters.stealAll = static_cast<bool>(opts.count("chunked"));
+    count = YewPar::Skeletons::StackStealing<NodeGen,
+                                              YewPar::Skeletons::API::Enumeration,
+                                              YewPar::Skeletons::API::Enumerator<CountSols>,
+                                              YewPar::Skeletons::API::DepthLimited,
+                                              YewPar::Skeletons::API::Verbose>
+             ::search(Empty(), root, searchParameters);
   } else if (skeleton == "stacksteal"){
     YewPar::Skeletons::API::Params<> searchParameters;
     searchParameters.stealAll = static_cast<bool>(opts.count("chunked"));
@@ -118,9 +189,20 @@ int hpx_main(boost::program_options::variables_map & opts) {
                                               YewPar::Skeletons::API::Enumerator<CountSols>,
                                               YewPar::Skeletons::API::DepthLimited>
              ::search(Empty(), root, searchParameters);
+  } else if (skeleton == "hybrid"){
+    YewPar::Skeletons::API::Params<> searchParameters;
+    searchParameters.spawnDepth = spawnDepth;
+    searchParameters.stealAll = static_cast<bool>(opts.count("chunked"));
+    count = YewPar::Skeletons::Hybrid<NodeGen,
+                                       YewPar::Skeletons::API::Enumeration,
+                                       YewPar::Skeletons::API::Enumerator<CountSols>,
+                                       YewPar::Skeletons::API::DepthLimited>
+        ::search(Empty(), root, searchParameters);
   } else if (skeleton == "budget"){
     YewPar::Skeletons::API::Params<> searchParameters;
     searchParameters.backtrackBudget = opts["backtrack-budget"].as<unsigned>();
+    searchParameters.adaptiveBudget = static_cast<bool>(opts.count("adaptive-budget"));
+    searchParameters.demandSpawning = static_cast<bool>(opts.count("demand-spawning"));
     count = YewPar::Skeletons::Budget<NodeGen,
                                        YewPar::Skeletons::API::Enumeration,
                                        YewPar::Skeletons::API::Enumerator<CountSols>,
@@ -149,7 +231,7 @@ int main(int argc, char* argv[]) {
   desc_commandline.add_options()
     ( "skeleton",
       boost::program_options::value<std::string>()->default_value("seq"),
-      "Which skeleton to use: seq, depthbound, stacksteal, or budget"
+      "Which skeleton to use: seq, depthbound, stacksteal, hybrid, or budget"
     )
     ( "spawn-depth,d",
       boost::program_options::value<unsigned>()->default_value(0),
@@ -165,9 +247,15 @@ int main(int argc, char* argv[]) {
     )
     ( "verbose,v",
       boost::program_options::value<bool>()->default_value(false),
-      "Enable verbose output"
+      "Enable verbose output (stacksteal only)"
+    )
+    ( "fold",
+      boost::program_options::value<std::string>(),
+      "Fold over the tree rather than count solutions: histogram or sample (seq and depthbounded only)"
     )
-    ("chunked", "Use chunking with stack stealing");
+    ("chunked", "Use chunking with stack stealing")
+    ("adaptive-budget", "Adapt the backtrack budget to demand for work (budget only)")
+    ("demand-spawning", "Only spawn one task per idle worker when the budget runs out (budget only)");
 
   YewPar::registerPerformanceCounters();
 
@@ -0,0 +1,17 @@
+# Checks a file written with --stream-file holds EXPECTED distinct lines.
+#   cmake -DFILE=<stream file> -DEXPECTED=<lines> -P CheckStream.cmake
+if (NOT EXISTS "${FILE}")
+  message(FATAL_ERROR "Stream file ${FILE} was not written")
+endif ()
+
+file(STRINGS "${FILE}" lines)
+list(LENGTH lines total)
+if (NOT total EQUAL EXPECTED)
+  message(FATAL_ERROR "${FILE} has ${total} lines, expected ${EXPECTED}")
+endif ()
+
+list(REMOVE_DUPLICATES lines)
+list(LENGTH lines distinct)
+if (NOT distinct EQUAL total)
+  message(FATAL_ERROR "${FILE} has ${distinct} distinct lines out of ${total}")
+endif ()
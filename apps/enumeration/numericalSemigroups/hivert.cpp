@@ -4,15 +4,20 @@
 
 #include <hpx/hpx_init.hpp>
 #include <hpx/include/iostreams.hpp>
+#include <hpx/lcos/broadcast.hpp>
 
 #include <vector>
 #include <chrono>
+#include <cstdint>
+#include <string>
 
 #include "YewPar.hpp"
 #include "skeletons/Seq.hpp"
 #include "skeletons/DepthBounded.hpp"
 #include "skeletons/StackStealing.hpp"
 #include "skeletons/Budget.hpp"
+#include "util/func.hpp"
+#include "util/Stream.hpp"
 
 #include "monoid.hpp"
 
@@ -57,55 +62,125 @@ struct CountDepths : YewPar::Enumerator<Monoid, std::vector<uint64_t>> {
 };
 
 
-int hpx_main(boost::program_options::variables_map & opts) {
-  auto spawnDepth = opts["spawn-depth"].as<unsigned>();
-  auto maxDepth   = opts["genus"].as<unsigned>();
-  auto skeleton   = opts["skeleton"].as<std::string>();
-  //auto stealAll   = opts["stealall"].as<bool>();
+// Stream every semigroup of a given genus, as its minimal generators. The
+// genus is needed wherever semigroups are found, so is set on every locality
+static unsigned streamGenus = 0;
 
-  Monoid root;
-  init_full_N(root);
+void setStreamGenus(unsigned genus) { streamGenus = genus; }
+struct SetStreamGenusAct : hpx::actions::make_action<decltype(&setStreamGenus), &setStreamGenus, SetStreamGenusAct>::type {};
 
-  auto start_time = std::chrono::steady_clock::now();
+bool hasStreamGenus(const Monoid & m) { return m.genus == streamGenus; }
+typedef func<decltype(&hasStreamGenus), &hasStreamGenus> stream_pred;
+
+std::string formatGenerators(const Monoid & m) {
+  std::string res;
+  generator_iter<ALL> it(m);
+  auto n = it.count(m);
+  for (auto i = 0; i < n; ++i) {
+    it.move_next(m);
+    if (i > 0) {
+      res += " ";
+    }
+    res += std::to_string(it.get_gen());
+  }
+  return res;
+}
+typedef func<decltype(&formatGenerators), &formatGenerators> format_func;
+
+typedef YewPar::Stream::FileSink<Monoid, format_func> SemigroupSink;
+typedef YewPar::Stream::StreamEnumerator<Monoid, stream_pred, SemigroupSink> StreamSemigroups;
+
+template <typename Enum>
+bool runSearch(boost::program_options::variables_map & opts,
+               const Monoid & root,
+               const unsigned maxDepth,
+               typename Enum::ResT & res) {
+  auto spawnDepth = opts["spawn-depth"].as<unsigned>();
+  auto skeleton   = opts["skeleton"].as<std::string>();
 
-  std::vector<std::uint64_t> counts;
   if (skeleton == "seq") {
     YewPar::Skeletons::API::Params<> searchParameters;
     searchParameters.maxDepth = maxDepth;
-    counts = YewPar::Skeletons::Seq<NodeGen,
-                                    YewPar::Skeletons::API::Enumeration,
-                                    YewPar::Skeletons::API::Enumerator<CountDepths>,
-                                    YewPar::Skeletons::API::DepthLimited>
-             ::search(Empty(), root, searchParameters);
+    res = YewPar::Skeletons::Seq<NodeGen,
+                                 YewPar::Skeletons::API::Enumeration,
+                                 YewPar::Skeletons::API::Enumerator<Enum>,
+                                 YewPar::Skeletons::API::DepthLimited>
+          ::search(Empty(), root, searchParameters);
   } else if (skeleton == "depthbounded") {
     YewPar::Skeletons::API::Params<> searchParameters;
     searchParameters.maxDepth   = maxDepth;
     searchParameters.spawnDepth = spawnDepth;
-    counts = YewPar::Skeletons::DepthBounded<NodeGen,
+    searchParameters.checkpointInterval = opts["checkpoint-interval"].as<std::uint64_t>();
+    searchParameters.checkpointFile = opts["checkpoint-file"].as<std::string>();
+    searchParameters.estimatorProbes = opts["estimator-probes"].as<unsigned>();
+    searchParameters.minTaskNodes = opts["min-task-nodes"].as<std::uint64_t>();
+    typedef YewPar::Skeletons::DepthBounded<NodeGen,
                                             YewPar::Skeletons::API::Enumeration,
-                                            YewPar::Skeletons::API::Enumerator<CountDepths>,
-                                            YewPar::Skeletons::API::DepthLimited>
-             ::search(Empty(), root, searchParameters);
+                                            YewPar::Skeletons::API::Enumerator<Enum>,
+                                            YewPar::Skeletons::API::DepthLimited> Skel;
+    if (opts.count("resume")) {
+      res = Skel::resume(Empty(), opts["resume"].as<std::string>(), searchParameters);
+    } else {
+      res = Skel::search(Empty(), root, searchParameters);
+    }
   } else if (skeleton == "stacksteal"){
     YewPar::Skeletons::API::Params<> searchParameters;
     searchParameters.maxDepth = maxDepth;
     searchParameters.stealAll = static_cast<bool>(opts.count("chunked"));
-    counts = YewPar::Skeletons::StackStealing<NodeGen,
-                                              YewPar::Skeletons::API::Enumeration,
-                                              YewPar::Skeletons::API::Enumerator<CountDepths>,
-                                              YewPar::Skeletons::API::DepthLimited>
-             ::search(Empty(), root, searchParameters);
+    res = YewPar::Skeletons::StackStealing<NodeGen,
+                                           YewPar::Skeletons::API::Enumeration,
+                                           YewPar::Skeletons::API::Enumerator<Enum>,
+                                           YewPar::Skeletons::API::DepthLimited>
+          ::search(Empty(), root, searchParameters);
   } else if (skeleton == "budget"){
     YewPar::Skeletons::API::Params<> searchParameters;
     searchParameters.backtrackBudget = opts["backtrack-budget"].as<unsigned>();
     searchParameters.maxDepth   = maxDepth;
-    counts = YewPar::Skeletons::Budget<NodeGen,
-                                       YewPar::Skeletons::API::Enumeration,
-                                       YewPar::Skeletons::API::Enumerator<CountDepths>,
-                                       YewPar::Skeletons::API::DepthLimited>
+    res = YewPar::Skeletons::Budget<NodeGen,
+                                    YewPar::Skeletons::API::Enumeration,
+                                    YewPar::Skeletons::API::Enumerator<Enum>,
+                                    YewPar::Skeletons::API::DepthLimited>
         ::search(Empty(), root, searchParameters);
   } else {
     hpx::cout << "Invalid skeleton type: " << skeleton << hpx::endl;
+    return false;
+  }
+  return true;
+}
+
+int hpx_main(boost::program_options::variables_map & opts) {
+  auto maxDepth   = opts["genus"].as<unsigned>();
+  //auto stealAll   = opts["stealall"].as<bool>();
+
+  Monoid root;
+  init_full_N(root);
+
+  auto start_time = std::chrono::steady_clock::now();
+
+  if (opts.count("stream-genus")) {
+    auto genus = opts["stream-genus"].as<unsigned>();
+    hpx::wait_all(hpx::lcos::broadcast<SetStreamGenusAct>(hpx::find_all_localities(), genus));
+
+    std::uint64_t streamed;
+    SemigroupSink::start(opts["stream-file"].as<std::string>());
+    auto ok = runSearch<StreamSemigroups>(opts, root, genus, streamed);
+    SemigroupSink::finish();
+    if (!ok) {
+      return hpx::finalize();
+    }
+
+    auto overall_time = std::chrono::duration_cast<std::chrono::milliseconds>
+                        (std::chrono::steady_clock::now() - start_time);
+
+    hpx::cout << "Semigroups streamed: " << streamed << hpx::endl;
+    hpx::cout << "=====" << hpx::endl;
+    hpx::cout << "cpu = " << overall_time.count() << hpx::endl;
+
+    return hpx::finalize();
+  }
+
+  std::vector<std::uint64_t> counts;
+  if (!runSearch<CountDepths>(opts, root, maxDepth, counts)) {
     return hpx::finalize();
   }
 
@@ -147,6 +222,34 @@ int main(int argc, char* argv[]) {
       boost::program_options::value<bool>()->default_value(false),
       "Enable verbose output"
     )
+    ( "estimator-probes",
+      boost::program_options::value<unsigned>()->default_value(0),
+      "Random probes per subtree size estimate (depthbounded only, 0 disables)"
+    )
+    ( "min-task-nodes",
+      boost::program_options::value<std::uint64_t>()->default_value(0),
+      "Don't spawn subtrees estimated to be smaller than this (requires --estimator-probes)"
+    )
+    ( "checkpoint-interval",
+      boost::program_options::value<std::uint64_t>()->default_value(0),
+      "Checkpoint the search every this many milliseconds (depthbounded only, 0 disables)"
+    )
+    ( "checkpoint-file",
+      boost::program_options::value<std::string>()->default_value("ns.ckpt"),
+      "File to write checkpoints to"
+    )
+    ( "resume",
+      boost::program_options::value<std::string>(),
+      "Resume a (depthbounded) search from this checkpoint file"
+    )
+    ( "stream-genus",
+      boost::program_options::value<unsigned>(),
+      "Write every semigroup of this genus (as its minimal generators) to --stream-file rather than counting"
+    )
+    ( "stream-file",
+      boost::program_options::value<std::string>()->default_value("semigroups.txt"),
+      "File to stream semigroups to"
+    )
     ("chunked", "Use chunking with stack stealing");
 
   YewPar::registerPerformanceCounters();
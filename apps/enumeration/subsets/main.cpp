@@ -0,0 +1,189 @@
+// Subset lattice: a search space that is a DAG rather than a tree.
+//
+// Nodes are subsets of {0..n-1} with at most k elements and the children of a
+// set are every set with one more element. Each set of size i is reached along
+// i! paths, so searching it as a tree visits sum_{i<=k} n!/(n-i)! nodes while
+// only sum_{i<=k} C(n,i) are distinct. With --transposition visited sets are
+// skipped (see YewPar::Transposition).
+
+#include <hpx/hpx_init.hpp>
+#include <hpx/include/iostreams.hpp>
+
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+
+#include "YewPar.hpp"
+#include "util/BitwiseNode.hpp"
+#include "util/func.hpp"
+#include "skeletons/Seq.hpp"
+#include "skeletons/DepthBounded.hpp"
+#include "skeletons/StackStealing.hpp"
+#include "skeletons/Budget.hpp"
+#include "skeletons/Hybrid.hpp"
+
+struct Lattice {
+  unsigned n;
+  unsigned k;
+
+  template <class Archive>
+  void serialize(Archive & ar, const unsigned int version) {
+    ar & n;
+    ar & k;
+  }
+};
+
+struct Node {
+  std::uint64_t set;
+
+  template <class Archive>
+  void serialize(Archive & ar, const unsigned int version) {
+    ar & set;
+  }
+};
+
+// Nodes are sent as a single memcpy
+YEWPAR_BITWISE_NODE(Node)
+
+struct NodeGen : YewPar::StaticNodeGenerator<NodeGen, Node, Lattice> {
+  std::uint64_t set;
+  std::uint64_t remaining;
+
+  NodeGen() { this->numChildren = 0; }
+
+  NodeGen(const Lattice & l, const Node & parent) : set(parent.set) {
+    auto all = l.n == 64 ? ~0ull : (1ull << l.n) - 1;
+    remaining = all & ~set;
+    this->numChildren = static_cast<unsigned>(__builtin_popcountll(set)) < l.k ? __builtin_popcountll(remaining) : 0;
+  }
+
+  Node next() {
+    auto bit = remaining & -remaining;
+    remaining -= bit;
+    return Node { set | bit };
+  }
+};
+
+// The set is its own (exact) hash
+std::uint64_t stateHash(const Node & n) { return n.set; }
+typedef func<decltype(&stateHash), &stateHash> hash_func;
+
+typedef YewPar::CountNodesEnumerator<Node> Count;
+
+template <typename ...TT>
+std::uint64_t runSearch(const std::string & skeleton,
+                        const Lattice & space,
+                        const Node & root,
+                        YewPar::Skeletons::API::Params<> & searchParameters,
+                        boost::program_options::variables_map & opts) {
+  if (skeleton == "seq") {
+    return YewPar::Skeletons::Seq<NodeGen,
+                                  YewPar::Skeletons::API::Enumeration,
+                                  YewPar::Skeletons::API::Enumerator<Count>,
+                                  TT...>
+        ::search(space, root, searchParameters);
+  } else if (skeleton == "depthbounded") {
+    searchParameters.spawnDepth = opts["spawn-depth"].as<unsigned>();
+    return YewPar::Skeletons::DepthBounded<NodeGen,
+                                           YewPar::Skeletons::API::Enumeration,
+                                           YewPar::Skeletons::API::Enumerator<Count>,
+                                           TT...>
+        ::search(space, root, searchParameters);
+  } else if (skeleton == "stacksteal") {
+    searchParameters.stealAll = static_cast<bool>(opts.count("chunked"));
+    return YewPar::Skeletons::StackStealing<NodeGen,
+                                            YewPar::Skeletons::API::Enumeration,
+                                            YewPar::Skeletons::API::Enumerator<Count>,
+                                            TT...>
+        ::search(space, root, searchParameters);
+  } else if (skeleton == "budget") {
+    searchParameters.backtrackBudget = opts["backtrack-budget"].as<unsigned>();
+    return YewPar::Skeletons::Budget<NodeGen,
+                                     YewPar::Skeletons::API::Enumeration,
+                                     YewPar::Skeletons::API::Enumerator<Count>,
+                                     TT...>
+        ::search(space, root, searchParameters);
+  } else if (skeleton == "hybrid") {
+    searchParameters.spawnDepth = opts["spawn-depth"].as<unsigned>();
+    searchParameters.stealAll = static_cast<bool>(opts.count("chunked"));
+    return YewPar::Skeletons::Hybrid<NodeGen,
+                                     YewPar::Skeletons::API::Enumeration,
+                                     YewPar::Skeletons::API::Enumerator<Count>,
+                                     TT...>
+        ::search(space, root, searchParameters);
+  }
+
+  throw std::invalid_argument("Invalid skeleton type: " + skeleton);
+}
+
+int hpx_main(boost::program_options::variables_map & opts) {
+  auto skeleton = opts["skeleton"].as<std::string>();
+
+  Lattice space { opts["size"].as<unsigned>(), opts["max-set"].as<unsigned>() };
+  if (space.n > 64) {
+    hpx::cout << "Sets are limited to 64 elements" << hpx::endl;
+    return hpx::finalize();
+  }
+  Node root { 0 };
+
+  YewPar::Skeletons::API::Params<> searchParameters;
+  searchParameters.transpositionCapacity = opts["tt-capacity"].as<std::uint64_t>();
+  searchParameters.transpositionDistributed = static_cast<bool>(opts.count("tt-distributed"));
+
+  auto start_time = std::chrono::steady_clock::now();
+
+  std::uint64_t count;
+  if (opts.count("transposition")) {
+    count = runSearch<YewPar::Skeletons::API::TranspositionKey<hash_func>,
+                      YewPar::Skeletons::API::MoreVerbose>(skeleton, space, root, searchParameters, opts);
+  } else {
+    count = runSearch<>(skeleton, space, root, searchParameters, opts);
+  }
+
+  auto overall_time = std::chrono::duration_cast<std::chrono::milliseconds>
+                      (std::chrono::steady_clock::now() - start_time);
+
+  hpx::cout << "Nodes: " << count << hpx::endl;
+  hpx::cout << "cpu = " << overall_time.count() << hpx::endl;
+
+  return hpx::finalize();
+}
+
+int main(int argc, char* argv[]) {
+  boost::program_options::options_description
+    desc_commandline("Usage: " HPX_APPLICATION_STRING " [options]");
+
+  desc_commandline.add_options()
+    ( "skeleton",
+      boost::program_options::value<std::string>()->default_value("seq"),
+      "Which skeleton to use: seq, depthbounded, stacksteal, budget, or hybrid"
+    )
+    ( "size,n",
+      boost::program_options::value<unsigned>()->default_value(20),
+      "Number of elements"
+    )
+    ( "max-set,k",
+      boost::program_options::value<unsigned>()->default_value(5),
+      "Largest set to generate"
+    )
+    ( "spawn-depth,d",
+      boost::program_options::value<unsigned>()->default_value(2),
+      "Depth in the tree to spawn until (depthbounded and hybrid only)"
+    )
+    ( "backtrack-budget,b",
+      boost::program_options::value<unsigned>()->default_value(500),
+      "Number of backtracks before spawning work"
+    )
+    ("chunked", "Use chunking with stack stealing")
+    ("transposition", "Skip sets that have already been visited")
+    ( "tt-capacity",
+      boost::program_options::value<std::uint64_t>()->default_value(1 << 22),
+      "Transposition table entries"
+    )
+    ("tt-distributed", "Check each set on the locality that owns it so none is visited twice on any locality");
+
+  YewPar::registerPerformanceCounters();
+
+  return hpx::init(desc_commandline, argc, argv);
+}
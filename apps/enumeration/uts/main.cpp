@@ -6,6 +6,7 @@
 #include "uts-rng/rng.h"
 
 #include "YewPar.hpp"
+#include "util/BitwiseNode.hpp"
 #include "skeletons/Seq.hpp"
 #include "skeletons/DepthBounded.hpp"
 #include "skeletons/StackStealing.hpp"
@@ -59,11 +60,14 @@ struct UTSNode {
   }
 };
 
+// Nodes are sent as a single memcpy
+YEWPAR_BITWISE_NODE(UTSNode)
+
 template <TreeType t>
 struct NodeGen {};
 
 template <>
-struct NodeGen<TreeType::BINOMIAL> : YewPar::NodeGenerator<UTSNode, UTSState> {
+struct NodeGen<TreeType::BINOMIAL> : YewPar::StaticNodeGenerator<NodeGen<TreeType::BINOMIAL>, UTSNode, UTSState> {
   UTSNode parent;
   UTSState params;
   int i = 0;
@@ -92,7 +96,7 @@ struct NodeGen<TreeType::BINOMIAL> : YewPar::NodeGenerator<UTSNode, UTSState> {
     this->numChildren = calcNumChildren();
   }
 
-  UTSNode next() override {
+  UTSNode next() {
     UTSNode child { false, parent.depth + 1 };
     rng_spawn(parent.rngstate.state, child.rngstate.state, i);
     ++i;
@@ -102,7 +106,7 @@ struct NodeGen<TreeType::BINOMIAL> : YewPar::NodeGenerator<UTSNode, UTSState> {
 };
 
 template <>
-struct NodeGen<TreeType::GEOMETRIC> : YewPar::NodeGenerator<UTSNode, UTSState> {
+struct NodeGen<TreeType::GEOMETRIC> : YewPar::StaticNodeGenerator<NodeGen<TreeType::GEOMETRIC>, UTSNode, UTSState> {
   UTSNode parent;
   UTSState params;
   int i = 0;
@@ -151,7 +155,7 @@ struct NodeGen<TreeType::GEOMETRIC> : YewPar::NodeGenerator<UTSNode, UTSState> {
     return (int) floor(log(1 - u) / log(1 - p));
   }
 
-  UTSNode next() override {
+  UTSNode next() {
     UTSNode child { false, parent.depth + 1 };
     rng_spawn(parent.rngstate.state, child.rngstate.state, i);
     ++i;
@@ -161,19 +165,19 @@ struct NodeGen<TreeType::GEOMETRIC> : YewPar::NodeGenerator<UTSNode, UTSState> {
 };
 
 
-struct CountNodes : YewPar::Enumerator<UTSNode, std::uint64_t> {
+struct CountNodes : YewPar::StaticEnumerator<CountNodes, UTSNode, std::uint64_t> {
   std::uint64_t count;
   CountNodes() : count(0) {};
 
-  void accumulate(const UTSNode & n) override {
+  void accumulate(const UTSNode & n) {
     count++;
   }
 
-  void combine(const std::uint64_t & other) override {
+  void combine(const std::uint64_t & other) {
     count += other;
   }
 
-  std::uint64_t get() override { return count; }
+  std::uint64_t get() { return count; }
 };
 
 #ifndef UTS_MAX_TREE_DEPTH
@@ -2,6 +2,7 @@
 #include "workstealing/policies/Workpool.hpp"
 #include "workstealing/policies/PriorityOrdered.hpp"
 #include "workstealing/policies/DepthPoolPolicy.hpp"
+#include "workstealing/SchedulerPerf.hpp"
 
 namespace YewPar {
 
@@ -10,6 +11,7 @@ void registerPerformanceCounters() {
   hpx::register_startup_function(&Workstealing::Policies::WorkpoolPerf::registerPerformanceCounters);
   hpx::register_startup_function(&Workstealing::Policies::PriorityOrderedPerf::registerPerformanceCounters);
   hpx::register_startup_function(&Workstealing::Policies::DepthPoolPolicyPerf::registerPerformanceCounters);
+  hpx::register_startup_function(&Workstealing::SchedulerPerf::registerPerformanceCounters);
 }
 
 }
@@ -1,6 +1,9 @@
 #ifndef SKELETONS_API_HPP
 #define SKELETONS_API_HPP
 
+#include <cstdint>
+#include <string>
+
 #include <boost/parameter.hpp>
 #include <boost/serialization/access.hpp>
 
@@ -31,9 +34,32 @@ BOOST_PARAMETER_TEMPLATE_KEYWORD(ObjectiveComparison)
 BOOST_PARAMETER_TEMPLATE_KEYWORD(MaxStackDepth)
 BOOST_PARAMETER_TEMPLATE_KEYWORD(Enumerator)
 
+// Collect the params.numSolutions best solutions (or all optimal solutions)
+// rather than a single incumbent. Optimisation search then returns a vector
+DEF_PRESENT_PARAMETER(CollectSolutions, CollectSolutions_)
+
+// Called (on the master locality) with each new incumbent as it is found. Use
+// func<> to wrap a void(const Node &) function
+BOOST_PARAMETER_TEMPLATE_KEYWORD(IncumbentCallback)
+
+// Share nogoods between workers: a func mapping a node to a canonical key (see
+// util/Nogoods.hpp). Decision and Optimisation searches only, and not with
+// CollectSolutions
+BOOST_PARAMETER_TEMPLATE_KEYWORD(NogoodKey)
+
+// Skip states that have already been visited, for search spaces that are DAGs:
+// a func mapping a node to a 64 bit hash of its state (see
+// util/TranspositionTable.hpp)
+BOOST_PARAMETER_TEMPLATE_KEYWORD(TranspositionKey)
+
 // Optimisations
 DEF_PRESENT_PARAMETER(PruneLevel, PruneLevel_)
 
+// Walk the tree by applying/undoing moves on a single node rather than copying
+// children (requires the generator to support nextMove/apply/undo). Supported
+// by Seq, Budget, StackStealing and, below its spawn depth, Hybrid
+DEF_PRESENT_PARAMETER(InPlace, InPlace_)
+
 // Depth bounded policies
 BOOST_PARAMETER_TEMPLATE_KEYWORD(DepthBoundedPoolPolicy)
 
@@ -64,6 +90,37 @@ struct Params {
   // For B&B
   Obj initialBound = false;
 
+  // For CollectSolutions. The number of best solutions to return, 0 returns
+  // every solution tied with the optimum
+  unsigned numSolutions = 1;
+
+  // Anytime search. Stop after timeout milliseconds, or after (roughly)
+  // nodeLimit nodes, and return the best found so far. 0 is unlimited
+  std::uint64_t timeout = 0;
+  std::uint64_t nodeLimit = 0;
+
+  // Subtree size estimation. Random probes used per estimate (0 disables).
+  // Subtrees estimated to have fewer than minTaskNodes nodes stay with the
+  // worker that has them: DepthBounded searches them in the parent task,
+  // Budget doesn't spawn them and StackStealing doesn't give them to thieves.
+  // StackStealing also uses the estimates to spawn its initial work at a depth
+  // where no one subtree dominates
+  unsigned estimatorProbes = 0;
+  std::uint64_t minTaskNodes = 0;
+
+  // Checkpointing. Write a snapshot of the search to checkpointFile every
+  // checkpointInterval milliseconds (0 never checkpoints). Only the master
+  // locality writes the file, so checkpointFile isn't serialised
+  std::uint64_t checkpointInterval = 0;
+  std::string checkpointFile;
+
+  // Tracing. Record what every worker does during the search and write it to
+  // traceFile (see util/Trace.hpp), keeping the last traceEvents events per
+  // worker. Empty doesn't trace. Only used on the master locality so not
+  // serialised
+  std::string traceFile;
+  std::uint64_t traceEvents = 1 << 16;
+
   // Depth Spawns
   unsigned spawnDepth = 1;
 
@@ -74,6 +131,28 @@ struct Params {
   // Budget
   // FIXME: How to determine a good value for this?
   unsigned backtrackBudget = 200;
+  // Adapt each worker's budget at runtime (starting from backtrackBudget) from
+  // how often workers fail to find work and how long its tasks run
+  bool adaptiveBudget = false;
+  // When the budget runs out spawn one task per idle worker (from the
+  // shallowest levels) rather than every remaining child
+  bool demandSpawning = false;
+
+  // Nogoods (with NogoodKey). Keys kept per locality, and how many new ones
+  // are batched before sending them to the other localities (0 never sends)
+  std::uint64_t nogoodCapacity = 1 << 20;
+  unsigned nogoodExchange = 256;
+
+  // Transposition table (with TranspositionKey). Entries per search, and
+  // whether states are checked on their owning locality so that none is
+  // visited twice anywhere (otherwise localities only skip their own)
+  std::uint64_t transpositionCapacity = 1 << 22;
+  bool transpositionDistributed = false;
+
+  // Portfolio. Nodes per unit of the Luby restart sequence, and the seed each
+  // worker's random child order is derived from
+  std::uint64_t restartBase = 100;
+  std::uint64_t seed = 0;
 
   // Needed to push to registries on all nodes
   template <class Archive>
@@ -81,9 +160,23 @@ struct Params {
     ar & maxDepth;
     ar & expectedObjective;
     ar & initialBound;
+    ar & numSolutions;
+    ar & timeout;
+    ar & nodeLimit;
+    ar & estimatorProbes;
+    ar & minTaskNodes;
+    ar & checkpointInterval;
     ar & spawnDepth;
     ar & stealAll;
     ar & backtrackBudget;
+    ar & adaptiveBudget;
+    ar & demandSpawning;
+    ar & nogoodCapacity;
+    ar & nogoodExchange;
+    ar & transpositionCapacity;
+    ar & transpositionDistributed;
+    ar & restartBase;
+    ar & seed;
   }
 };
 
@@ -1,17 +1,17 @@
 #ifndef SKELETONS_BUDGET_HPP
 #define SKELETONS_BUDGET_HPP
 
+#include <algorithm>
+#include <limits>
+
 #include <hpx/include/iostreams.hpp>
 
 #include <boost/format.hpp>
 
-namespace YewPar { namespace Skeletons {
-
-namespace detail {
-template <typename Generator, typename ...Args>
-struct BudgetSubtreeTask;
-}
+#include "util/TerminationDetection.hpp"
+#include "util/TaskPool.hpp"
 
+namespace YewPar { namespace Skeletons {
 
 template <typename Generator, typename ...Args>
 struct Budget {
@@ -25,6 +25,8 @@ struct Budget {
   static constexpr bool isDecision = parameter::value_type<args, API::tag::Decision_, std::integral_constant<bool, false> >::type::value;
   static constexpr bool isDepthBounded = parameter::value_type<args, API::tag::DepthLimited_, std::integral_constant<bool, false> >::type::value;
   static constexpr bool pruneLevel = parameter::value_type<args, API::tag::PruneLevel_, std::integral_constant<bool, false> >::type::value;
+  static constexpr bool collectSolutions = parameter::value_type<args, API::tag::CollectSolutions_, std::integral_constant<bool, false> >::type::value;
+  static constexpr bool inPlace = parameter::value_type<args, API::tag::InPlace_, std::integral_constant<bool, false> >::type::value;
   static constexpr unsigned maxStackDepth = parameter::value_type<args, API::tag::MaxStackDepth, std::integral_constant<unsigned, 5000> >::type::value;
 
   typedef typename parameter::value_type<args, API::tag::Verbose_, std::integral_constant<unsigned, 0> >::type Verbose;
@@ -34,8 +36,15 @@ struct Budget {
   typedef typename boundFn::return_type Bound;
   typedef typename parameter::value_type<args, API::tag::ObjectiveComparison, std::greater<Bound> >::type Objcmp;
   typedef typename parameter::value_type<args, API::tag::Enumerator, IdentityEnumerator<Node>>::type Enum;
+  static constexpr bool isFolding = isEnumeration || foldsNodes<Node, Enum>;
+  typedef typename parameter::value_type<args, API::tag::IncumbentCallback, nullFn__>::type incumbentCb;
+  typedef typename parameter::value_type<args, API::tag::NogoodKey, nullFn__>::type nogoodKey;
+  static constexpr bool useNogoods = !isEnumeration && !collectSolutions && !std::is_same<nogoodKey, nullFn__>::value;
+  typedef typename parameter::value_type<args, API::tag::TranspositionKey, nullFn__>::type transpositionKey;
+  static constexpr bool useTransposition = !std::is_same<transpositionKey, nullFn__>::value;
 
   typedef typename parameter::value_type<args, API::tag::DepthBoundedPoolPolicy, Workstealing::Policies::DepthPoolPolicy>::type Policy;
+  using Process = ProcessNode<Space, Node, Args...>;
 
   static void printSkeletonDetails() {
     hpx::cout << "Skeleton Type: Budget\n";
@@ -44,6 +53,7 @@ struct Budget {
     hpx::cout << "Decision: " << std::boolalpha << isDecision << "\n";
     hpx::cout << "DepthBounded: " << std::boolalpha << isDepthBounded << "\n";
     hpx::cout << "MaxStackDepth: " << maxStackDepth << "\n";
+    hpx::cout << "InPlace: " << std::boolalpha << inPlace << "\n";
     if constexpr(!std::is_same<boundFn, nullFn__>::value) {
         hpx::cout << "Using Bounding: true\n";
         hpx::cout << "PruneLevel Optimisation: " << std::boolalpha << pruneLevel << "\n";
@@ -58,61 +68,131 @@ struct Budget {
     hpx::cout << hpx::flush;
   }
 
+  // Adaptive budgets: each worker keeps its own budget, adapted whenever a task
+  // it runs uses up the budget, from its scheduler counters since it last did
+  // so:
+  //  - if any worker on this locality failed to find work, the task spawns and
+  //    the budget is halved so work is shared sooner
+  //  - otherwise if this worker's tasks have been short, the task keeps going
+  //    and the budget doubles, as spawning more would only add overhead
+  //  - otherwise (long tasks, nobody starving) the task spawns at the same
+  //    budget so other localities still have work to steal
+  // Returns true if the task should spawn.
+  static constexpr unsigned adaptiveMinFactor = 16;
+  static constexpr unsigned adaptiveMaxFactor = 64;
+  static constexpr std::uint64_t adaptiveTaskNs = 1000000;
+
+  static bool adaptBudget(const API::Params<Bound> & params, unsigned & budget) {
+    auto & wb = Registry<Space, Node, Bound, Enum>::gReg->workerBudget();
+    auto & counters = Workstealing::SchedulerPerf::local();
+
+    const auto minBudget = std::max(params.backtrackBudget / adaptiveMinFactor, 1u);
+    const auto maxBudget = params.backtrackBudget * adaptiveMaxFactor;
+
+    auto failedGets = Workstealing::SchedulerPerf::localFailedGets();
+    auto busy = counters.busy.load(std::memory_order_relaxed);
+    auto tasks = counters.tasks.load(std::memory_order_relaxed);
+
+    // The running task isn't counted until it finishes, so with no tasks
+    // finished since the last check it counts as long
+    auto shortTasks = tasks > wb.tasks && (busy - wb.busy) / (tasks - wb.tasks) < adaptiveTaskNs;
+
+    auto spawn = true;
+    if (failedGets > wb.failedGets) {
+      budget = std::max(budget / 2, minBudget);
+    } else if (shortTasks && budget < maxBudget) {
+      budget = std::min(budget * 2, maxBudget);
+      spawn = false;
+    }
+
+    wb = {budget, failedGets, busy, tasks};
+    return spawn;
+  }
+
+  // How many tasks to spawn once the budget runs out: every remaining child, or
+  // with demand driven spawning one per idle worker on this locality (at least
+  // one so other localities can still steal). Remaining children stay on the
+  // stack and are searched in the usual order.
+  static unsigned spawnQuota(const API::Params<Bound> & params) {
+    if (!params.demandSpawning) {
+      return std::numeric_limits<unsigned>::max();
+    }
+    return std::max(Workstealing::Scheduler::idleSchedulers(), 1u);
+  }
+
+  // With InPlace the tree is walked by applying/undoing moves on a single node
+  // and nodes are only copied when they are spawned as new tasks
   static void expand(const Space & space,
                      const Node & n,
                      const API::Params<Bound> & params,
                      Enum & acc,
-                     std::vector<hpx::future<void> > & childFutures,
                      const unsigned childDepth) {
     auto reg = Registry<Space, Node, Bound, Enum>::gReg;
 
     auto depth = childDepth;
-    auto backtracks = 0;
+    unsigned backtracks = 0;
+    unsigned budget = params.adaptiveBudget ? reg->workerBudget().budget : params.backtrackBudget;
 
     // Init the stack
-    StackElem<Generator> initElem(space, n);
-    GeneratorStack<Generator> genStack(maxStackDepth, initElem);
+    SearchStack<Generator, inPlace> genStack(space, n, maxStackDepth);
+
+    // Spawned children haven't been processed, so may have been visited already
+    if constexpr(useTransposition) {
+      if (!Transposition::Store<transpositionKey>::visit(n)) {
+        return;
+      }
+    }
 
     // Count the initial element
-    if (isEnumeration) {
+    if constexpr(isFolding) {
       acc.accumulate(n);
     }
 
     auto stackDepth = 0;
     while (stackDepth >= 0) {
 
-      if constexpr(isDecision) {
-        if (reg->stopSearch) {
-          return;
-        }
+      if (reg->stopSearch) {
+        Process::leftOpen(space, genStack, stackDepth);
+        return;
       }
 
       // We spawn when we have exhausted our backtrack budget
-      if (backtracks == params.backtrackBudget) {
-        // Spawn everything at the highest possible depth
-        for (auto i = 0; i < stackDepth; ++i) {
-          if (genStack[i].seen < genStack[i].gen.numChildren) {
-            while (genStack[i].seen < genStack[i].gen.numChildren) {
-              genStack[i].seen++;
-              childFutures.push_back(createTask(childDepth + i + 1, genStack[i].gen.next()));
-            }
+      if (backtracks >= budget) {
+        backtracks = 0;
+        if (params.adaptiveBudget && !adaptBudget(params, budget)) {
+          continue;
+        }
+
+        // Spawn at the highest possible depth
+        auto quota = spawnQuota(params);
+        for (auto i = 0; i < stackDepth && quota > 0; ++i) {
+          // Subtrees from here down are estimated too small to give away
+          if (Estimator::keepLocal(childDepth + i + 1, params)) {
+            break;
+          }
+          if (genStack.hasNext(i)) {
+            auto toSpawn = std::min(genStack.remaining(i), quota);
+            genStack.take(i, toSpawn, stackDepth, [&](const Node & c) {
+                createTask(childDepth + i + 1, c);
+              });
+            quota -= toSpawn;
           }
         }
-        backtracks = 0;
       }
 
       // If there's still children at this stackDepth we move into them
-      if (genStack[stackDepth].seen < genStack[stackDepth].gen.numChildren) {
-        genStack[stackDepth + 1].node = genStack[stackDepth].gen.next();
-        const auto & child = genStack[stackDepth + 1].node;
+      if (genStack.hasNext(stackDepth)) {
+        const auto & child = genStack.next(stackDepth);
 
-        genStack[stackDepth].seen++;
-
-        auto pn = ProcessNode<Space, Node, Args...>::processNode(params, space, child, acc);
+        auto pn = Process::processNode(params, space, child, acc);
         if (pn == ProcessNodeRet::Exit) { return; }
-        else if (pn == ProcessNodeRet::Prune) { continue; }
+        else if (pn == ProcessNodeRet::Prune) {
+          genStack.skip(stackDepth);
+          continue;
+        }
         else if (pn == ProcessNodeRet::Break) {
-          stackDepth--;
+          genStack.skip(stackDepth);
+          genStack.up(stackDepth, &Process::subtreeFinished);
           depth--;
           backtracks++;
           continue;
@@ -130,70 +210,91 @@ struct Budget {
             stackDepth--;
             depth--;
             backtracks++;
+            genStack.skip(stackDepth);
             continue;
           }
         }
 
-        genStack[stackDepth].seen = 0;
-        genStack[stackDepth].gen = childGen;
+        genStack.enter(stackDepth, childGen);
       } else {
-        stackDepth--;
+        genStack.up(stackDepth, &Process::subtreeFinished);
         depth--;
         backtracks++;
       }
     }
   }
 
-  static void subtreeTask(const Node taskRoot,
-                          const unsigned childDepth,
-                          const hpx::naming::id_type donePromiseId) {
+  static void subtreeTask(const Node & taskRoot,
+                          const unsigned childDepth) {
     auto reg = Registry<Space, Node, Bound, Enum>::gReg;
+    Trace::Task trace(childDepth);
+
+    // Refines the estimates spawning decisions use (until there are enough)
+    if (reg->params.minTaskNodes > 0) {
+      Estimator::subtreeSize<Generator>(reg->space, taskRoot, childDepth, reg->params);
+    }
 
     Enum acc;
 
-    std::vector<hpx::future<void> > childFutures;
-    expand(reg->space, taskRoot, reg->params, acc, childFutures, childDepth);
+    expand(reg->space, taskRoot, reg->params, acc, childDepth);
 
     // Atomically updates the (process) local counter
-    if constexpr (isEnumeration) {
+    if constexpr(isFolding) {
       reg->updateEnumerator(acc);
     }
 
-    hpx::apply(hpx::util::bind([=](std::vector<hpx::future<void> > & futs) {
-          hpx::wait_all(futs);
-          hpx::async<hpx::lcos::base_lco_with_value<void>::set_value_action>(donePromiseId, true);
-        }, std::move(childFutures)));
+    Termination::taskCompleted();
   }
 
-  static hpx::future<void> createTask(const unsigned childDepth,
-                                      const Node & taskRoot) {
-    hpx::lcos::promise<void> prom;
-    auto pfut = prom.get_future();
-    auto pid  = prom.get_id();
+  // Arguments of subtreeTask, recycled between spawns (see YewPar::util::PooledTask)
+  struct TaskRecord {
+    Node node;
+    unsigned depth;
 
-    detail::BudgetSubtreeTask<Generator, Args...> t;
-    hpx::util::function<void(hpx::naming::id_type)> task;
-    task = hpx::util::bind(t, hpx::util::placeholders::_1, taskRoot, childDepth, pid);
+    void run() {
+      subtreeTask(node, depth);
+    }
+
+    template <class Archive>
+    void serialize(Archive & ar, const unsigned int version) {
+      ar & node;
+      ar & depth;
+    }
+  };
+
+  static void createTask(const unsigned childDepth,
+                         const Node & taskRoot) {
+    Termination::taskCreated();
+
+    hpx::util::function<void(hpx::naming::id_type)> task =
+        YewPar::util::PooledTask<TaskRecord>::make([&](TaskRecord & rec) {
+            rec.node = taskRoot;
+            rec.depth = childDepth;
+          });
 
     auto workPool = std::static_pointer_cast<Policy>(Workstealing::Scheduler::local_policy);
     if constexpr (std::is_same<Policy, Workstealing::Policies::Workpool>::value) {
-      workPool->addwork(task);
+      workPool->addwork(std::move(task));
     } else {
-      workPool->addwork(task, childDepth - 1);
+      workPool->addwork(std::move(task), childDepth - 1);
     }
-
-    return pfut;
   }
 
   static auto search (const Space & space,
                       const Node & root,
                       const API::Params<Bound> params = API::Params<Bound>()) {
+    static_assert(!inPlace || isInPlaceGenerator<Generator>::value, "InPlace requires a generator providing nextMove, apply and undo");
+
     if constexpr (verbose) {
       printSkeletonDetails();
     }
 
     hpx::wait_all(hpx::lcos::broadcast<InitRegistryAct<Space, Node, Bound, Enum> >(
         hpx::find_all_localities(), space, root, params));
+    hpx::wait_all(hpx::lcos::broadcast<Termination::reset_act>(hpx::find_all_localities()));
+    hpx::wait_all(hpx::lcos::broadcast<Anytime::reset_act>(hpx::find_all_localities()));
+    startWorkerStats<Verbose>();
+    startTrace(params);
 
     Policy::initPolicy();
 
@@ -206,45 +307,69 @@ struct Budget {
       hpx::wait_all(hpx::lcos::broadcast<UpdateGlobalIncumbentAct<Space, Node, Bound, Enum> >(
           hpx::find_all_localities(), inc));
       initIncumbent<Space, Node, Bound, Enum, Objcmp, Verbose>(root, params.initialBound);
+      if constexpr(collectSolutions) {
+        initSolutions<Space, Node, Bound, Enum, Objcmp, Verbose>(params.numSolutions, params.initialBound);
+      }
+      if constexpr(!std::is_same<incumbentCb, nullFn__>::value) {
+        setIncumbentCallback<Space, Node, Bound, Enum, Objcmp, Verbose>(&incumbentCb::invoke);
+      }
+    }
+
+    estimateTreeSize<Generator, Bound, Verbose>(space, root, params);
+    if constexpr(useNogoods) {
+      startNogoods<nogoodKey, Bound>(params);
+    }
+    if constexpr(useTransposition) {
+      startTransposition<transpositionKey, Bound>(params);
+    }
+    watchBudget<Space, Node, Bound, Enum>(params);
+
+    createTask(1, root);
+    Termination::waitForTermination();
+
+    Anytime::stopWatch();
+    Estimator::stopReport();
+    if constexpr(isOptimisation) {
+      recordBoundGap<Space, Node, Bound, Enum, Objcmp, boundFn>(
+          Registry<Space, Node, Bound, Enum>::gReg->localBound.load(), Anytime::exhausted());
+    }
+
+    if constexpr(useNogoods) {
+      reportNogoods<nogoodKey, Verbose>();
+    }
+    if constexpr(useTransposition) {
+      reportTransposition<transpositionKey, Verbose>();
     }
 
-    createTask(1, root).get();
+    if constexpr (verbose >= 2) {
+      if (params.adaptiveBudget) {
+        auto reg = Registry<Space, Node, Bound, Enum>::gReg;
+        hpx::cout << "Final Backtrack Budget: " << reg->backtrackBudget << hpx::endl;
+      }
+    }
 
     hpx::wait_all(hpx::lcos::broadcast<Workstealing::Scheduler::stopSchedulers_act>(
         hpx::find_all_localities()));
 
+    reportWorkerStats<Verbose>();
+    writeTrace(params);
+
     // Return the right thing
     if constexpr(isEnumeration) {
       return combineEnumerators<Space, Node, Bound, Enum>();
+    } else if constexpr(isOptimisation && collectSolutions) {
+      return withFold<Space, Node, Bound, Enum>(getSolutions<Space, Node, Bound, Enum, Objcmp, Verbose>());
     } else if constexpr(isOptimisation || isDecision) {
       auto reg = Registry<Space, Node, Bound, Enum>::gReg;
 
       typedef typename Incumbent::GetIncumbentAct<Node, Bound, Objcmp, Verbose> getInc;
-      return hpx::async<getInc>(reg->globalIncumbent).get();
+      return withFold<Space, Node, Bound, Enum>(hpx::async<getInc>(reg->globalIncumbent).get());
     } else {
       static_assert(isEnumeration || isOptimisation || isDecision, "Please provide a supported search type: Enumeration, Optimisation, Decision");
     }
   }
 };
 
-namespace detail {
-template <typename Generator, typename ...Args>
-struct BudgetSubtreeTask : hpx::actions::make_action<
-  decltype(&Budget<Generator, Args...>::subtreeTask),
-  &Budget<Generator, Args...>::subtreeTask,
-  BudgetSubtreeTask<Generator, Args...>>::type {};
-
-}
-
-}}
-
-namespace hpx { namespace traits {
-
-template <typename Generator, typename ...Args>
-struct action_stacksize<YewPar::Skeletons::detail::BudgetSubtreeTask<Generator, Args...> >  {
-  enum { value = threads::thread_stacksize_huge };
-};
-
 }}
 
 #endif
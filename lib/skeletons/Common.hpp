@@ -4,6 +4,15 @@
 #include "util/Registry.hpp"
 #include "util/Incumbent.hpp"
 #include "util/Enumerator.hpp"
+#include "util/SolutionSet.hpp"
+#include "util/Anytime.hpp"
+#include "util/Estimator.hpp"
+#include "util/Nogoods.hpp"
+#include "util/TranspositionTable.hpp"
+#include "util/Trace.hpp"
+#include "util/NodeGenerator.hpp"
+#include "util/TerminationDetection.hpp"
+#include "workstealing/SchedulerPerf.hpp"
 
 namespace YewPar { namespace Skeletons {
 
@@ -18,10 +27,22 @@ static void initIncumbent(const Node & node, const Bound & bnd) {
   hpx::async<initVals>(reg->globalIncumbent, node, bnd).get();
 }
 
+// The incumbent component always lives on the master locality, so the callback
+// can be set directly rather than through an action
+template<typename Space, typename Node, typename Bound, typename Enum, typename Cmp, typename Verbose>
+static void setIncumbentCallback(std::function<void(const Node &)> cb) {
+  auto reg = Registry<Space, Node, Bound, Enum>::gReg;
+
+  auto inc = hpx::get_ptr<Incumbent>(reg->globalIncumbent).get();
+  inc->template setCallback<Node, Bound, Cmp, Verbose>(std::move(cb));
+}
+
 template<typename Space, typename Node, typename Bound, typename Enumerator, typename Cmp, typename Verbose>
 static void updateIncumbent(const Node & node, const Bound & bnd) {
   auto reg = Registry<Space, Node, Bound, Enumerator>::gReg;
 
+  Trace::incumbent(bnd);
+
   (*reg).template updateRegistryBound<Cmp>(bnd);
   hpx::lcos::broadcast<UpdateRegistryBoundAct<Space, Node, Bound, Enumerator, Cmp> >(
       hpx::find_all_localities(), bnd);
@@ -30,33 +51,341 @@ static void updateIncumbent(const Node & node, const Bound & bnd) {
   hpx::async<act>(reg->globalIncumbent, node).get();
 }
 
+template<typename Space, typename Node, typename Bound, typename Enum, typename Cmp, typename Verbose>
+static void initSolutions(const unsigned k, const Bound & bnd) {
+  auto reg = Registry<Space, Node, Bound, Enum>::gReg;
+
+  typedef typename Incumbent::InitialiseSolutionsAct<Node, Bound, Cmp, Verbose> act;
+  hpx::async<act>(reg->globalIncumbent, k, bnd).get();
+}
+
+// As updateIncumbent, but the bound registries prune against is decided by the
+// solution set rather than by the new solution
+template<typename Space, typename Node, typename Bound, typename Enumerator, typename Cmp, typename Verbose>
+static void addSolution(const Node & node) {
+  auto reg = Registry<Space, Node, Bound, Enumerator>::gReg;
+
+  typedef typename Incumbent::AddSolutionAct<Node, Bound, Cmp, Verbose> act;
+  auto res = hpx::async<act>(reg->globalIncumbent, node).get();
+
+  if (hpx::util::get<0>(res)) {
+    auto bnd = hpx::util::get<1>(res);
+    Trace::incumbent(bnd);
+    (*reg).template updateRegistryBound<Cmp>(bnd);
+    hpx::lcos::broadcast<UpdateRegistryBoundAct<Space, Node, Bound, Enumerator, Cmp> >(
+        hpx::find_all_localities(), bnd);
+  }
+}
+
+template<typename Space, typename Node, typename Bound, typename Enum, typename Cmp, typename Verbose>
+static std::vector<Node> getSolutions() {
+  auto reg = Registry<Space, Node, Bound, Enum>::gReg;
+
+  typedef typename Incumbent::GetSolutionsAct<Node, Bound, Cmp, Verbose> act;
+  return hpx::async<act>(reg->globalIncumbent).get();
+}
+
+// Stop the search on every locality once the anytime budget (if any) is spent
+template<typename Space, typename Node, typename Bound, typename Enum>
+static void watchBudget(const API::Params<Bound> & params) {
+  Anytime::startWatch(params.timeout, params.nodeLimit, []() {
+    hpx::wait_all(hpx::lcos::broadcast<SetBudgetStopAct<Space, Node, Bound, Enum> >(
+        hpx::find_all_localities()));
+  });
+}
+
+// Nogood stores are per search, so are emptied on every locality first
+template<typename KeyFn, typename Bound>
+static void startNogoods(const API::Params<Bound> & params) {
+  Nogoods::Store<KeyFn>::start(params.nogoodCapacity, params.nogoodExchange);
+}
+
+template<typename KeyFn, typename Verbose>
+static void reportNogoods() {
+  if constexpr(Verbose::value >= 2) {
+    hpx::cout << (boost::format("Nogood prunes: %1%\n") % Nogoods::Store<KeyFn>::totalHits()) << hpx::flush;
+  }
+}
+
+// Per worker time accounting is always on, the table only covers this search.
+// Nodes are only counted for the table (or if configured, see SchedulerPerf)
+template<typename Verbose>
+static void startWorkerStats() {
+  hpx::wait_all(hpx::lcos::broadcast<Workstealing::SchedulerPerf::setNodeCounts_act>(
+      hpx::find_all_localities(), Verbose::value >= 2));
+  if constexpr(Verbose::value >= 2) {
+    Workstealing::SchedulerPerf::startSummary();
+  }
+}
+
+template<typename Verbose>
+static void reportWorkerStats() {
+  if constexpr(Verbose::value >= 2) {
+    Workstealing::SchedulerPerf::printSummary();
+  }
+}
+
+// Tracing is opt-in at runtime and covers a single search
+template<typename Bound>
+static void startTrace(const API::Params<Bound> & params) {
+  if (!params.traceFile.empty()) {
+    hpx::wait_all(hpx::lcos::broadcast<Trace::start_act>(hpx::find_all_localities(), params.traceEvents));
+  }
+}
+
+template<typename Bound>
+static void writeTrace(const API::Params<Bound> & params) {
+  if (!params.traceFile.empty()) {
+    Trace::write(params.traceFile);
+  }
+}
+
+template<typename HashFn, typename Bound>
+static void startTransposition(const API::Params<Bound> & params) {
+  Transposition::Store<HashFn>::start(params.transpositionCapacity, params.transpositionDistributed);
+}
+
+template<typename HashFn, typename Verbose>
+static void reportTransposition() {
+  if constexpr(Verbose::value >= 2) {
+    auto stats = Transposition::Store<HashFn>::totalStats();
+    hpx::cout << (boost::format("Transpositions skipped: %1%, replaced: %2%\n") % stats.first % stats.second) << hpx::flush;
+  }
+}
+
+// Estimate the size of the whole tree so progress can be reported (every
+// second when verbose), and start each locality's per depth estimates afresh
+template<typename Generator, typename Bound, typename Verbose>
+static void estimateTreeSize(const typename Generator::Spacetype & space,
+                             const typename Generator::Nodetype & root,
+                             const API::Params<Bound> & params) {
+  Estimator::setTreeEstimate(0.0);
+  if (params.estimatorProbes == 0) {
+    return;
+  }
+
+  hpx::wait_all(hpx::lcos::broadcast<Estimator::reset_act>(hpx::find_all_localities()));
+
+  auto est = Estimator::estimate<Generator>(space, root, params.maxDepth, params.estimatorProbes);
+  Estimator::setTreeEstimate(est.total());
+  if constexpr(Verbose::value >= 1) {
+    hpx::cout << (boost::format("Estimated tree size: %1% nodes\n") % est.total()) << hpx::flush;
+    Estimator::startReport(1000);
+  }
+}
+
+// Final result of the search's enumerator, moved out of each locality
 template<typename Space, typename Node, typename Bound, typename Enum>
 static typename Enum::ResT combineEnumerators() {
-  auto vals = hpx::lcos::broadcast<GetEnumeratorValAct<Space, Node, Bound, Enum> >(
+  auto vals = hpx::lcos::broadcast<TakeEnumeratorValAct<Space, Node, Bound, Enum> >(
     hpx::find_all_localities()).get();
 
   Enum res;
-  for (const auto v : vals) {
-    res.combine(v);
+  for (auto & v : vals) {
+    res.combine(std::move(v));
+  }
+  return takeResult(res);
+}
+
+// Result of an Optimisation or Decision search, paired with the nodes folded
+// over (all localities combined) when it was given an Enumerator
+template<typename Space, typename Node, typename Bound, typename Enum, typename Result>
+static auto withFold(Result && result) {
+  if constexpr(foldsNodes<Node, Enum>) {
+    return Folded<std::decay_t<Result>, typename Enum::ResT>{
+      std::forward<Result>(result), combineEnumerators<Space, Node, Bound, Enum>()};
+  } else {
+    return std::decay_t<Result>(std::forward<Result>(result));
   }
-  return res.get();
 }
 
 template <typename Generator>
 struct StackElem {
   unsigned seen;
+  // Set once part of this level's subtree has been handed to another task
+  bool given;
   typename Generator::Nodetype node;
   Generator gen;
 
-  StackElem(Generator gen) : seen(0), gen(gen) {};
+  StackElem(Generator gen) : seen(0), given(false), gen(gen) {};
   StackElem(const typename Generator::Spacetype & s,
             const typename Generator::Nodetype & n)
-      : seen(0), node(n), gen(Generator(s, node)) {};
+      : seen(0), given(false), node(n), gen(Generator(s, node)) {};
 };
 
 template <typename Generator>
 using GeneratorStack = std::vector<StackElem<Generator>>;
 
+// In-place stacks share a single node, so only the move taken from each level
+// is stored
+template <typename Generator>
+struct InPlaceStackElem {
+  unsigned seen;
+  bool given;
+  typename Generator::Movetype move;
+  Generator gen;
+
+  InPlaceStackElem(Generator gen) : seen(0), given(false), gen(gen) {};
+};
+
+template <typename Generator>
+using InPlaceGeneratorStack = std::vector<InPlaceStackElem<Generator>>;
+
+// Materialise a copy of the node at stack level "level" from the shared node
+// currently at level "stackDepth"
+template <typename Generator>
+typename Generator::Nodetype nodeAtLevel(const typename Generator::Spacetype & space,
+                                         const typename Generator::Nodetype & current,
+                                         const InPlaceGeneratorStack<Generator> & genStack,
+                                         const int stackDepth,
+                                         const int level) {
+  auto n = current;
+  for (auto i = stackDepth - 1; i >= level; --i) {
+    Generator::undo(space, n, genStack[i].move);
+  }
+  return n;
+}
+
+// The explicit stack of a depth first search, a generator per level and how
+// many of its children have been taken. By default each level also holds a copy
+// of its node. InPlace stacks instead share a single node: taking a child
+// applies its move and the move is undone once the child is left.
+//
+// Levels count from 0, the root, which must outlive the stack. next(level)
+// makes the child current until either skip(level) (not entering it) or
+// enter(level + 1, ...) followed, once its subtree is done, by up(level + 1).
+// up calls finished on the node it leaves if none of that node's subtree was
+// handed out by take, i.e. the whole subtree was searched here.
+template <typename Generator, bool inPlace = false>
+class SearchStack;
+
+template <typename Generator>
+class SearchStack<Generator, false> {
+ private:
+  using Node  = typename Generator::Nodetype;
+  using Space = typename Generator::Spacetype;
+
+  GeneratorStack<Generator> stack;
+
+ public:
+  SearchStack(const Space & space, const Node & root, const unsigned maxDepth)
+      : stack(maxDepth, StackElem<Generator>(Generator(space, root))) {
+    stack[0].node = root;
+  }
+
+  bool hasNext(const int level) const {
+    return stack[level].seen < stack[level].gen.numChildren;
+  }
+
+  unsigned remaining(const int level) const {
+    return stack[level].gen.numChildren - stack[level].seen;
+  }
+
+  const Node & next(const int level) {
+    stack[level + 1].node = stack[level].gen.next();
+    stack[level].seen++;
+    return stack[level + 1].node;
+  }
+
+  void skip(const int level) {}
+
+  void enter(const int level, const Generator & gen) {
+    stack[level].seen = 0;
+    stack[level].given = false;
+    stack[level].gen = gen;
+  }
+
+  template <typename F>
+  void up(int & level, F && finished) {
+    if (!stack[level].given) {
+      finished(stack[level].node);
+    }
+    level--;
+  }
+
+  // Hands f (a copy of) each of the next n children of level, e.g. to spawn
+  // them, while the search is at level "at"
+  template <typename F>
+  void take(const int level, const unsigned n, const int at, F && f) {
+    for (auto i = 0; i <= level; ++i) {
+      stack[i].given = true;
+    }
+    ChildBuffer<Generator> children(stack[level].gen, n);
+    for (auto i = 0u; i < n; ++i) {
+      stack[level].seen++;
+      f(children.next());
+    }
+  }
+};
+
+template <typename Generator>
+class SearchStack<Generator, true> {
+ private:
+  using Node  = typename Generator::Nodetype;
+  using Space = typename Generator::Spacetype;
+
+  const Space & space;
+  // The node at the deepest level taken
+  Node current;
+  InPlaceGeneratorStack<Generator> stack;
+
+ public:
+  SearchStack(const Space & space, const Node & root, const unsigned maxDepth)
+      : space(space), current(root),
+        stack(maxDepth, InPlaceStackElem<Generator>(Generator(space, root))) {}
+
+  bool hasNext(const int level) const {
+    return stack[level].seen < stack[level].gen.numChildren;
+  }
+
+  unsigned remaining(const int level) const {
+    return stack[level].gen.numChildren - stack[level].seen;
+  }
+
+  const Node & next(const int level) {
+    stack[level].move = stack[level].gen.nextMove();
+    Generator::apply(space, current, stack[level].move);
+    stack[level].seen++;
+    return current;
+  }
+
+  void skip(const int level) {
+    Generator::undo(space, current, stack[level].move);
+  }
+
+  void enter(const int level, const Generator & gen) {
+    stack[level].seen = 0;
+    stack[level].given = false;
+    stack[level].gen = gen;
+  }
+
+  template <typename F>
+  void up(int & level, F && finished) {
+    if (!stack[level].given) {
+      finished(static_cast<const Node &>(current));
+    }
+    level--;
+    if (level >= 0) {
+      skip(level);
+    }
+  }
+
+  // Only children handed out are copied: the node at level is rebuilt from the
+  // shared node and each child is a move applied to it
+  template <typename F>
+  void take(const int level, const unsigned n, const int at, F && f) {
+    for (auto i = 0; i <= level; ++i) {
+      stack[i].given = true;
+    }
+    auto parent = nodeAtLevel<Generator>(space, current, stack, at, level);
+    for (auto i = 0u; i < n; ++i) {
+      stack[level].seen++;
+      ScopedMove<Generator> move(space, parent, stack[level].gen.nextMove());
+      f(static_cast<const Node &>(parent));
+    }
+  }
+};
+
 // General node processing
 enum ProcessNodeRet { Exit, Prune, Break, Continue };
 
@@ -68,6 +397,7 @@ struct ProcessNode {
   static constexpr bool isDecision = parameter::value_type<args, API::tag::Decision_, std::integral_constant<bool, false> >::type::value;
   static constexpr bool isEnumeration = parameter::value_type<args, API::tag::Enumeration_, std::integral_constant<bool, false> >::type::value;
   static constexpr bool pruneLevel = parameter::value_type<args, API::tag::PruneLevel_, std::integral_constant<bool, false> >::type::value;
+  static constexpr bool collectSolutions = parameter::value_type<args, API::tag::CollectSolutions_, std::integral_constant<bool, false> >::type::value;
 
   typedef typename parameter::value_type<args, API::tag::Verbose_, std::integral_constant<unsigned, 0> >::type Verbose;
 
@@ -77,11 +407,47 @@ struct ProcessNode {
 
   typedef typename parameter::value_type<args, API::tag::Enumerator, IdentityEnumerator<Node>>::type Enumerator;
 
+  static constexpr bool isFolding = foldsNodes<Node, Enumerator>;
+
+  typedef typename parameter::value_type<args, API::tag::NogoodKey, nullFn__>::type nogoodKey;
+  static constexpr bool useNogoods = !isEnumeration && !collectSolutions && !std::is_same<nogoodKey, nullFn__>::value;
+  // Subtrees with equal keys may still hold distinct, equally good solutions
+  static_assert(!collectSolutions || std::is_same<nogoodKey, nullFn__>::value,
+                "NogoodKey can't be combined with CollectSolutions");
+
+  typedef typename parameter::value_type<args, API::tag::TranspositionKey, nullFn__>::type transpositionKey;
+  static constexpr bool useTransposition = !std::is_same<transpositionKey, nullFn__>::value;
+
+  // Whether nodes left unexplored are recorded for the bound gap
+  static constexpr bool tracksOpen = isOptimisation && std::is_arithmetic<Bound>::value && !std::is_same<boundFn, nullFn__>::value;
+
   static ProcessNodeRet processNode(const API::Params<Bound> & params,
                                     const Space & space,
                                     const Node & c,
                                     Enumerator & acc) {
 
+    // Counted for node budgets and progress estimates
+    if (params.nodeLimit > 0 || params.estimatorProbes > 0) {
+      Anytime::countNode();
+    }
+    if (Workstealing::SchedulerPerf::countingNodes()) {
+      Workstealing::SchedulerPerf::countNode();
+    }
+
+    // Equivalent to a subtree that has already been searched
+    if constexpr(useNogoods) {
+      if (Nogoods::Store<nogoodKey>::contains(nogoodKey::invoke(c))) {
+        return ProcessNodeRet::Prune;
+      }
+    }
+
+    // Already visited along another path
+    if constexpr(useTransposition) {
+      if (!Transposition::Store<transpositionKey>::visit(c)) {
+        return ProcessNodeRet::Prune;
+      }
+    }
+
     if constexpr(isEnumeration) {
         acc.accumulate(c);
         return ProcessNodeRet::Continue;
@@ -91,6 +457,9 @@ struct ProcessNode {
         if (c.getObj() == params.expectedObjective) {
           updateIncumbent<Space, Node, Bound, Enumerator, Objcmp, Verbose>(c, c.getObj());
           hpx::lcos::broadcast<SetStopFlagAct<Space, Node, Bound, Enumerator> >(hpx::find_all_localities());
+          if constexpr(isFolding) {
+            acc.accumulate(c);
+          }
           return ProcessNodeRet::Exit;
         }
       }
@@ -110,7 +479,13 @@ struct ProcessNode {
           } else {
           auto reg = Registry<Space, Node, Bound, Enumerator>::gReg;
           auto best = reg->localBound.load();
-          if (!cmp(bnd, best)) {
+          bool prune;
+          if constexpr(collectSolutions) {
+            prune = SolutionSet<Node, Bound, Objcmp>::prune(bnd, best, params.numSolutions == 0);
+          } else {
+            prune = !cmp(bnd, best);
+          }
+          if (prune) {
             if constexpr(pruneLevel) {
                 return ProcessNodeRet::Break;
             } else {
@@ -124,13 +499,176 @@ struct ProcessNode {
         auto reg = Registry<Space, Node, Bound, Enumerator>::gReg;
         auto best = reg->localBound.load();
 
-        Objcmp cmp;
-        if (cmp(c.getObj(),best)) {
-          updateIncumbent<Space, Node, Bound, Enumerator, Objcmp, Verbose>(c, c.getObj());
+        if constexpr(collectSolutions) {
+          if (SolutionSet<Node, Bound, Objcmp>::improves(c.getObj(), best, params.numSolutions == 0)) {
+            addSolution<Space, Node, Bound, Enumerator, Objcmp, Verbose>(c);
+          }
+        } else {
+          Objcmp cmp;
+          if (cmp(c.getObj(),best)) {
+            updateIncumbent<Space, Node, Bound, Enumerator, Objcmp, Verbose>(c, c.getObj());
+          }
         }
     }
+
+    if constexpr(isFolding) {
+      acc.accumulate(c);
+    }
     return ProcessNodeRet::Continue;
   }
+
+  // Called once n's whole subtree has been searched by one task: nothing
+  // (more) can come from it, so nodes with the same nogood key can be pruned
+  static void subtreeFinished(const Node & n) {
+    if constexpr(useNogoods) {
+      if (!Registry<Space, Node, Bound, Enumerator>::gReg->stopSearch) {
+        Nogoods::Store<nogoodKey>::add(nogoodKey::invoke(n));
+      }
+    }
+  }
+
+  // The search was stopped before n's subtree was searched
+  static void leftOpen(const Space & space, const Node & n) {
+    if constexpr(tracksOpen) {
+      Registry<Space, Node, Bound, Enumerator>::gReg->template recordOpen<Objcmp>(boundFn::invoke(space, n));
+    }
+  }
+
+  // As leftOpen for every child still on a SearchStack, the search being at
+  // level stackDepth
+  template <typename Stack>
+  static void leftOpen(const Space & space, Stack & stack, const int stackDepth) {
+    if constexpr(tracksOpen) {
+      for (auto i = 0; i <= stackDepth; ++i) {
+        if (stack.hasNext(i)) {
+          stack.take(i, stack.remaining(i), stackDepth, [&](const Node & c) { leftOpen(space, c); });
+        }
+      }
+    }
+  }
+};
+
+// Depth-first search with an explicit generator stack that other workers can
+// steal from, shared by the skeletons using a SearchManager Policy. Steals are
+// answered from the highest level with work left
+template <typename Generator, typename Policy, typename ...Args>
+struct StackSearch {
+  typedef typename Generator::Nodetype Node;
+  typedef typename Generator::Spacetype Space;
+
+  typedef typename API::skeleton_signature::bind<Args...>::type args;
+
+  static constexpr bool isDepthLimited = parameter::value_type<args, API::tag::DepthLimited_, std::integral_constant<bool, false> >::type::value;
+  static constexpr bool inPlace = parameter::value_type<args, API::tag::InPlace_, std::integral_constant<bool, false> >::type::value;
+
+  typedef typename parameter::value_type<args, API::tag::BoundFunction, nullFn__>::type boundFn;
+  typedef typename boundFn::return_type Bound;
+  typedef typename parameter::value_type<args, API::tag::Enumerator, IdentityEnumerator<Node>>::type Enum;
+
+  using Response    = typename Policy::Response_t;
+  using SharedState = typename Policy::SharedState_t;
+  using Stack_t     = SearchStack<Generator, inPlace>;
+  using Process     = ProcessNode<Space, Node, Args...>;
+
+  // Gives the thief the next child (or with stealAll every remaining child)
+  // of the highest level with work left, or nothing if there is none
+  static void respondToSteal(const int startingDepth,
+                             const int stackDepth,
+                             Stack_t & generatorStack,
+                             SharedState & stealRequest) {
+    auto reg = Registry<Space, Node, Bound, Enum>::gReg;
+
+    Response res;
+    for (auto i = 0; i < stackDepth; ++i) {
+      // Subtrees from here down are estimated too small to give away
+      if (Estimator::keepLocal(startingDepth + i + 1, reg->params)) {
+        break;
+      }
+
+      if (generatorStack.hasNext(i)) {
+        auto n = reg->params.stealAll ? generatorStack.remaining(i) : 1;
+        generatorStack.take(i, n, stackDepth, [&](const Node & c) {
+            res.emplace_back(hpx::util::make_tuple(c, startingDepth + i + 1));
+          });
+        Termination::taskCreated(res.size());
+        break;
+      }
+    }
+
+    std::get<1>(stealRequest).set(res);
+    std::get<0>(stealRequest).store(false);
+  }
+
+  // Search below level stackDepth of generatorStack (the task's root by
+  // default), whose nodes are at depth
+  static void run(const int startingDepth,
+                  const Space & space,
+                  Stack_t & generatorStack,
+                  std::shared_ptr<SharedState> stealRequest,
+                  Enum & acc,
+                  int stackDepth = 0,
+                  int depth = -1) {
+    auto reg = Registry<Space, Node, Bound, Enum>::gReg;
+
+    // We do this because arguments can't default initialise to themselves
+    if (depth == -1) {
+      depth = startingDepth;
+    }
+
+    while (stackDepth >= 0) {
+
+      if (reg->stopSearch) {
+        Process::leftOpen(space, generatorStack, stackDepth);
+        return;
+      }
+
+      // Handle steals first
+      if (std::get<0>(*stealRequest)) {
+        respondToSteal(startingDepth, stackDepth, generatorStack, *stealRequest);
+      }
+
+      // If there's still children at this stackDepth we move into them
+      if (generatorStack.hasNext(stackDepth)) {
+
+        // Get the next child at this stackDepth
+        const auto & child = generatorStack.next(stackDepth);
+
+        auto pn = Process::processNode(reg->params, space, child, acc);
+        if (pn == ProcessNodeRet::Exit) { return; }
+        else if (pn == ProcessNodeRet::Prune) {
+          generatorStack.skip(stackDepth);
+          continue;
+        }
+        else if (pn == ProcessNodeRet::Break) {
+          generatorStack.skip(stackDepth);
+          generatorStack.up(stackDepth, &Process::subtreeFinished);
+          depth--;
+          continue;
+        }
+
+        // Get the child's generator
+        const auto childGen = Generator(space, child);
+
+        // Going down
+        stackDepth++;
+        depth++;
+
+        if constexpr(isDepthLimited) {
+          if (depth == reg->params.maxDepth) {
+            stackDepth--;
+            depth--;
+            generatorStack.skip(stackDepth);
+            continue;
+          }
+        }
+
+        generatorStack.enter(stackDepth, childGen);
+      } else {
+        generatorStack.up(stackDepth, &Process::subtreeFinished);
+        depth--;
+      }
+    }
+  }
 };
 
 }}
@@ -1,9 +1,13 @@
 #ifndef SKELETONS_DEPTHSPAWN_HPP
 #define SKELETONS_DEPTHSPAWN_HPP
 
+#include <algorithm>
+#include <chrono>
 #include <iostream>
 #include <vector>
 #include <cstdint>
+#include <iterator>
+#include <unordered_map>
 
 #include <boost/format.hpp>
 
@@ -11,11 +15,16 @@
 
 #include <hpx/lcos/broadcast.hpp>
 #include <hpx/include/iostreams.hpp>
+#include <hpx/lcos/local/mutex.hpp>
 
 #include "util/NodeGenerator.hpp"
 #include "util/Registry.hpp"
 #include "util/Incumbent.hpp"
 #include "util/func.hpp"
+#include "util/TerminationDetection.hpp"
+#include "util/Checkpoint.hpp"
+#include "util/Estimator.hpp"
+#include "util/TaskPool.hpp"
 
 #include "Common.hpp"
 
@@ -28,7 +37,19 @@ namespace YewPar { namespace Skeletons {
 namespace DepthBounded_ {
 
 template <typename Generator, typename ...Args>
-struct SubtreeTask;
+struct StartPendingAct;
+
+template <typename Generator, typename ...Args>
+struct ResetCheckpointAct;
+
+template <typename Generator, typename ...Args>
+struct BeginCheckpointAct;
+
+template <typename Generator, typename ...Args>
+struct SplitForCheckpointAct;
+
+template <typename Generator, typename ...Args>
+struct CollectCheckpointAct;
 
 }
 
@@ -45,6 +66,8 @@ struct DepthBounded {
   static constexpr bool isDecision = parameter::value_type<args, API::tag::Decision_, std::integral_constant<bool, false> >::type::value;
   static constexpr bool isDepthLimited = parameter::value_type<args, API::tag::DepthLimited_, std::integral_constant<bool, false> >::type::value;
   static constexpr bool pruneLevel = parameter::value_type<args, API::tag::PruneLevel_, std::integral_constant<bool, false> >::type::value;
+  static constexpr bool collectSolutions = parameter::value_type<args, API::tag::CollectSolutions_, std::integral_constant<bool, false> >::type::value;
+  static constexpr bool inPlace = parameter::value_type<args, API::tag::InPlace_, std::integral_constant<bool, false> >::type::value;
 
   typedef typename parameter::value_type<args, API::tag::Verbose_, std::integral_constant<unsigned, 0> >::type Verbose;
   static constexpr unsigned verbose = Verbose::value;
@@ -53,9 +76,21 @@ struct DepthBounded {
   typedef typename boundFn::return_type Bound;
   typedef typename parameter::value_type<args, API::tag::ObjectiveComparison, std::greater<Bound> >::type Objcmp;
   typedef typename parameter::value_type<args, API::tag::Enumerator, IdentityEnumerator<Node>>::type Enum;
+  static constexpr bool isFolding = isEnumeration || foldsNodes<Node, Enum>;
+  typedef typename parameter::value_type<args, API::tag::IncumbentCallback, nullFn__>::type incumbentCb;
+  typedef typename parameter::value_type<args, API::tag::NogoodKey, nullFn__>::type nogoodKey;
+  static constexpr bool useNogoods = !isEnumeration && !collectSolutions && !std::is_same<nogoodKey, nullFn__>::value;
+  typedef typename parameter::value_type<args, API::tag::TranspositionKey, nullFn__>::type transpositionKey;
+  static constexpr bool useTransposition = !std::is_same<transpositionKey, nullFn__>::value;
+  // Solution collection and decision searches can't be checkpointed, nor can
+  // folds with move-only results as checkpoints copy them out of the Registry
+  static constexpr bool canCheckpoint = !isDecision && !collectSolutions && std::is_copy_constructible<typename Enum::ResT>::value;
 
   typedef typename parameter::value_type<args, API::tag::DepthBoundedPoolPolicy, Workstealing::Policies::DepthPoolPolicy>::type Policy;
 
+  typedef Checkpoint::Snapshot<Node, Bound, typename Enum::ResT> Snapshot;
+  typedef std::vector<Checkpoint::FrontierTask<Node> > Frontier;
+
   static void printSkeletonDetails(const API::Params<Bound> & params) {
     hpx::cout << "Skeleton Type: DepthBounded\n";
     hpx::cout << "d_cutoff: " << params.spawnDepth << "\n";
@@ -77,30 +112,106 @@ struct DepthBounded {
     hpx::cout << hpx::flush;
   }
 
+  // Arguments of subtreeTask, recycled between spawns (see YewPar::util::PooledTask)
+  struct TaskRecord {
+    Node node;
+    unsigned depth;
+    std::uint64_t pendingId;
+    hpx::naming::id_type creator;
+
+    void run() {
+      subtreeTask(node, depth, pendingId, creator);
+    }
+
+    template <class Archive>
+    void serialize(Archive & ar, const unsigned int version) {
+      ar & node;
+      ar & depth;
+      ar & pendingId;
+      ar & creator;
+    }
+  };
+
+  // Per task state for checkpoints
+  struct TaskState {
+    // Latest checkpoint that accounts for this task's subtree
+    unsigned epoch = 0;
+    // Set once the task splits for a checkpoint: the rest of its children are
+    // spawned as tasks at spawnEpoch and listed in frontier
+    bool split = false;
+    unsigned spawnEpoch = 0;
+    Frontier frontier;
+  };
+
+  // Safe point, between children. Splits if a checkpoint is waiting for us
+  static bool shouldSplit(TaskState & ts) {
+    if (!ts.split) {
+      auto e = Checkpoint::splitEpoch();
+      if (e > ts.epoch) {
+        ts.split = true;
+        ts.spawnEpoch = e;
+      }
+    }
+    return ts.split;
+  }
+
+  static void spawn(TaskState & ts, const unsigned childDepth, const Node & n) {
+    if (ts.split) {
+      ts.frontier.push_back({n, childDepth});
+      createTask(childDepth, n, ts.spawnEpoch);
+    } else {
+      createTask(childDepth, n, ts.epoch);
+    }
+  }
+
   static void expandWithSpawns(const Space & space,
                                const Node & n,
                                const API::Params<Bound> & params,
                                Enum & acc,
-                               std::vector<hpx::future<void> > & childFutures,
-                               const unsigned childDepth) {
+                               const unsigned childDepth,
+                               TaskState & ts) {
+    auto reg = Registry<Space, Node, Bound, Enum>::gReg;
     Generator newCands = Generator(space, n);
 
+    if (reg->stopSearch) {
+      ProcessNode<Space, Node, Args...>::leftOpen(space, n);
+      return;
+    }
+
     if constexpr(isDepthLimited) {
         if (childDepth == params.maxDepth) {
           return;
         }
     }
 
+    ChildBuffer<Generator> children(newCands);
     for (auto i = 0; i < newCands.numChildren; ++i) {
-      auto c = newCands.next();
+      if (reg->stopSearch) {
+        for (; i < newCands.numChildren; ++i) {
+          ProcessNode<Space, Node, Args...>::leftOpen(space, children.next());
+        }
+        return;
+      }
+
+      auto c = children.next();
 
       auto pn = ProcessNode<Space, Node, Args...>::processNode(params, space, c, acc);
       if (pn == ProcessNodeRet::Exit) { return; }
+      else if (pn == ProcessNodeRet::Prune) { continue; }
       else if (pn == ProcessNodeRet::Break) { break; }
       //default continue
 
+      // Small subtrees aren't worth a task of their own
+      if (!shouldSplit(ts) && params.minTaskNodes > 0 && params.estimatorProbes > 0) {
+        auto est = Estimator::subtreeSize<Generator>(space, c, childDepth + 1, params);
+        if (est < params.minTaskNodes) {
+          expandNoSpawns(space, c, params, acc, childDepth + 1, ts);
+          continue;
+        }
+      }
+
       // Spawn new tasks for all children (that are still alive after pruning)
-      childFutures.push_back(createTask(childDepth + 1, c));
+      spawn(ts, childDepth + 1, c);
     }
   }
 
@@ -108,15 +219,15 @@ struct DepthBounded {
                              const Node & n,
                              const API::Params<Bound> & params,
                              Enum & acc,
-                             const unsigned childDepth) {
+                             const unsigned childDepth,
+                             TaskState & ts) {
     auto reg = Registry<Space, Node, Bound, Enum>::gReg;
     Generator newCands = Generator(space, n);
 
-    if constexpr(isDecision) {
-        if (reg->stopSearch) {
-          return;
-        }
-      }
+    if (reg->stopSearch) {
+      ProcessNode<Space, Node, Args...>::leftOpen(space, n);
+      return;
+    }
 
     if constexpr(isDepthLimited) {
         if (childDepth == params.maxDepth) {
@@ -124,72 +235,311 @@ struct DepthBounded {
         }
     }
 
+    ChildBuffer<Generator> children(newCands);
     for (auto i = 0; i < newCands.numChildren; ++i) {
-      auto c = newCands.next();
+      auto c = children.next();
 
       auto pn = ProcessNode<Space, Node, Args...>::processNode(params, space, c, acc);
       if (pn == ProcessNodeRet::Exit) { return; }
       else if (pn == ProcessNodeRet::Prune) { continue; }
       else if (pn == ProcessNodeRet::Break) { break; }
 
-      expandNoSpawns(space, c, params, acc, childDepth + 1);
+      // Once split, what is left at every level up to the task root is spawned
+      if (shouldSplit(ts)) {
+        spawn(ts, childDepth + 1, c);
+        continue;
+      }
+
+      expandNoSpawns(space, c, params, acc, childDepth + 1, ts);
+    }
+
+    // Nothing (more) can come from n so equivalent nodes elsewhere can be
+    // pruned. Subtrees below spawned tasks aren't finished here so only
+    // expandNoSpawns records nogoods, and only before a split
+    if constexpr(useNogoods) {
+      if (!reg->stopSearch && !ts.split) {
+        Nogoods::Store<nogoodKey>::add(nogoodKey::invoke(n));
+      }
+    }
+  }
+
+  static bool checkpointing() {
+    if constexpr(canCheckpoint) {
+      return Registry<Space, Node, Bound, Enum>::gReg->params.checkpointInterval > 0;
+    } else {
+      return false;
     }
   }
 
-  static void subtreeTask(const Node taskRoot,
+  // Tasks created on this locality that haven't started, by id. Each holds
+  // the epoch it will start with, which a checkpoint moves on once it has
+  // listed the task in its frontier
+  struct Pending {
+    Node node;
+    unsigned depth;
+    unsigned epoch;
+  };
+
+  // Per locality checkpoint state
+  struct CheckpointState {
+    hpx::lcos::local::mutex mtx;
+    std::uint64_t nextId = 0;
+    std::unordered_map<std::uint64_t, Pending> pending;
+    // What this locality owes the checkpoint being taken
+    Enum reported;
+    Frontier frontier;
+  };
+  static inline CheckpointState ckState;
+
+  static void resetCheckpoint() {
+    Checkpoint::reset();
+    std::lock_guard<hpx::lcos::local::mutex> l(ckState.mtx);
+    ckState.nextId = 0;
+    ckState.pending.clear();
+    ckState.reported = Enum();
+    ckState.frontier.clear();
+  }
+
+  // Returns the epoch the task starts with
+  static unsigned startPending(const std::uint64_t id) {
+    std::lock_guard<hpx::lcos::local::mutex> l(ckState.mtx);
+    auto it = ckState.pending.find(id);
+    auto epoch = it->second.epoch;
+    ckState.pending.erase(it);
+    return epoch;
+  }
+
+  static void subtreeTask(const Node & taskRoot,
                           const unsigned childDepth,
-                          const hpx::naming::id_type donePromiseId) {
+                          const std::uint64_t pendingId,
+                          const hpx::naming::id_type creator) {
     auto reg = Registry<Space, Node, Bound, Enum>::gReg;
+    Trace::Task trace(childDepth);
+
+    TaskState ts;
+    if (pendingId != 0) {
+      if (creator == hpx::find_here()) {
+        ts.epoch = startPending(pendingId);
+      } else {
+        ts.epoch = hpx::async<DepthBounded_::StartPendingAct<Generator, Args...> >(creator, pendingId).get();
+      }
+    }
 
     Enum acc;
-    std::vector<hpx::future<void> > childFutures;
 
     if (childDepth <= reg->params.spawnDepth) {
-      expandWithSpawns(reg->space, taskRoot, reg->params, acc, childFutures, childDepth);
+      expandWithSpawns(reg->space, taskRoot, reg->params, acc, childDepth, ts);
     } else {
-      expandNoSpawns(reg->space, taskRoot, reg->params, acc, childDepth);
+      expandNoSpawns(reg->space, taskRoot, reg->params, acc, childDepth, ts);
+    }
+
+    if constexpr(canCheckpoint) {
+      if (pendingId != 0) {
+        finishCheckpointed(ts, acc);
+        Termination::taskCompleted();
+        return;
+      }
     }
 
     // Atomically updates the (process) local enumerator
-    if constexpr (isEnumeration) {
+    if constexpr(isFolding) {
       reg->updateEnumerator(acc);
     }
 
-    hpx::apply(hpx::util::bind([=](std::vector<hpx::future<void> > & futs) {
-          hpx::wait_all(futs);
-          hpx::async<hpx::lcos::base_lco_with_value<void>::set_value_action>(donePromiseId, true);
-        }, std::move(childFutures)));
+    Termination::taskCompleted();
   }
 
-  static hpx::future<void> createTask(const unsigned childDepth,
-                                      const Node & taskRoot) {
-    hpx::lcos::promise<void> prom;
-    auto pfut = prom.get_future();
-    auto pid  = prom.get_id();
+  // As updateEnumerator, but a task still owed to the checkpoint being taken
+  // also hands it its results (and split frontier). Under the Registry's lock
+  // so each task's results are either in the checkpoint's view of the Registry
+  // or reported, never both
+  static void finishCheckpointed(TaskState & ts, Enum & acc) {
+    auto reg = Registry<Space, Node, Bound, Enum>::gReg;
+    {
+      std::lock_guard<typename Registry<Space, Node, Bound, Enum>::MutexT> rl(reg->mtx);
+      if (ts.epoch < Checkpoint::begun()) {
+        std::lock_guard<hpx::lcos::local::mutex> l(ckState.mtx);
+        if constexpr(isFolding) {
+          ckState.reported.combine(acc.get());
+        }
+        ckState.frontier.insert(ckState.frontier.end(),
+                                std::make_move_iterator(ts.frontier.begin()),
+                                std::make_move_iterator(ts.frontier.end()));
+      }
+      if constexpr(isFolding) {
+        reg->acc.combine(takeResult(acc));
+      }
+    }
+    Checkpoint::taskClosed(ts.epoch);
+  }
 
-    DepthBounded_::SubtreeTask<Generator, Args...> t;
-    hpx::util::function<void(hpx::naming::id_type)> task;
-    task = hpx::util::bind(t, hpx::util::placeholders::_1, taskRoot, childDepth, pid);
+  static void createTask(const unsigned childDepth,
+                         const Node & taskRoot,
+                         const unsigned epoch) {
+    Termination::taskCreated();
+
+    std::uint64_t id = 0;
+    if (checkpointing()) {
+      Checkpoint::taskOpened(epoch);
+      std::lock_guard<hpx::lcos::local::mutex> l(ckState.mtx);
+      id = ++ckState.nextId;
+      ckState.pending.emplace(id, Pending{taskRoot, childDepth, epoch});
+    }
+
+    hpx::util::function<void(hpx::naming::id_type)> task =
+        YewPar::util::PooledTask<TaskRecord>::make([&](TaskRecord & rec) {
+            rec.node = taskRoot;
+            rec.depth = childDepth;
+            rec.pendingId = id;
+            rec.creator = hpx::find_here();
+          });
 
     auto workPool = std::static_pointer_cast<Policy>(Workstealing::Scheduler::local_policy);
     if constexpr (std::is_same<Policy, Workstealing::Policies::Workpool>::value) {
-      workPool->addwork(task);
+      workPool->addwork(std::move(task));
     } else {
-      workPool->addwork(task, childDepth - 1);
+      workPool->addwork(std::move(task), childDepth - 1);
+    }
+  }
+
+  // First phase of checkpoint "epoch": remember the results so far and have
+  // uncovered tasks report from now on
+  static void beginCheckpoint(const unsigned epoch) {
+    auto reg = Registry<Space, Node, Bound, Enum>::gReg;
+    std::lock_guard<typename Registry<Space, Node, Bound, Enum>::MutexT> rl(reg->mtx);
+    std::lock_guard<hpx::lcos::local::mutex> l(ckState.mtx);
+    ckState.reported = Enum();
+    if constexpr(isFolding) {
+      ckState.reported.combine(reg->acc.get());
+    }
+    ckState.frontier.clear();
+    Checkpoint::begin(epoch);
+  }
+
+  // Second phase: running tasks split at their next child and tasks that
+  // haven't started join the frontier, without waiting for either
+  static void splitForCheckpoint(const unsigned epoch) {
+    Checkpoint::startSplitting(epoch);
+
+    std::lock_guard<hpx::lcos::local::mutex> l(ckState.mtx);
+    std::uint64_t moved = 0;
+    for (auto & p : ckState.pending) {
+      if (p.second.epoch < epoch) {
+        ckState.frontier.push_back({p.second.node, p.second.depth});
+        p.second.epoch = epoch;
+        ++moved;
+      }
     }
+    Checkpoint::taskOpened(epoch, moved);
+    Checkpoint::taskClosed(epoch - 1, moved);
+  }
 
-     return pfut;
+  // Last phase, once no uncovered task is left: this locality's part of the
+  // snapshot
+  static Snapshot collectCheckpoint() {
+    std::lock_guard<hpx::lcos::local::mutex> l(ckState.mtx);
+    Snapshot part;
+    part.frontier = std::move(ckState.frontier);
+    ckState.frontier.clear();
+    if constexpr(isFolding) {
+      part.enumerated = takeResult(ckState.reported);
+    }
+    return part;
+  }
+
+  // Take a snapshot of the running search and write it to file. Workers keep
+  // searching throughout: a running task only stops at its next child to spawn
+  // the rest of its subtree as new tasks
+  static void takeCheckpoint(const std::string & file) {
+    auto reg = Registry<Space, Node, Bound, Enum>::gReg;
+    auto localities = hpx::find_all_localities();
+    auto epoch = Checkpoint::begun() + 1;
+
+    hpx::wait_all(hpx::lcos::broadcast<DepthBounded_::BeginCheckpointAct<Generator, Args...> >(localities, epoch));
+    hpx::wait_all(hpx::lcos::broadcast<DepthBounded_::SplitForCheckpointAct<Generator, Args...> >(localities, epoch));
+
+    std::uint64_t interval = 100;
+    while (!reg->stopSearch && Checkpoint::countUncovered(epoch) > 0) {
+      hpx::this_thread::suspend(std::chrono::microseconds(interval));
+      interval = std::min<std::uint64_t>(interval * 2, 10000);
+    }
+
+    auto parts = hpx::lcos::broadcast<DepthBounded_::CollectCheckpointAct<Generator, Args...> >(localities).get();
+    if (reg->stopSearch) {
+      return;
+    }
+
+    Snapshot snapshot;
+    snapshot.root = reg->root;
+    Enum acc;
+    for (auto & p : parts) {
+      snapshot.frontier.insert(snapshot.frontier.end(),
+                               std::make_move_iterator(p.frontier.begin()),
+                               std::make_move_iterator(p.frontier.end()));
+      if constexpr(isFolding) {
+        acc.combine(std::move(p.enumerated));
+      }
+    }
+    if constexpr(isFolding) {
+      snapshot.enumerated = takeResult(acc);
+    }
+
+    if constexpr(isOptimisation) {
+      typedef typename Incumbent::GetIncumbentAct<Node, Bound, Objcmp, Verbose> getInc;
+      snapshot.incumbent = hpx::async<getInc>(reg->globalIncumbent).get();
+      Objcmp cmp;
+      auto bnd = reg->localBound.load();
+      snapshot.bound = cmp(snapshot.incumbent.getObj(), bnd) ? snapshot.incumbent.getObj() : bnd;
+    }
+
+    // A failed checkpoint shouldn't lose the search
+    try {
+      Checkpoint::write(file, snapshot);
+      if constexpr(verbose >= 1) {
+        hpx::cout << (boost::format("Checkpoint: %1% tasks written to %2%\n")
+                      % snapshot.frontier.size() % file) << hpx::flush;
+      }
+    } catch (const std::exception & e) {
+      hpx::cout << (boost::format("Checkpoint failed: %1%\n") % e.what()) << hpx::flush;
+    }
   }
 
   static auto search (const Space & space,
                       const Node & root,
                       const API::Params<Bound> params = API::Params<Bound>()) {
+    return run(space, root, params, nullptr);
+  }
+
+  // Continue a search from a snapshot written by takeCheckpoint. Any number of
+  // localities may be used
+  static auto resume (const Space & space,
+                      const std::string & checkpointFile,
+                      API::Params<Bound> params = API::Params<Bound>()) {
+    static_assert(canCheckpoint, "This search can't be checkpointed, so can't be resumed");
+    auto snapshot = Checkpoint::read<Snapshot>(checkpointFile);
+    if constexpr(isOptimisation) {
+      params.initialBound = snapshot.bound;
+    }
+    return run(space, snapshot.root, params, &snapshot);
+  }
+
+  static auto run (const Space & space,
+                   const Node & root,
+                   const API::Params<Bound> & params,
+                   const Snapshot * snapshot) {
+    static_assert(!inPlace, "InPlace is not supported by the DepthBounded skeleton");
+
     if constexpr (verbose) {
         printSkeletonDetails(params);
     }
 
     hpx::wait_all(hpx::lcos::broadcast<InitRegistryAct<Space, Node, Bound, Enum> >(
         hpx::find_all_localities(), space, root, params));
+    hpx::wait_all(hpx::lcos::broadcast<Termination::reset_act>(hpx::find_all_localities()));
+    hpx::wait_all(hpx::lcos::broadcast<Anytime::reset_act>(hpx::find_all_localities()));
+    hpx::wait_all(hpx::lcos::broadcast<DepthBounded_::ResetCheckpointAct<Generator, Args...> >(hpx::find_all_localities()));
+    startWorkerStats<Verbose>();
+    startTrace(params);
 
     Policy::initPolicy();
 
@@ -201,29 +551,81 @@ struct DepthBounded {
       auto inc = hpx::new_<Incumbent>(hpx::find_here()).get();
       hpx::wait_all(hpx::lcos::broadcast<UpdateGlobalIncumbentAct<Space, Node, Bound, Enum> >(
           hpx::find_all_localities(), inc));
-      initIncumbent<Space, Node, Bound, Enum, Objcmp, Verbose>(root, params.initialBound);
+      initIncumbent<Space, Node, Bound, Enum, Objcmp, Verbose>(snapshot ? snapshot->incumbent : root, params.initialBound);
+      if constexpr(collectSolutions) {
+        initSolutions<Space, Node, Bound, Enum, Objcmp, Verbose>(params.numSolutions, params.initialBound);
+      }
+      if constexpr(!std::is_same<incumbentCb, nullFn__>::value) {
+        setIncumbentCallback<Space, Node, Bound, Enum, Objcmp, Verbose>(&incumbentCb::invoke);
+      }
     }
 
-    // Ensure the root node is accumulated if required
-    if constexpr(isEnumeration) {
+    // Ensure the root node (or everything before the checkpoint) is accumulated if required
+    if constexpr(isFolding) {
         Enum acc;
-        acc.accumulate(root);
+        if (!snapshot) {
+          acc.accumulate(root);
+        } else if constexpr(canCheckpoint) {
+          acc.combine(snapshot->enumerated);
+        }
         Registry<Space, Node, Bound, Enum>::gReg->updateEnumerator(acc);
     }
 
-    createTask(1, root).get();
+    estimateTreeSize<Generator, Bound, Verbose>(space, root, params);
+    if constexpr(useNogoods) {
+      startNogoods<nogoodKey, Bound>(params);
+    }
+    if constexpr(useTransposition) {
+      startTransposition<transpositionKey, Bound>(params);
+    }
+    watchBudget<Space, Node, Bound, Enum>(params);
+
+    if constexpr(canCheckpoint) {
+      Checkpoint::startPeriodic(params.checkpointInterval, [file = params.checkpointFile]() {
+        takeCheckpoint(file);
+      });
+    }
+
+    if (snapshot) {
+      for (const auto & t : snapshot->frontier) {
+        createTask(t.depth, t.node, 0);
+      }
+    } else {
+      createTask(1, root, 0);
+    }
+    Termination::waitForTermination();
+
+    Checkpoint::stopPeriodic();
+    Anytime::stopWatch();
+    Estimator::stopReport();
+    if constexpr(isOptimisation) {
+      recordBoundGap<Space, Node, Bound, Enum, Objcmp, boundFn>(
+          Registry<Space, Node, Bound, Enum>::gReg->localBound.load(), Anytime::exhausted());
+    }
+
+    if constexpr(useNogoods) {
+      reportNogoods<nogoodKey, Verbose>();
+    }
+    if constexpr(useTransposition) {
+      reportTransposition<transpositionKey, Verbose>();
+    }
 
     hpx::wait_all(hpx::lcos::broadcast<Workstealing::Scheduler::stopSchedulers_act>(
         hpx::find_all_localities()));
 
+    reportWorkerStats<Verbose>();
+    writeTrace(params);
+
     // Return the right thing
     if constexpr(isEnumeration) {
       return combineEnumerators<Space, Node, Bound, Enum>();
+    } else if constexpr(isOptimisation && collectSolutions) {
+      return withFold<Space, Node, Bound, Enum>(getSolutions<Space, Node, Bound, Enum, Objcmp, Verbose>());
     } else if constexpr(isOptimisation || isDecision) {
       auto reg = Registry<Space, Node, Bound, Enum>::gReg;
 
       typedef typename Incumbent::GetIncumbentAct<Node, Bound, Objcmp, Verbose> getInc;
-      return hpx::async<getInc>(reg->globalIncumbent).get();
+      return withFold<Space, Node, Bound, Enum>(hpx::async<getInc>(reg->globalIncumbent).get());
     } else {
       static_assert(isEnumeration || isOptimisation || isDecision, "Please provide a supported search type: Enumeration, Optimisation, Decision");
     }
@@ -233,21 +635,36 @@ struct DepthBounded {
 namespace DepthBounded_{
 
 template <typename Generator, typename ...Args>
-struct SubtreeTask : hpx::actions::make_action<
-  decltype(&DepthBounded<Generator, Args...>::subtreeTask),
-  &DepthBounded<Generator, Args...>::subtreeTask,
-  SubtreeTask<Generator, Args...>>::type {};
+struct StartPendingAct : hpx::actions::make_action<
+  decltype(&DepthBounded<Generator, Args...>::startPending),
+  &DepthBounded<Generator, Args...>::startPending,
+  StartPendingAct<Generator, Args...>>::type {};
 
-}
+template <typename Generator, typename ...Args>
+struct ResetCheckpointAct : hpx::actions::make_action<
+  decltype(&DepthBounded<Generator, Args...>::resetCheckpoint),
+  &DepthBounded<Generator, Args...>::resetCheckpoint,
+  ResetCheckpointAct<Generator, Args...>>::type {};
 
-}}
+template <typename Generator, typename ...Args>
+struct BeginCheckpointAct : hpx::actions::make_action<
+  decltype(&DepthBounded<Generator, Args...>::beginCheckpoint),
+  &DepthBounded<Generator, Args...>::beginCheckpoint,
+  BeginCheckpointAct<Generator, Args...>>::type {};
 
-namespace hpx { namespace traits {
+template <typename Generator, typename ...Args>
+struct SplitForCheckpointAct : hpx::actions::make_action<
+  decltype(&DepthBounded<Generator, Args...>::splitForCheckpoint),
+  &DepthBounded<Generator, Args...>::splitForCheckpoint,
+  SplitForCheckpointAct<Generator, Args...>>::type {};
 
 template <typename Generator, typename ...Args>
-struct action_stacksize<YewPar::Skeletons::DepthBounded_::SubtreeTask<Generator, Args...> > {
-  enum { value = threads::thread_stacksize_huge };
-};
+struct CollectCheckpointAct : hpx::actions::make_action<
+  decltype(&DepthBounded<Generator, Args...>::collectCheckpoint),
+  &DepthBounded<Generator, Args...>::collectCheckpoint,
+  CollectCheckpointAct<Generator, Args...>>::type {};
+
+}
 
 }}
 
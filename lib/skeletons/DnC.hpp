@@ -0,0 +1,207 @@
+#ifndef SKELETONS_DNC_HPP
+#define SKELETONS_DNC_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include <hpx/lcos/broadcast.hpp>
+#include <hpx/lcos/local/promise.hpp>
+#include <hpx/runtime/actions/plain_action.hpp>
+#include <hpx/runtime/find_here.hpp>
+
+#include "util/func.hpp"
+
+#include "workstealing/Scheduler.hpp"
+#include "workstealing/policies/DepthPoolPolicy.hpp"
+
+namespace YewPar { namespace Skeletons { namespace DnC {
+
+// Binary divide and conquer. Problems are described by (func wrapped)
+// functions:
+//
+//   Trivial : Problem -> bool                    (small enough to solve directly?)
+//   Solve   : Problem -> Result                  (solve a trivial problem)
+//   Divide  : Problem -> std::pair<Problem, Problem>
+//   Conquer : (Result, Result) -> Result
+//
+// Seq runs sequentially. Par and Dist run on the work stealing schedulers of
+// this locality or every locality respectively. Unexpanded subproblems are
+// spawned into a DepthPoolPolicy so thieves take the largest (shallowest)
+// problems while workers carry on depth first. Nothing waits on children:
+// each divided problem has a frame counting outstanding children and whichever
+// child finishes last conquers and passes the result up. For Dist, Problem and
+// Result must be serializable.
+
+template <typename Problem, typename Divide, typename Conquer, typename Trivial, typename Solve>
+struct Seq {
+  using Result = typename Solve::return_type;
+
+  static Result search(const Problem & p) {
+    if (Trivial::invoke(p)) {
+      return Solve::invoke(p);
+    }
+    auto children = Divide::invoke(p);
+    return Conquer::invoke(search(children.first), search(children.second));
+  }
+};
+
+namespace detail {
+template <typename Problem, typename Divide, typename Conquer, typename Trivial, typename Solve, bool distributed>
+struct DnCTask;
+
+template <typename Problem, typename Divide, typename Conquer, typename Trivial, typename Solve, bool distributed>
+struct DnCDeliverAct;
+}
+
+template <typename Problem, typename Divide, typename Conquer, typename Trivial, typename Solve, bool distributed>
+struct Parallel {
+  using Result = typename Solve::return_type;
+  using Policy = Workstealing::Policies::DepthPoolPolicy;
+
+  // Where a result should go: a slot of a frame on the owning locality. A null
+  // frame is the root of the search
+  struct Frame {
+    std::atomic<unsigned> pending {2};
+    Result results[2];
+
+    hpx::naming::id_type owner;
+    std::uintptr_t parent;
+    unsigned slot;
+  };
+
+  // Set on the master locality for the duration of a search
+  static inline hpx::lcos::local::promise<Result> * rootResult = nullptr;
+
+  // Store a child's result. The last child of a frame conquers and continues up
+  // the tree until it reaches a frame on another locality (or one still waiting
+  // on a child)
+  static void deliverLocal(std::uintptr_t frame, unsigned slot, Result res) {
+    while (frame != 0) {
+      auto f = reinterpret_cast<Frame *>(frame);
+      f->results[slot] = std::move(res);
+      if (--f->pending > 0) {
+        return;
+      }
+
+      res = Conquer::invoke(std::move(f->results[0]), std::move(f->results[1]));
+      auto owner = f->owner;
+      frame = f->parent;
+      slot = f->slot;
+      delete f;
+
+      if (owner != hpx::find_here()) {
+        hpx::apply<detail::DnCDeliverAct<Problem, Divide, Conquer, Trivial, Solve, distributed> >(owner, frame, slot, std::move(res));
+        return;
+      }
+    }
+
+    rootResult->set_value(std::move(res));
+  }
+
+  static void deliver(const hpx::naming::id_type & owner, std::uintptr_t frame, unsigned slot, Result res) {
+    if (owner == hpx::find_here()) {
+      deliverLocal(frame, slot, std::move(res));
+    } else {
+      hpx::apply<detail::DnCDeliverAct<Problem, Divide, Conquer, Trivial, Solve, distributed> >(owner, frame, slot, std::move(res));
+    }
+  }
+
+  static void createTask(const Problem & p,
+                         const unsigned depth,
+                         const hpx::naming::id_type & owner,
+                         const std::uintptr_t parent,
+                         const unsigned slot) {
+    detail::DnCTask<Problem, Divide, Conquer, Trivial, Solve, distributed> t;
+    hpx::util::function<void(hpx::naming::id_type)> task;
+    task = hpx::util::bind(t, hpx::util::placeholders::_1, p, depth, owner, parent, slot);
+
+    auto workPool = std::static_pointer_cast<Policy>(Workstealing::Scheduler::local_policy);
+    workPool->addwork(std::move(task), depth);
+  }
+
+  // Spawn the second half of each division (so it can be stolen) and carry on
+  // with the first until a trivial problem is reached
+  static void task(Problem p,
+                   unsigned depth,
+                   hpx::naming::id_type owner,
+                   std::uintptr_t parent,
+                   unsigned slot) {
+    while (!Trivial::invoke(p)) {
+      auto children = Divide::invoke(p);
+
+      auto f = new Frame;
+      f->owner = owner;
+      f->parent = parent;
+      f->slot = slot;
+
+      owner = hpx::find_here();
+      parent = reinterpret_cast<std::uintptr_t>(f);
+      ++depth;
+
+      createTask(children.second, depth, owner, parent, 1);
+
+      p = std::move(children.first);
+      slot = 0;
+    }
+
+    deliver(owner, parent, slot, Solve::invoke(p));
+  }
+
+  static Result search(const Problem & root) {
+    auto localities = distributed ? hpx::find_all_localities()
+                                  : std::vector<hpx::naming::id_type> { hpx::find_here() };
+
+    Policy::initPolicy();
+
+    auto threadCount = hpx::get_os_thread_count() == 1 ? 1 : hpx::get_os_thread_count() - 1;
+    hpx::wait_all(hpx::lcos::broadcast<Workstealing::Scheduler::startSchedulers_act>(localities, threadCount));
+
+    hpx::lcos::local::promise<Result> done;
+    auto res = done.get_future();
+    rootResult = &done;
+
+    createTask(root, 0, hpx::find_here(), 0, 0);
+    auto result = res.get();
+    rootResult = nullptr;
+
+    hpx::wait_all(hpx::lcos::broadcast<Workstealing::Scheduler::stopSchedulers_act>(localities));
+
+    return result;
+  }
+};
+
+template <typename Problem, typename Divide, typename Conquer, typename Trivial, typename Solve>
+using Par = Parallel<Problem, Divide, Conquer, Trivial, Solve, false>;
+
+template <typename Problem, typename Divide, typename Conquer, typename Trivial, typename Solve>
+using Dist = Parallel<Problem, Divide, Conquer, Trivial, Solve, true>;
+
+namespace detail {
+
+template <typename Problem, typename Divide, typename Conquer, typename Trivial, typename Solve, bool distributed>
+struct DnCTask : hpx::actions::make_action<
+  decltype(&Parallel<Problem, Divide, Conquer, Trivial, Solve, distributed>::task),
+  &Parallel<Problem, Divide, Conquer, Trivial, Solve, distributed>::task,
+  DnCTask<Problem, Divide, Conquer, Trivial, Solve, distributed> >::type {};
+
+template <typename Problem, typename Divide, typename Conquer, typename Trivial, typename Solve, bool distributed>
+struct DnCDeliverAct : hpx::actions::make_action<
+  decltype(&Parallel<Problem, Divide, Conquer, Trivial, Solve, distributed>::deliverLocal),
+  &Parallel<Problem, Divide, Conquer, Trivial, Solve, distributed>::deliverLocal,
+  DnCDeliverAct<Problem, Divide, Conquer, Trivial, Solve, distributed> >::type {};
+
+}
+
+}}}
+
+namespace hpx { namespace traits {
+
+template <typename Problem, typename Divide, typename Conquer, typename Trivial, typename Solve, bool distributed>
+struct action_stacksize<YewPar::Skeletons::DnC::detail::DnCTask<Problem, Divide, Conquer, Trivial, Solve, distributed> > {
+  enum { value = threads::thread_stacksize_huge };
+};
+
+}}
+
+#endif
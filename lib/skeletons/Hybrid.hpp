@@ -0,0 +1,269 @@
+#ifndef SKELETONS_HYBRID_HPP
+#define SKELETONS_HYBRID_HPP
+
+#include <iostream>
+#include <vector>
+#include <cstdint>
+
+#include "API.hpp"
+
+#include <hpx/lcos/broadcast.hpp>
+#include <hpx/include/iostreams.hpp>
+
+#include <boost/format.hpp>
+
+#include "util/NodeGenerator.hpp"
+#include "util/Registry.hpp"
+#include "util/Incumbent.hpp"
+#include "util/func.hpp"
+#include "util/util.hpp"
+#include "util/TerminationDetection.hpp"
+
+#include "Common.hpp"
+
+#include "workstealing/Scheduler.hpp"
+#include "workstealing/policies/SearchManager.hpp"
+
+namespace YewPar { namespace Skeletons {
+
+// Depth-bounded spawning above spawnDepth, stack stealing below it. Tasks down
+// to spawnDepth are seeded eagerly (ordered by depth, as in the DepthPool) to
+// give fast ramp-up, then each task below the cutoff runs as a stealable
+// generator stack under the SearchManager so long tails are still balanced.
+template <typename Generator, typename ...Args>
+struct Hybrid {
+  typedef typename Generator::Nodetype Node;
+  typedef typename Generator::Spacetype Space;
+
+  typedef typename API::skeleton_signature::bind<Args...>::type args;
+
+  static constexpr bool isEnumeration = parameter::value_type<args, API::tag::Enumeration_, std::integral_constant<bool, false> >::type::value;
+  static constexpr bool isOptimisation = parameter::value_type<args, API::tag::Optimisation_, std::integral_constant<bool, false> >::type::value;
+  static constexpr bool isDecision = parameter::value_type<args, API::tag::Decision_, std::integral_constant<bool, false> >::type::value;
+  static constexpr bool isDepthLimited = parameter::value_type<args, API::tag::DepthLimited_, std::integral_constant<bool, false> >::type::value;
+  static constexpr bool pruneLevel = parameter::value_type<args, API::tag::PruneLevel_, std::integral_constant<bool, false> >::type::value;
+  static constexpr bool collectSolutions = parameter::value_type<args, API::tag::CollectSolutions_, std::integral_constant<bool, false> >::type::value;
+  static constexpr bool inPlace = parameter::value_type<args, API::tag::InPlace_, std::integral_constant<bool, false> >::type::value;
+  static constexpr unsigned maxStackDepth = parameter::value_type<args, API::tag::MaxStackDepth, std::integral_constant<unsigned, 5000> >::type::value;
+
+  typedef typename parameter::value_type<args, API::tag::Verbose_, std::integral_constant<unsigned, 0> >::type Verbose;
+  static constexpr unsigned verbose = Verbose::value;
+
+  typedef typename parameter::value_type<args, API::tag::BoundFunction, nullFn__>::type boundFn;
+  typedef typename boundFn::return_type Bound;
+  typedef typename parameter::value_type<args, API::tag::ObjectiveComparison, std::greater<Bound> >::type Objcmp;
+  typedef typename parameter::value_type<args, API::tag::Enumerator, IdentityEnumerator<Node>>::type Enum;
+  static constexpr bool isFolding = isEnumeration || foldsNodes<Node, Enum>;
+  typedef typename parameter::value_type<args, API::tag::IncumbentCallback, nullFn__>::type incumbentCb;
+  typedef typename parameter::value_type<args, API::tag::NogoodKey, nullFn__>::type nogoodKey;
+  static constexpr bool useNogoods = !isEnumeration && !collectSolutions && !std::is_same<nogoodKey, nullFn__>::value;
+  typedef typename parameter::value_type<args, API::tag::TranspositionKey, nullFn__>::type transpositionKey;
+  static constexpr bool useTransposition = !std::is_same<transpositionKey, nullFn__>::value;
+
+  static void printSkeletonDetails(const API::Params<Bound> & params) {
+    hpx::cout << "Skeleton Type: Hybrid\n";
+    hpx::cout << "d_cutoff: " << params.spawnDepth << "\n";
+    hpx::cout << "Enumeration : " << std::boolalpha << isEnumeration << "\n";
+    hpx::cout << "Optimisation: " << std::boolalpha << isOptimisation << "\n";
+    hpx::cout << "Decision: " << std::boolalpha << isDecision << "\n";
+    hpx::cout << "DepthLimited: " << std::boolalpha << isDepthLimited << "\n";
+    hpx::cout << "MaxStackDepth: " << maxStackDepth << "\n";
+    hpx::cout << "InPlace: " << std::boolalpha << inPlace << "\n";
+    if constexpr(!std::is_same<boundFn, nullFn__>::value) {
+        hpx::cout << "Using Bounding: true\n";
+        hpx::cout << "PruneLevel Optimisation: " << std::boolalpha << pruneLevel << "\n";
+    } else {
+      hpx::cout << "Using Bounding: false\n";
+    }
+    hpx::cout << "Chunking Enabled: " << std::boolalpha << params.stealAll << "\n";
+    hpx::cout << hpx::flush;
+  }
+
+  static void subTreeTask(const Node taskRoot,
+                          const unsigned childDepth);
+
+  using SubTreeTask = func<
+    decltype(&Hybrid<Generator, Args...>::subTreeTask),
+    &Hybrid<Generator, Args...>::subTreeTask>;
+
+  using Policy      = Workstealing::Policies::SearchManager::SearchManagerComp<Node, SubTreeTask, Args...>;
+  using SharedState = typename Policy::SharedState_t;
+  // Below the cutoff: search with an explicit stack that other workers can
+  // steal from
+  using Stack       = StackSearch<Generator, Policy, Args...>;
+
+  static void createTask(const unsigned childDepth,
+                         const Node & taskRoot) {
+    Termination::taskCreated();
+    std::static_pointer_cast<Policy>(Workstealing::Scheduler::local_policy)->addwork(taskRoot, childDepth);
+  }
+
+  // Above the cutoff: seed a task for every child. Children are processed
+  // (and pruned) by their own tasks
+  static void expandWithSpawns(const Space & space,
+                               const Node & n,
+                               const API::Params<Bound> & params,
+                               const unsigned childDepth) {
+    auto reg = Registry<Space, Node, Bound, Enum>::gReg;
+    Generator newCands = Generator(space, n);
+
+    if (reg->stopSearch) {
+      ProcessNode<Space, Node, Args...>::leftOpen(space, n);
+      return;
+    }
+
+    if constexpr(isDepthLimited) {
+        if (childDepth == params.maxDepth) {
+          return;
+        }
+    }
+
+    ChildBuffer<Generator> children(newCands);
+    for (auto i = 0; i < newCands.numChildren; ++i) {
+      if (reg->stopSearch) {
+        for (; i < newCands.numChildren; ++i) {
+          ProcessNode<Space, Node, Args...>::leftOpen(space, children.next());
+        }
+        return;
+      }
+
+      createTask(childDepth + 1, children.next());
+    }
+  }
+
+  static auto search (const Space & space,
+                      const Node & root,
+                      const API::Params<Bound> params = API::Params<Bound>()) {
+    static_assert(!inPlace || isInPlaceGenerator<Generator>::value, "InPlace requires a generator providing nextMove, apply and undo");
+
+    if constexpr(verbose) {
+      printSkeletonDetails(params);
+    }
+
+    hpx::wait_all(hpx::lcos::broadcast<InitRegistryAct<Space, Node, Bound, Enum> >(
+        hpx::find_all_localities(), space, root, params));
+    hpx::wait_all(hpx::lcos::broadcast<Termination::reset_act>(hpx::find_all_localities()));
+    hpx::wait_all(hpx::lcos::broadcast<Anytime::reset_act>(hpx::find_all_localities()));
+    startWorkerStats<Verbose>();
+    startTrace(params);
+
+    Policy::initPolicy();
+
+    auto threadCount = hpx::get_os_thread_count() == 1 ? 1 : hpx::get_os_thread_count() - 1;
+    hpx::wait_all(hpx::lcos::broadcast<Workstealing::Scheduler::startSchedulers_act>(
+        hpx::find_all_localities(), threadCount));
+
+    if constexpr(isOptimisation || isDecision) {
+      auto inc = hpx::new_<Incumbent>(hpx::find_here()).get();
+      hpx::wait_all(hpx::lcos::broadcast<UpdateGlobalIncumbentAct<Space, Node, Bound, Enum> >(
+          hpx::find_all_localities(), inc));
+      initIncumbent<Space, Node, Bound, Enum, Objcmp, Verbose>(root, params.initialBound);
+      if constexpr(collectSolutions) {
+        initSolutions<Space, Node, Bound, Enum, Objcmp, Verbose>(params.numSolutions, params.initialBound);
+      }
+      if constexpr(!std::is_same<incumbentCb, nullFn__>::value) {
+        setIncumbentCallback<Space, Node, Bound, Enum, Objcmp, Verbose>(&incumbentCb::invoke);
+      }
+    }
+
+    // Ensure the root node is accumulated if required
+    if constexpr(isFolding) {
+        Enum acc;
+        acc.accumulate(root);
+        Registry<Space, Node, Bound, Enum>::gReg->updateEnumerator(acc);
+    }
+
+    estimateTreeSize<Generator, Bound, Verbose>(space, root, params);
+    if constexpr(useNogoods) {
+      startNogoods<nogoodKey, Bound>(params);
+    }
+    if constexpr(useTransposition) {
+      startTransposition<transpositionKey, Bound>(params);
+    }
+    watchBudget<Space, Node, Bound, Enum>(params);
+
+    createTask(1, root);
+    Termination::waitForTermination();
+
+    Anytime::stopWatch();
+    Estimator::stopReport();
+    if constexpr(isOptimisation) {
+      recordBoundGap<Space, Node, Bound, Enum, Objcmp, boundFn>(
+          Registry<Space, Node, Bound, Enum>::gReg->localBound.load(), Anytime::exhausted());
+    }
+
+    if constexpr(useNogoods) {
+      reportNogoods<nogoodKey, Verbose>();
+    }
+    if constexpr(useTransposition) {
+      reportTransposition<transpositionKey, Verbose>();
+    }
+
+    hpx::wait_all(hpx::lcos::broadcast<Workstealing::Scheduler::stopSchedulers_act>(
+        hpx::find_all_localities()));
+
+    reportWorkerStats<Verbose>();
+    writeTrace(params);
+
+    hpx::cout << hpx::flush;
+
+    // Return the right thing
+    if constexpr(isEnumeration) {
+      return combineEnumerators<Space, Node, Bound, Enum>();
+    } else if constexpr(isOptimisation && collectSolutions) {
+      return withFold<Space, Node, Bound, Enum>(getSolutions<Space, Node, Bound, Enum, Objcmp, Verbose>());
+    } else if constexpr(isOptimisation || isDecision) {
+      auto reg = Registry<Space, Node, Bound, Enum>::gReg;
+
+      typedef typename Incumbent::GetIncumbentAct<Node, Bound, Objcmp, Verbose> getInc;
+      return withFold<Space, Node, Bound, Enum>(hpx::async<getInc>(reg->globalIncumbent).get());
+    } else {
+      static_assert(isEnumeration || isOptimisation || isDecision, "Please provide a supported search type: Enumeration, Optimisation, Decision");
+    }
+  }
+};
+
+template <typename Generator, typename ...Args>
+void Hybrid<Generator, Args...>::subTreeTask(const Node taskRoot,
+                                             const unsigned childDepth) {
+  auto reg = Registry<Space, Node, Bound, Enum>::gReg;
+  Trace::Task trace(childDepth);
+  Enum acc;
+
+  // Seeded and stolen task roots alike are unprocessed, so each task processes
+  // its own root. The search root is accounted for in search
+  auto pn = ProcessNodeRet::Continue;
+  if (childDepth > 1) {
+    pn = ProcessNode<Space, Node, Args...>::processNode(reg->params, reg->space, taskRoot, acc);
+  }
+
+  if (pn != ProcessNodeRet::Continue) {
+    // Pruned (or the search is over)
+  } else if (childDepth <= reg->params.spawnDepth) {
+    expandWithSpawns(reg->space, taskRoot, reg->params, childDepth);
+  } else {
+    // Below the spawn depth the stack walk is in place when InPlace is set
+    typename Stack::Stack_t generatorStack(reg->space, taskRoot, maxStackDepth);
+
+    // Register with the Policy to allow stealing from this stack
+    auto policy = std::static_pointer_cast<Policy>(Workstealing::Scheduler::local_policy);
+    std::shared_ptr<SharedState> stealReq;
+    unsigned threadId;
+    std::tie(stealReq, threadId) = policy->registerThread();
+
+    Stack::run(childDepth, reg->space, generatorStack, stealReq, acc);
+
+    policy->unregisterThread(threadId);
+  }
+
+  // Atomically updates the (process) local enumerator
+  if constexpr(isFolding) {
+    reg->updateEnumerator(acc);
+  }
+
+  Termination::taskCompleted();
+}
+
+}}
+
+#endif
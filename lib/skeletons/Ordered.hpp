@@ -42,6 +42,8 @@ struct Ordered {
   static constexpr bool isDecision = parameter::value_type<args, API::tag::Decision_, std::integral_constant<bool, false> >::type::value;
   static constexpr bool isDepthBounded = parameter::value_type<args, API::tag::DepthLimited_, std::integral_constant<bool, false> >::type::value;
   static constexpr bool pruneLevel = parameter::value_type<args, API::tag::PruneLevel_, std::integral_constant<bool, false> >::type::value;
+  static constexpr bool collectSolutions = parameter::value_type<args, API::tag::CollectSolutions_, std::integral_constant<bool, false> >::type::value;
+  static constexpr bool inPlace = parameter::value_type<args, API::tag::InPlace_, std::integral_constant<bool, false> >::type::value;
   static constexpr bool discrepancySearch = parameter::value_type<args, API::tag::DiscrepancySearch_, std::integral_constant<bool, false> >::type::value;
 
   typedef typename parameter::value_type<args, API::tag::Verbose_, std::integral_constant<unsigned, 0> >::type Verbose;
@@ -51,6 +53,11 @@ struct Ordered {
   typedef typename boundFn::return_type Bound;
   typedef typename parameter::value_type<args, API::tag::ObjectiveComparison, std::greater<Bound> >::type Objcmp;
   typedef typename parameter::value_type<args, API::tag::Enumerator, IdentityEnumerator<Node>>::type Enum;
+  typedef typename parameter::value_type<args, API::tag::IncumbentCallback, nullFn__>::type incumbentCb;
+  typedef typename parameter::value_type<args, API::tag::NogoodKey, nullFn__>::type nogoodKey;
+  static constexpr bool useNogoods = !isEnumeration && !collectSolutions && !std::is_same<nogoodKey, nullFn__>::value;
+  typedef typename parameter::value_type<args, API::tag::TranspositionKey, nullFn__>::type transpositionKey;
+  static constexpr bool useTransposition = !std::is_same<transpositionKey, nullFn__>::value;
 
   static void printSkeletonDetails() {
     hpx::cout << "Skeleton Type: Ordered\n";
@@ -135,11 +142,10 @@ struct Ordered {
     auto reg = Registry<Space, Node, Bound, Enum>::gReg;
     Generator newCands = Generator(space, n);
 
-    if constexpr(isDecision) {
-        if (reg->stopSearch) {
-          return;
-        }
-      }
+    if (reg->stopSearch) {
+      ProcessNode<Space, Node, Args...>::leftOpen(space, n);
+      return;
+    }
 
     if constexpr(isDepthBounded) {
         if (childDepth == params.maxDepth) {
@@ -147,8 +153,9 @@ struct Ordered {
         }
     }
 
+    ChildBuffer<Generator> children(newCands);
     for (auto i = 0; i < newCands.numChildren; ++i) {
-      auto c = newCands.next();
+      auto c = children.next();
 
       auto pn = ProcessNode<Space, Node, Args...>::processNode(params, space, c, acc);
       if (pn == ProcessNodeRet::Exit) { return; }
@@ -157,24 +164,46 @@ struct Ordered {
 
       expandNoSpawns(space, c, params, acc, childDepth + 1);
     }
+
+    // Nothing (more) can come from n, equivalent nodes elsewhere can be pruned
+    ProcessNode<Space, Node, Args...>::subtreeFinished(n);
   }
 
   static auto search (const Space & space,
                       const Node & root,
                       const API::Params<Bound> params = API::Params<Bound>()) {
+    static_assert(!inPlace, "InPlace is not supported by the Ordered skeleton");
+
     if constexpr(verbose) {
       printSkeletonDetails();
     }
 
     hpx::wait_all(hpx::lcos::broadcast<InitRegistryAct<Space, Node, Bound, Enum> >(
         hpx::find_all_localities(), space, root, params));
+    hpx::wait_all(hpx::lcos::broadcast<Anytime::reset_act>(hpx::find_all_localities()));
+    startWorkerStats<Verbose>();
+    startTrace(params);
 
     if constexpr(isOptimisation || isDecision) {
       auto inc = hpx::new_<Incumbent>(hpx::find_here()).get();
       hpx::wait_all(hpx::lcos::broadcast<UpdateGlobalIncumbentAct<Space, Node, Bound, Enum> >(
           hpx::find_all_localities(), inc));
       initIncumbent<Space, Node, Bound, Enum, Objcmp, Verbose>(root, params.initialBound);
+      if constexpr(collectSolutions) {
+        initSolutions<Space, Node, Bound, Enum, Objcmp, Verbose>(params.numSolutions, params.initialBound);
+      }
+      if constexpr(!std::is_same<incumbentCb, nullFn__>::value) {
+        setIncumbentCallback<Space, Node, Bound, Enum, Objcmp, Verbose>(&incumbentCb::invoke);
+      }
+    }
+
+    if constexpr(useNogoods) {
+      startNogoods<nogoodKey, Bound>(params);
     }
+    if constexpr(useTransposition) {
+      startTransposition<transpositionKey, Bound>(params);
+    }
+    watchBudget<Space, Node, Bound, Enum>(params);
 
     Workstealing::Policies::PriorityOrderedPolicy::initPolicy();
 
@@ -211,11 +240,15 @@ struct Ordered {
     // Make this thread the sequential thread of execution.
     auto reg = Registry<Space, Node, Bound, Enum>::gReg;
     for (auto & t : tasks) {
-      // Allow early termination of sequential thread
-      if constexpr(isDecision) {
-        if (reg->stopSearch) {
+      // Allow early termination of sequential thread. Tasks nobody has started
+      // are left open, workers skip them once stopped
+      if (reg->stopSearch) {
+        if constexpr(!ProcessNode<Space, Node, Args...>::tracksOpen) {
           break;
+        } else if (hpx::async<YewPar::util::DistSetOnceFlag::set_value_action>(t.startedFlag).get()) {
+          ProcessNode<Space, Node, Args...>::leftOpen(space, t.node);
         }
+        continue;
       }
 
       // Quick prune path to avoid writing global flags
@@ -223,7 +256,11 @@ struct Ordered {
         Objcmp cmp;
         auto best = reg->localBound.load();
         auto bnd  = boundFn::invoke(space, t.node);
-        if (!cmp(bnd,best)) {
+        if constexpr(collectSolutions) {
+          if (SolutionSet<Node, Bound, Objcmp>::prune(bnd, best, params.numSolutions == 0)) {
+            continue;
+          }
+        } else if (!cmp(bnd,best)) {
           continue;
         }
       }
@@ -235,12 +272,31 @@ struct Ordered {
       }
     }
 
+    Anytime::stopWatch();
+
+    if constexpr(useNogoods) {
+      reportNogoods<nogoodKey, Verbose>();
+    }
+    if constexpr(useTransposition) {
+      reportTransposition<transpositionKey, Verbose>();
+    }
+
     // We have either seen everything or terminated early to make sure everyone stops
     hpx::wait_all(hpx::lcos::broadcast<Workstealing::Scheduler::stopSchedulers_act>(
         hpx::find_all_localities()));
 
+    // Only once the workers have stopped, as they record what they leave open
+    if constexpr(isOptimisation) {
+      recordBoundGap<Space, Node, Bound, Enum, Objcmp, boundFn>(
+          Registry<Space, Node, Bound, Enum>::gReg->localBound.load(), Anytime::exhausted());
+    }
+    reportWorkerStats<Verbose>();
+    writeTrace(params);
+
     // Return the right thing
-    if constexpr(isOptimisation || isDecision) {
+    if constexpr(isOptimisation && collectSolutions) {
+      return getSolutions<Space, Node, Bound, Enum, Objcmp, Verbose>();
+    } else if constexpr(isOptimisation || isDecision) {
       auto reg = Registry<Space, Node, Bound, Enum>::gReg;
       typedef typename Incumbent::GetIncumbentAct<Node, Bound, Objcmp, Verbose> getInc;
       return hpx::async<getInc>(reg->globalIncumbent).get();
@@ -254,10 +310,10 @@ struct Ordered {
                           const hpx::naming::id_type started) {
     // Don't bother checking if the sequential thread has done this task since we are stopping anyway
     auto reg = Registry<Space, Node, Bound, Enum>::gReg;
-    if constexpr (isDecision) {
-      if (reg->stopSearch) {
-        return;
-      }
+    // Every task is rooted at the spawn depth
+    Trace::Task trace(reg->params.spawnDepth);
+    if (reg->stopSearch) {
+      return;
     }
 
     // Quick prune path
@@ -265,7 +321,11 @@ struct Ordered {
       Objcmp cmp;
       auto best = reg->localBound.load();
       auto bnd  = boundFn::invoke(reg->space, taskRoot);
-      if (!cmp(bnd,best)) {
+      if constexpr(collectSolutions) {
+        if (SolutionSet<Node, Bound, Objcmp>::prune(bnd, best, reg->params.numSolutions == 0)) {
+          return;
+        }
+      } else if (!cmp(bnd,best)) {
         return;
       }
     }
@@ -0,0 +1,306 @@
+#ifndef SKELETONS_PORTFOLIO_HPP
+#define SKELETONS_PORTFOLIO_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "API.hpp"
+
+#include <hpx/lcos/broadcast.hpp>
+#include <hpx/include/iostreams.hpp>
+#include <hpx/runtime/threads/executors/default_executor.hpp>
+
+#include <boost/format.hpp>
+
+#include "util/NodeGenerator.hpp"
+#include "util/Registry.hpp"
+#include "util/Incumbent.hpp"
+#include "util/func.hpp"
+
+#include "Common.hpp"
+
+namespace YewPar { namespace Skeletons {
+
+namespace Portfolio_ {
+
+template <typename Generator, typename ...Args>
+struct RunWorkersAct;
+
+template <typename Generator, typename ...Args>
+struct GetRestartsAct;
+
+// The Luby sequence (1, 1, 2, 1, 1, 2, 4, 1, ...), i from 1
+inline std::uint64_t luby(std::uint64_t i) {
+  while (true) {
+    unsigned k = 1;
+    while ((std::uint64_t(1) << k) - 1 < i) {
+      ++k;
+    }
+    if ((std::uint64_t(1) << k) - 1 == i) {
+      return std::uint64_t(1) << (k - 1);
+    }
+    i -= (std::uint64_t(1) << (k - 1)) - 1;
+  }
+}
+
+}
+
+// Restarting portfolio search for Decision and Optimisation problems with
+// heavy tailed runtimes. Every worker on every locality repeatedly searches the
+// whole tree from the root, each with its own random child order (one worker
+// keeps the generator's order), and gives up after a node limit following the
+// Luby sequence scaled by params.restartBase.
+//
+// Workers share incumbents and bounds through the Registry as usual, and
+// nogoods if a NogoodKey is given: each run records the subtrees it finishes,
+// so restarts don't search them again. The search ends when a run finishes the
+// whole tree (so the result is optimal, or there is no solution), or when a
+// Decision search finds a solution.
+template <typename Generator, typename ...Args>
+struct Portfolio {
+  typedef typename Generator::Nodetype Node;
+  typedef typename Generator::Spacetype Space;
+
+  typedef typename API::skeleton_signature::bind<Args...>::type args;
+
+  static constexpr bool isEnumeration = parameter::value_type<args, API::tag::Enumeration_, std::integral_constant<bool, false> >::type::value;
+  static constexpr bool isOptimisation = parameter::value_type<args, API::tag::Optimisation_, std::integral_constant<bool, false> >::type::value;
+  static constexpr bool isDecision = parameter::value_type<args, API::tag::Decision_, std::integral_constant<bool, false> >::type::value;
+  static constexpr bool isDepthLimited = parameter::value_type<args, API::tag::DepthLimited_, std::integral_constant<bool, false> >::type::value;
+  static constexpr bool pruneLevel = parameter::value_type<args, API::tag::PruneLevel_, std::integral_constant<bool, false> >::type::value;
+  static constexpr bool inPlace = parameter::value_type<args, API::tag::InPlace_, std::integral_constant<bool, false> >::type::value;
+
+  typedef typename parameter::value_type<args, API::tag::Verbose_, std::integral_constant<unsigned, 0> >::type Verbose;
+  static constexpr unsigned verbose = Verbose::value;
+
+  typedef typename parameter::value_type<args, API::tag::BoundFunction, nullFn__>::type boundFn;
+  typedef typename boundFn::return_type Bound;
+  typedef typename parameter::value_type<args, API::tag::ObjectiveComparison, std::greater<Bound> >::type Objcmp;
+  typedef typename parameter::value_type<args, API::tag::Enumerator, IdentityEnumerator<Node>>::type Enum;
+  typedef typename parameter::value_type<args, API::tag::IncumbentCallback, nullFn__>::type incumbentCb;
+  typedef typename parameter::value_type<args, API::tag::NogoodKey, nullFn__>::type nogoodKey;
+  static constexpr bool useNogoods = !isEnumeration && !std::is_same<nogoodKey, nullFn__>::value;
+  typedef typename parameter::value_type<args, API::tag::TranspositionKey, nullFn__>::type transpositionKey;
+
+  // Restarted runs revisit nodes, so nothing can be folded over them and a
+  // visited node doesn't mean its subtree was searched
+  static_assert(!isEnumeration && !foldsNodes<Node, Enum>,
+                "Portfolio supports Decision and Optimisation searches without Enumerators");
+  static_assert(std::is_same<transpositionKey, nullFn__>::value,
+                "Portfolio restarts can't use a transposition table, use a NogoodKey instead");
+
+  enum class RunResult { Finished, OutOfNodes, Stopped };
+
+  static inline std::atomic<std::uint64_t> restarts {0};
+  // Did a worker on this locality finish a run, i.e. search the whole tree
+  static inline std::atomic<bool> finished {false};
+
+  static void printSkeletonDetails(const API::Params<Bound> & params) {
+    hpx::cout << "Skeleton Type: Portfolio\n";
+    hpx::cout << "Restart Base: " << params.restartBase << "\n";
+    hpx::cout << "Optimisation: " << std::boolalpha << isOptimisation << "\n";
+    hpx::cout << "Decision: " << std::boolalpha << isDecision << "\n";
+    hpx::cout << "DepthLimited: " << std::boolalpha << isDepthLimited << "\n";
+    if constexpr(!std::is_same<boundFn, nullFn__>::value) {
+      hpx::cout << "Using Bounding: true\n";
+      hpx::cout << "PruneLevel Optimisation: " << std::boolalpha << pruneLevel << "\n";
+    } else {
+      hpx::cout << "Using Bounding: false\n";
+    }
+    hpx::cout << "Sharing Nogoods: " << std::boolalpha << useNogoods << "\n";
+    hpx::cout << hpx::flush;
+  }
+
+  // One run below n. rng is null to keep the generator's order
+  static RunResult expand(const Space & space,
+                          const Node & n,
+                          const API::Params<Bound> & params,
+                          Enum & acc,
+                          std::mt19937_64 * rng,
+                          std::uint64_t & nodesLeft,
+                          const unsigned childDepth) {
+    auto reg = Registry<Space, Node, Bound, Enum>::gReg;
+
+    if (reg->stopSearch) {
+      return RunResult::Stopped;
+    }
+
+    if constexpr(isDepthLimited) {
+      if (childDepth == params.maxDepth) {
+        return RunResult::Finished;
+      }
+    }
+
+    // Children must all be generated up front to be reordered
+    Generator gen(space, n);
+    std::vector<Node> children;
+    children.reserve(gen.numChildren);
+    ChildBuffer<Generator> buf(gen);
+    for (auto i = 0; i < gen.numChildren; ++i) {
+      children.push_back(buf.next());
+    }
+    if (rng) {
+      std::shuffle(children.begin(), children.end(), *rng);
+    }
+
+    for (const auto & c : children) {
+      if (nodesLeft == 0) {
+        return RunResult::OutOfNodes;
+      }
+      --nodesLeft;
+
+      auto pn = ProcessNode<Space, Node, Args...>::processNode(params, space, c, acc);
+      if (pn == ProcessNodeRet::Exit) { return RunResult::Stopped; }
+      else if (pn == ProcessNodeRet::Prune) { continue; }
+      else if (pn == ProcessNodeRet::Break) {
+        // Later siblings only have worse bounds in the generator's order
+        if (rng) { continue; } else { break; }
+      }
+
+      auto res = expand(space, c, params, acc, rng, nodesLeft, childDepth + 1);
+      if (res != RunResult::Finished) {
+        return res;
+      }
+    }
+
+    if constexpr(useNogoods) {
+      Nogoods::Store<nogoodKey>::add(nogoodKey::invoke(n));
+    }
+
+    return RunResult::Finished;
+  }
+
+  static void worker(const std::uint64_t seed, const bool shuffle) {
+    auto reg = Registry<Space, Node, Bound, Enum>::gReg;
+    std::mt19937_64 rng(seed);
+    Enum acc;
+
+    for (std::uint64_t i = 1; !reg->stopSearch; ++i) {
+      std::uint64_t nodesLeft = Portfolio_::luby(i) * reg->params.restartBase;
+      auto res = expand(reg->space, reg->root, reg->params, acc, shuffle ? &rng : nullptr, nodesLeft, 1);
+
+      if (res == RunResult::Finished) {
+        // Nothing is left anywhere: every other worker can stop
+        finished = true;
+        hpx::wait_all(hpx::lcos::broadcast<SetStopFlagAct<Space, Node, Bound, Enum> >(
+            hpx::find_all_localities()));
+        return;
+      }
+      if (res == RunResult::OutOfNodes) {
+        restarts++;
+      }
+    }
+
+    // Every run restarts from the root, so short of a finished run only the
+    // nogoods have ruled anything out
+    ProcessNode<Space, Node, Args...>::leftOpen(reg->space, reg->root);
+  }
+
+  // Runs one worker per thread on this locality until the search stops. As with
+  // the schedulers one thread is left free (if there is more than one) so
+  // actions from other localities, e.g. stopping or bound updates, still run
+  static bool runWorkers(std::uint64_t seed) {
+    restarts = 0;
+    finished = false;
+
+    auto locality = hpx::get_locality_id();
+    auto threads = hpx::get_os_thread_count() == 1 ? 1 : hpx::get_os_thread_count() - 1;
+
+    hpx::threads::executors::default_executor exe(hpx::threads::thread_priority_normal,
+                                                  hpx::threads::thread_stacksize_huge);
+    std::vector<hpx::future<void> > workers;
+    for (auto i = 0u; i < threads; ++i) {
+      // seed_seq only takes 32 bit values
+      std::seed_seq seq { static_cast<std::uint32_t>(seed), static_cast<std::uint32_t>(seed >> 32),
+                          static_cast<std::uint32_t>(locality), static_cast<std::uint32_t>(i) };
+      std::mt19937_64 seeder(seq);
+      auto shuffle = !(locality == 0 && i == 0);
+      workers.push_back(hpx::async(exe, &worker, seeder(), shuffle));
+    }
+    hpx::wait_all(workers);
+    return finished;
+  }
+
+  static std::uint64_t getRestarts() {
+    return restarts;
+  }
+
+  static auto search (const Space & space,
+                      const Node & root,
+                      const API::Params<Bound> params = API::Params<Bound>()) {
+    static_assert(isOptimisation || isDecision, "Portfolio supports Decision and Optimisation searches");
+    static_assert(!inPlace, "InPlace is not supported by the Portfolio skeleton");
+
+    if constexpr (verbose) {
+      printSkeletonDetails(params);
+    }
+
+    hpx::wait_all(hpx::lcos::broadcast<InitRegistryAct<Space, Node, Bound, Enum> >(
+        hpx::find_all_localities(), space, root, params));
+    hpx::wait_all(hpx::lcos::broadcast<Anytime::reset_act>(hpx::find_all_localities()));
+
+    auto inc = hpx::new_<Incumbent>(hpx::find_here()).get();
+    hpx::wait_all(hpx::lcos::broadcast<UpdateGlobalIncumbentAct<Space, Node, Bound, Enum> >(
+        hpx::find_all_localities(), inc));
+    initIncumbent<Space, Node, Bound, Enum, Objcmp, Verbose>(root, params.initialBound);
+    if constexpr(!std::is_same<incumbentCb, nullFn__>::value) {
+      setIncumbentCallback<Space, Node, Bound, Enum, Objcmp, Verbose>(&incumbentCb::invoke);
+    }
+
+    if constexpr(useNogoods) {
+      startNogoods<nogoodKey, Bound>(params);
+    }
+    watchBudget<Space, Node, Bound, Enum>(params);
+
+    auto finishedAt = hpx::lcos::broadcast<Portfolio_::RunWorkersAct<Generator, Args...> >(
+        hpx::find_all_localities(), params.seed).get();
+
+    Anytime::stopWatch();
+    if constexpr(isOptimisation) {
+      // A finished run proves the incumbent optimal, whatever the budget did
+      auto complete = std::any_of(finishedAt.begin(), finishedAt.end(), [](bool f) { return f; });
+      recordBoundGap<Space, Node, Bound, Enum, Objcmp, boundFn>(
+          Registry<Space, Node, Bound, Enum>::gReg->localBound.load(), Anytime::exhausted() && !complete);
+    }
+
+    if constexpr(verbose >= 1) {
+      auto rs = hpx::lcos::broadcast<Portfolio_::GetRestartsAct<Generator, Args...> >(
+          hpx::find_all_localities()).get();
+      std::uint64_t total = 0;
+      for (auto r : rs) {
+        total += r;
+      }
+      hpx::cout << (boost::format("Restarts: %1%\n") % total) << hpx::flush;
+    }
+    if constexpr(useNogoods) {
+      reportNogoods<nogoodKey, Verbose>();
+    }
+
+    auto reg = Registry<Space, Node, Bound, Enum>::gReg;
+    typedef typename Incumbent::GetIncumbentAct<Node, Bound, Objcmp, Verbose> getInc;
+    return hpx::async<getInc>(reg->globalIncumbent).get();
+  }
+};
+
+namespace Portfolio_ {
+
+template <typename Generator, typename ...Args>
+struct RunWorkersAct : hpx::actions::make_action<
+  decltype(&Portfolio<Generator, Args...>::runWorkers),
+  &Portfolio<Generator, Args...>::runWorkers,
+  RunWorkersAct<Generator, Args...>>::type {};
+
+template <typename Generator, typename ...Args>
+struct GetRestartsAct : hpx::actions::make_action<
+  decltype(&Portfolio<Generator, Args...>::getRestarts),
+  &Portfolio<Generator, Args...>::getRestarts,
+  GetRestartsAct<Generator, Args...>>::type {};
+
+}
+
+}}
+
+#endif
@@ -10,6 +10,10 @@
 #include "API.hpp"
 #include "util/NodeGenerator.hpp"
 #include "util/Enumerator.hpp"
+#include "util/SolutionSet.hpp"
+#include "util/Anytime.hpp"
+#include "util/Registry.hpp"
+#include "util/TranspositionTable.hpp"
 #include "util/func.hpp"
 
 namespace YewPar { namespace Skeletons {
@@ -26,11 +30,19 @@ struct Seq {
   static constexpr bool isDecision = parameter::value_type<args, API::tag::Decision_, std::integral_constant<bool, false> >::type::value;
   static constexpr bool isDepthBounded = parameter::value_type<args, API::tag::DepthLimited_, std::integral_constant<bool, false> >::type::value;
   static constexpr bool pruneLevel = parameter::value_type<args, API::tag::PruneLevel_, std::integral_constant<bool, false> >::type::value;
+  static constexpr bool collectSolutions = parameter::value_type<args, API::tag::CollectSolutions_, std::integral_constant<bool, false> >::type::value;
+  static constexpr bool inPlace = parameter::value_type<args, API::tag::InPlace_, std::integral_constant<bool, false> >::type::value;
   static constexpr unsigned verbose = parameter::value_type<args, API::tag::Verbose_, std::integral_constant<unsigned, 0> >::type::value;
   typedef typename parameter::value_type<args, API::tag::BoundFunction, nullFn__>::type boundFn;
   typedef typename boundFn::return_type Bound;
   typedef typename parameter::value_type<args, API::tag::ObjectiveComparison, std::greater<Bound> >::type Objcmp;
   typedef typename parameter::value_type<args, API::tag::Enumerator, IdentityEnumerator<Node>>::type Enumerator;
+  static constexpr bool isFolding = isEnumeration || foldsNodes<Node, Enumerator>;
+  typedef typename parameter::value_type<args, API::tag::IncumbentCallback, nullFn__>::type incumbentCb;
+  typedef typename parameter::value_type<args, API::tag::TranspositionKey, nullFn__>::type transpositionKey;
+  static constexpr bool useTransposition = !std::is_same<transpositionKey, nullFn__>::value;
+  // Whether nodes left unexplored are recorded for the bound gap
+  static constexpr bool tracksOpen = isBnB && std::is_arithmetic<Bound>::value && !std::is_same<boundFn, nullFn__>::value;
 
   static void printSkeletonDetails() {
     hpx::cout << "Skeleton Type: Seq\n";
@@ -38,6 +50,7 @@ struct Seq {
     hpx::cout << "Optimisation: " << std::boolalpha << isBnB << "\n";
     hpx::cout << "Decision: " << std::boolalpha << isDecision << "\n";
     hpx::cout << "DepthBounded: " << std::boolalpha << isDepthBounded << "\n";
+    hpx::cout << "InPlace: " << std::boolalpha << inPlace << "\n";
     if constexpr(!std::is_same<boundFn, nullFn__>::value) {
       hpx::cout << "Using Bounding: true\n";
       hpx::cout << "PruneLevel Optimisation: " << std::boolalpha << pruneLevel << "\n";
@@ -47,15 +60,27 @@ struct Seq {
     hpx::cout << hpx::flush;
   }
 
+  static void notifyIncumbent(const Node & n) {
+    if constexpr(!std::is_same<incumbentCb, nullFn__>::value) {
+      incumbentCb::invoke(n);
+    }
+  }
+
+  // Outcome of visiting a child: go on to the next sibling, skip the rest of
+  // the level (PruneLevel), or stop as a decision search has been satisfied
+  enum class Visit { Next, Break, Found };
+
   static bool expand(const Space & space,
-                     const Node & n,
+                     Node & n,
                      const API::Params<Bound> & params,
                      std::pair<Node, Bound> & incumbent,
+                     SolutionSet<Node, Bound, Objcmp> & solutions,
+                     Anytime::LocalBudget & budget,
                      const unsigned childDepth,
                      Enumerator & acc) {
     Generator newCands = Generator(space, n);
 
-    if constexpr(isEnumeration) {
+    if constexpr(isFolding) {
         acc.accumulate(n);
     }
 
@@ -65,73 +90,159 @@ struct Seq {
         }
       }
 
+    // With InPlace n is the child until visit returns, otherwise children are
+    // copied out of the generator
+    if constexpr(inPlace) {
+      return expandChildren(space, newCands, [&](auto && visit) {
+          ScopedMove<Generator> move(space, n, newCands.nextMove());
+          return visit(n);
+        }, params, incumbent, solutions, budget, childDepth, acc);
+    } else {
+      ChildBuffer<Generator> children(newCands);
+      return expandChildren(space, newCands, [&](auto && visit) {
+          auto c = children.next();
+          return visit(c);
+        }, params, incumbent, solutions, budget, childDepth, acc);
+    }
+  }
+
+  // The prune/process/recurse logic shared by both expansions. Children are
+  // produced one at a time by step, which calls visit on the child while it is
+  // valid and returns what visit returned
+  template <typename Step>
+  static bool expandChildren(const Space & space,
+                             const Generator & newCands,
+                             Step && step,
+                             const API::Params<Bound> & params,
+                             std::pair<Node, Bound> & incumbent,
+                             SolutionSet<Node, Bound, Objcmp> & solutions,
+                             Anytime::LocalBudget & budget,
+                             const unsigned childDepth,
+                             Enumerator & acc) {
     for (auto i = 0; i < newCands.numChildren; ++i) {
-      auto c = newCands.next();
-
-      if constexpr(isDecision) {
-        if (c.getObj() == params.expectedObjective) {
-          std::get<0>(incumbent) = c;
-          if constexpr(verbose > 1) {
-            hpx::cout <<
-              (boost::format("Found solution on: %1%\n")
-              % static_cast<std::int64_t>(hpx::get_locality_id()))
-                      << hpx::flush;
+      if (budget.spend()) {
+        // The rest of this level is left unexplored
+        if constexpr(tracksOpen) {
+          for (; i < newCands.numChildren; ++i) {
+            step([&](Node & c) {
+              Registry<Space, Node, Bound, Enumerator>::gReg->template recordOpen<Objcmp>(boundFn::invoke(space, c));
+              return Visit::Next;
+            });
           }
-          return true;
         }
+        return false;
       }
 
-      // Do we support bounding?
-      if constexpr(!std::is_same<boundFn, nullFn__>::value) {
-          Objcmp cmp;
-          auto bnd  = boundFn::invoke(space, c);
-          if constexpr(isDecision) {
-            if (!cmp(bnd, params.expectedObjective) && bnd != params.expectedObjective) {
-              if constexpr(pruneLevel) {
-                break;
-              } else {
-                continue;
-              }
+      auto v = step([&](Node & c) {
+        if constexpr(useTransposition) {
+          if (!Transposition::Store<transpositionKey>::visit(c)) {
+            return Visit::Next;
+          }
+        }
+
+        if constexpr(isDecision) {
+          if (c.getObj() == params.expectedObjective) {
+            std::get<0>(incumbent) = c;
+            if constexpr(verbose > 1) {
+              hpx::cout <<
+                (boost::format("Found solution on: %1%\n")
+                % static_cast<std::int64_t>(hpx::get_locality_id()))
+                        << hpx::flush;
             }
-          // B&B Case
-          } else {
-            auto best = std::get<1>(incumbent);
-            if (!cmp(bnd,best)) {
-              if constexpr(pruneLevel) {
-                  break;
+            return Visit::Found;
+          }
+        }
+
+        // Do we support bounding?
+        if constexpr(!std::is_same<boundFn, nullFn__>::value) {
+            Objcmp cmp;
+            auto bnd  = boundFn::invoke(space, c);
+            if constexpr(isDecision) {
+              if (!cmp(bnd, params.expectedObjective) && bnd != params.expectedObjective) {
+                if constexpr(pruneLevel) {
+                  return Visit::Break;
                 } else {
-                continue;
+                  return Visit::Next;
+                }
               }
-            }
+            // B&B Case
+            } else {
+              auto best = std::get<1>(incumbent);
+              bool prune;
+              if constexpr(collectSolutions) {
+                prune = SolutionSet<Node, Bound, Objcmp>::prune(bnd, best, params.numSolutions == 0);
+              } else {
+                prune = !cmp(bnd,best);
+              }
+              if (prune) {
+                if constexpr(pruneLevel) {
+                    return Visit::Break;
+                  } else {
+                  return Visit::Next;
+                }
+              }
+          }
         }
-      }
 
-      if constexpr(isBnB) {
-        Objcmp cmp;
-        if (cmp(c.getObj(), std::get<1>(incumbent))) {
-          std::get<0>(incumbent) = c;
-          std::get<1>(incumbent) = c.getObj();
-          if constexpr(verbose >= 1) {
-            hpx::cout << (boost::format("New Incumbent: %1%\n") % c.getObj()) << hpx::flush;
+        if constexpr(isBnB && collectSolutions) {
+          if (SolutionSet<Node, Bound, Objcmp>::improves(c.getObj(), std::get<1>(incumbent), params.numSolutions == 0)
+              && solutions.add(c)) {
+            std::get<1>(incumbent) = solutions.bound();
+            if constexpr(verbose >= 1) {
+              hpx::cout << (boost::format("New Solutions Bound: %1%\n") % solutions.bound()) << hpx::flush;
+            }
+          }
+          Objcmp cmp;
+          if (!solutions.solutions().empty() &&
+              cmp(solutions.solutions().front().getObj(), std::get<0>(incumbent).getObj())) {
+            std::get<0>(incumbent) = solutions.solutions().front();
+            notifyIncumbent(std::get<0>(incumbent));
+          }
+        } else if constexpr(isBnB) {
+          Objcmp cmp;
+          if (cmp(c.getObj(), std::get<1>(incumbent))) {
+            std::get<0>(incumbent) = c;
+            std::get<1>(incumbent) = c.getObj();
+            if constexpr(verbose >= 1) {
+              hpx::cout << (boost::format("New Incumbent: %1%\n") % c.getObj()) << hpx::flush;
+            }
+            notifyIncumbent(c);
           }
         }
-      }
 
-      auto found = expand(space, c, params, incumbent, childDepth + 1, acc);
-      if constexpr(isDecision) {
-        // Propagate early exit
-        if (found) {
-          return true;
+        if (expand(space, c, params, incumbent, solutions, budget, childDepth + 1, acc)) {
+          return Visit::Found;
         }
+        return Visit::Next;
+      });
+
+      if (v == Visit::Break) {
+        break;
+      }
+      // Propagate early exit
+      if (v == Visit::Found) {
+        return true;
       }
     }
     return false;
   }
 
+  // Pairs the result of an Optimisation or Decision search with the nodes
+  // folded over, if given an Enumerator
+  template <typename Result>
+  static auto withFold(Result && result, Enumerator & acc) {
+    if constexpr(foldsNodes<Node, Enumerator>) {
+      return Folded<std::decay_t<Result>, typename Enumerator::ResT>{std::forward<Result>(result), takeResult(acc)};
+    } else {
+      return std::decay_t<Result>(std::forward<Result>(result));
+    }
+  }
+
   static auto search (const Space & space,
                       const Node & root,
                       const API::Params<Bound> params = API::Params<Bound>()) {
     static_assert(isEnumeration || isBnB || isDecision, "Please provide a supported search type: Enumeration, BnB, Decision");
+    static_assert(!inPlace || isInPlaceGenerator<Generator>::value, "InPlace requires a generator providing nextMove, apply and undo");
 
     if constexpr (verbose) {
       printSkeletonDetails();
@@ -140,12 +251,39 @@ struct Seq {
     Enumerator acc;
 
     std::pair<Node, Bound> incumbent = std::make_pair(root, params.initialBound);
-    expand(space, root, params, incumbent, 1, acc);
+    SolutionSet<Node, Bound, Objcmp> solutions(params.numSolutions, params.initialBound);
+    Anytime::LocalBudget budget(params.timeout, params.nodeLimit);
+    if (params.timeout > 0 || params.nodeLimit > 0) {
+      Anytime::reset();
+    }
+    if constexpr(tracksOpen) {
+      Registry<Space, Node, Bound, Enumerator>::gReg->resetOpen();
+    }
+    if constexpr(useTransposition) {
+      Transposition::Store<transpositionKey>::init(params.transpositionCapacity, false);
+    }
+    auto n = root;
+    expand(space, n, params, incumbent, solutions, budget, 1, acc);
+
+    if (budget.exhausted()) {
+      Anytime::markExhausted();
+    }
+    if constexpr(isBnB) {
+      Bound best;
+      if constexpr(collectSolutions) {
+        best = solutions.bound();
+      } else {
+        best = std::get<1>(incumbent);
+      }
+      recordBoundGap<Space, Node, Bound, Enumerator, Objcmp, boundFn>(best, budget.exhausted(), false);
+    }
 
-    if constexpr(isBnB || isDecision) {
-      return std::get<0>(incumbent);
+    if constexpr(isBnB && collectSolutions) {
+      return withFold(solutions.solutions(), acc);
+    } else if constexpr(isBnB || isDecision) {
+      return withFold(std::get<0>(incumbent), acc);
     } else if constexpr(isEnumeration) {
-      return acc.get();
+      return takeResult(acc);
     }
   }
 };
@@ -1,6 +1,7 @@
 #ifndef SKELETONS_STACKSTEAL_HPP
 #define SKELETONS_STACKSTEAL_HPP
 
+#include <algorithm>
 #include <iostream>
 #include <vector>
 #include <cstdint>
@@ -17,14 +18,13 @@
 #include "util/Incumbent.hpp"
 #include "util/func.hpp"
 #include "util/util.hpp"
+#include "util/TerminationDetection.hpp"
 
 #include "Common.hpp"
 
 #include "workstealing/Scheduler.hpp"
 #include "workstealing/policies/SearchManager.hpp"
 
-#include "skeletons/Seq.hpp"
-
 namespace YewPar { namespace Skeletons {
 
 template <typename Generator, typename ...Args>
@@ -39,6 +39,8 @@ struct StackStealing {
   static constexpr bool isDecision = parameter::value_type<args, API::tag::Decision_, std::integral_constant<bool, false> >::type::value;
   static constexpr bool isDepthBounded = parameter::value_type<args, API::tag::DepthLimited_, std::integral_constant<bool, false> >::type::value;
   static constexpr bool pruneLevel = parameter::value_type<args, API::tag::PruneLevel_, std::integral_constant<bool, false> >::type::value;
+  static constexpr bool collectSolutions = parameter::value_type<args, API::tag::CollectSolutions_, std::integral_constant<bool, false> >::type::value;
+  static constexpr bool inPlace = parameter::value_type<args, API::tag::InPlace_, std::integral_constant<bool, false> >::type::value;
   static constexpr unsigned maxStackDepth = parameter::value_type<args, API::tag::MaxStackDepth, std::integral_constant<unsigned, 5000> >::type::value;
 
   typedef typename parameter::value_type<args, API::tag::Verbose_, std::integral_constant<unsigned, 0> >::type Verbose;
@@ -48,6 +50,12 @@ struct StackStealing {
   typedef typename boundFn::return_type Bound;
   typedef typename parameter::value_type<args, API::tag::ObjectiveComparison, std::greater<Bound> >::type Objcmp;
   typedef typename parameter::value_type<args, API::tag::Enumerator, IdentityEnumerator<Node>>::type Enum;
+  static constexpr bool isFolding = isEnumeration || foldsNodes<Node, Enum>;
+  typedef typename parameter::value_type<args, API::tag::IncumbentCallback, nullFn__>::type incumbentCb;
+  typedef typename parameter::value_type<args, API::tag::NogoodKey, nullFn__>::type nogoodKey;
+  static constexpr bool useNogoods = !isEnumeration && !collectSolutions && !std::is_same<nogoodKey, nullFn__>::value;
+  typedef typename parameter::value_type<args, API::tag::TranspositionKey, nullFn__>::type transpositionKey;
+  static constexpr bool useTransposition = !std::is_same<transpositionKey, nullFn__>::value;
 
   static void printSkeletonDetails(const API::Params<Bound> & params) {
     hpx::cout << "Skeleton Type: StackStealing\n";
@@ -56,6 +64,7 @@ struct StackStealing {
     hpx::cout << "Decision: " << std::boolalpha << isDecision << "\n";
     hpx::cout << "DepthBounded: " << std::boolalpha << isDepthBounded << "\n";
     hpx::cout << "MaxStackDepth: " << maxStackDepth << "\n";
+    hpx::cout << "InPlace: " << std::boolalpha << inPlace << "\n";
     if constexpr(!std::is_same<boundFn, nullFn__>::value) {
         hpx::cout << "Using Bounding: true\n";
         hpx::cout << "PruneLevel Optimisation: " << std::boolalpha << pruneLevel << "\n";
@@ -67,17 +76,28 @@ struct StackStealing {
   }
 
   static void subTreeTask(const Node initNode,
-                          const unsigned depth,
-                          const hpx::naming::id_type donePromise) {
+                          const unsigned depth) {
     auto reg = Registry<Space, Node, Bound, Enum>::gReg;
+
+    // Stolen nodes haven't been processed, so may have been visited already
+    if constexpr(useTransposition) {
+      if (!Transposition::Store<transpositionKey>::visit(initNode)) {
+        Termination::taskCompleted();
+        return;
+      }
+    }
+
+    // Refines the estimates steal decisions use (until there are enough)
+    if (reg->params.minTaskNodes > 0) {
+      Estimator::subtreeSize<Generator>(reg->space, initNode, depth, reg->params);
+    }
+
     Enum acc;
 
     // Setup the stack with root node
-    StackElem<Generator> rootElem(reg->space, initNode);
-
-    GeneratorStack<Generator> generatorStack(maxStackDepth, rootElem);
+    SearchStack<Generator, inPlace> generatorStack(reg->space, initNode, maxStackDepth);
 
-    if constexpr(isEnumeration) {
+    if constexpr(isFolding) {
         acc.accumulate(initNode);
     }
 
@@ -86,7 +106,7 @@ struct StackStealing {
     unsigned threadId;
     std::tie(stealReq, threadId) = std::static_pointer_cast<Policy>(Workstealing::Scheduler::local_policy)->registerThread();
 
-    runTaskFromStack(depth, reg->space, generatorStack, stealReq, acc, donePromise, threadId);
+    runTaskFromStack(depth, reg->space, generatorStack, stealReq, acc, threadId);
   }
 
   using SubTreeTask = func<
@@ -96,186 +116,127 @@ struct StackStealing {
   using Policy      = Workstealing::Policies::SearchManager::SearchManagerComp<Node, SubTreeTask, Args...>;
   using Response    = typename Policy::Response_t;
   using SharedState = typename Policy::SharedState_t;
-
-  // Find the (approx) required depth<Generator> to create "totalThreads" tasks
-  static unsigned getRequiredSpawnDepth(const Space & space,
-                                        const Node & root,
-                                        const YewPar::Skeletons::API::Params<Bound> params,
-                                        const unsigned totalThreads) {
-
-    auto depthRequired = 1;
-    while (depthRequired <= params.maxDepth) {
-      auto localParams = params;
-      localParams.maxDepth = depthRequired;
-      std::uint64_t numNodes = YewPar::Skeletons::Seq<Generator,
-                                             YewPar::Skeletons::API::Enumeration,
-                                             YewPar::Skeletons::API::Enumerator<CountNodesEnumerator<Node>>,
-                                             YewPar::Skeletons::API::BoundFunction<boundFn>,
-                                             YewPar::Skeletons::API::ObjectiveComparison<Objcmp>,
-                                             YewPar::Skeletons::API::DepthLimited>
-                      ::search(space, root, localParams);
-      if (numNodes >= totalThreads) {
-        break;
+  using Stack       = StackSearch<Generator, Policy, Args...>;
+  using Process     = ProcessNode<Space, Node, Args...>;
+
+  // Can n be pruned using only the initial bound (as nothing has been found
+  // when the spawn depth is chosen)
+  static bool initiallyPrunable(const Space & space,
+                                const Node & n,
+                                const API::Params<Bound> & params) {
+    if constexpr(!std::is_same<boundFn, nullFn__>::value) {
+      Objcmp cmp;
+      auto bnd = boundFn::invoke(space, n);
+      if constexpr(isDecision) {
+        return !cmp(bnd, params.expectedObjective) && bnd != params.expectedObjective;
+      } else {
+        return !cmp(bnd, params.initialBound);
       }
-      ++depthRequired;
     }
-    return depthRequired;
+    return false;
   }
 
-  // TODO: We only need the depth for counting so need to constexpr more
-  static void runWithStack(const int startingDepth,
-                           const Space & space,
-                           GeneratorStack<Generator> & generatorStack,
-                           std::shared_ptr<SharedState> stealRequest,
-                           Enum & acc,
-                           std::vector<hpx::future<void> > & futures,
-                           int stackDepth = 0,
-                           int depth = -1) {
-    auto reg = Registry<Space, Node, Bound, Enum>::gReg;
-    std::vector<hpx::promise<void> > promises;
-
-    // We do this because arguments can't default initialise to themselves
-    if (depth == -1) {
-      depth = startingDepth;
-    }
+  // Find the shallowest depth with (approx) enough nodes to create
+  // "totalThreads" tasks. The tree is expanded a level at a time so no node is
+  // generated more than once, and leaves aren't counted since they carry no
+  // work.
+  //
+  // With estimatorProbes set the level's subtrees are also sampled, and a
+  // level only has enough work once its estimated weight would fill
+  // totalThreads tasks as large as its largest subtree, so one heavy subtree
+  // doesn't leave the other workers idle. Levels wider than maxSpawnLevel
+  // tasks per thread are always taken, bounding the cost on noisy estimates.
+  static constexpr unsigned maxSpawnLevel = 16;
 
-    while (stackDepth >= 0) {
-
-      if constexpr(isDecision) {
-        if (reg->stopSearch) {
-          return;
+  static unsigned getRequiredSpawnDepth(const Space & space,
+                                        const Node & root,
+                                        const YewPar::Skeletons::API::Params<Bound> & params,
+                                        const unsigned totalThreads) {
+    std::vector<Node> level { root };
+    unsigned depth = 0;
+    while (depth < params.maxDepth && depth + 1 < maxStackDepth) {
+      // Generators reference their parent node so level must not change while
+      // they are alive
+      std::vector<Generator> gens;
+      gens.reserve(level.size());
+      std::size_t work = 0;
+      for (const auto & n : level) {
+        gens.emplace_back(space, n);
+        if (gens.back().numChildren > 0) {
+          ++work;
         }
       }
 
-      // Handle steals first
-      if (std::get<0>(*stealRequest)) {
-        // We steal from the highest possible generator with work
-        bool responded = false;
-        for (auto i = 0; i < stackDepth; ++i) {
-          // Work left at this level:
-          if (generatorStack[i].seen < generatorStack[i].gen.numChildren) {
-            if (reg->params.stealAll) {
-              Response res;
-              while (generatorStack[i].seen < generatorStack[i].gen.numChildren) {
-                generatorStack[i].seen++;
-
-                promises.emplace_back();
-                auto & prom = promises.back();
-
-                futures.push_back(prom.get_future());
-
-                const auto stolenSol = generatorStack[i].gen.next();
-                res.emplace_back(hpx::util::make_tuple(stolenSol, startingDepth + i + 1, prom.get_id()));
-              }
-
-              std::get<1>(*stealRequest).set(res);
-              responded = true;
-              break;
-              // Steal the first task only
-            } else {
-              generatorStack[i].seen++;
-
-              promises.emplace_back();
-              auto & prom = promises.back();
-
-              futures.push_back(prom.get_future());
-
-              const auto stolenSol = generatorStack[i].gen.next();
-              Response res {hpx::util::make_tuple(stolenSol, startingDepth + i + 1, prom.get_id())};
-              std::get<1>(*stealRequest).set(res);
-
-              responded = true;
-              break;
-            }
+      if (depth > 0 && work >= totalThreads) {
+        if (params.estimatorProbes == 0 || work >= maxSpawnLevel * totalThreads) {
+          break;
+        }
+        auto below = std::min(params.maxDepth - depth, Estimator::maxProbeDepth);
+        double total = 0.0, heaviest = 0.0;
+        for (auto i = 0; i < level.size(); ++i) {
+          if (gens[i].numChildren > 0) {
+            auto w = Estimator::estimate<Generator>(space, level[i], below, params.estimatorProbes).total();
+            total += w;
+            heaviest = std::max(heaviest, w);
           }
         }
-        if (!responded) {
-          Response res;
-          std::get<1>(*stealRequest).set(res);
+        if (total >= heaviest * totalThreads) {
+          break;
         }
-        std::get<0>(*stealRequest).store(false);
       }
 
-      // If there's still children at this stackDepth we move into them
-      if (generatorStack[stackDepth].seen < generatorStack[stackDepth].gen.numChildren) {
-
-        // Get the next child at this stackDepth
-        generatorStack[stackDepth + 1].node = generatorStack[stackDepth].gen.next();
-        auto & child = generatorStack[stackDepth + 1].node;
-
-        generatorStack[stackDepth].seen++;
-
-        auto pn = ProcessNode<Space, Node, Args...>::processNode(reg->params, space, child, acc);
-        if (pn == ProcessNodeRet::Exit) { return; }
-        else if (pn == ProcessNodeRet::Prune) { continue; }
-        else if (pn == ProcessNodeRet::Break) {
-          stackDepth--;
-          depth--;
-          continue;
-        }
-
-        // Get the child's generator
-        const auto childGen = Generator(space, child);
-
-        // Going down
-        stackDepth++;
-        depth++;
-
-        if constexpr(isDepthBounded) {
-            // This doesn't look quite right to me, we want the next element at this level not the previous?
-            if (depth == reg->params.maxDepth) {
-              stackDepth--;
-              depth--;
-              continue;
+      std::vector<Node> next;
+      for (auto & gen : gens) {
+        for (auto i = 0; i < gen.numChildren; ++i) {
+          auto c = gen.next();
+          if (!initiallyPrunable(space, c, params)) {
+            next.push_back(std::move(c));
           }
         }
+      }
 
-        generatorStack[stackDepth].seen = 0;
-        generatorStack[stackDepth].gen = childGen;
-      } else {
-        stackDepth--;
-        depth--;
+      gens.clear();
+      if (next.empty()) {
+        break;
       }
+      level = std::move(next);
+      ++depth;
     }
-  }
 
+    return std::max(depth, 1u);
+  }
 
   static void runTaskFromStack (const unsigned startingDepth,
                                 const Space & space,
-                                GeneratorStack<Generator> & generatorStack,
+                                SearchStack<Generator, inPlace> & generatorStack,
                                 const std::shared_ptr<SharedState> stealRequest,
                                 Enum & acc,
-                                const hpx::naming::id_type donePromise,
                                 const unsigned searchManagerId,
                                 const int stackDepth = 0,
                                 const int depth = -1) {
     auto reg = Registry<Space, Node, Bound, Enum>::gReg;
-    std::vector<hpx::future<void> > futures;
+    Trace::Task trace(startingDepth);
 
-    runWithStack(startingDepth, space, generatorStack, stealRequest, acc, futures, stackDepth, depth);
+    Stack::run(startingDepth, space, generatorStack, stealRequest, acc, stackDepth, depth);
 
     // Atomically updates the (process) local counter
-    if constexpr(isEnumeration) {
+    if constexpr(isFolding) {
         reg->updateEnumerator(acc);
     }
 
     std::static_pointer_cast<Policy>(Workstealing::Scheduler::local_policy)->unregisterThread(searchManagerId);
 
-    hpx::apply(hpx::util::bind([=](std::vector<hpx::future<void> > & futs) {
-          hpx::wait_all(futs);
-          hpx::async<hpx::lcos::base_lco_with_value<void>::set_value_action>(donePromise, true);
-        }, std::move(futures)));
+    Termination::taskCompleted();
   }
 
 
   // Action to push a new scheduler running this skeleton to a distributed node
   // (for setting initial work distribution)
   static void addWork (const Node initNode,
-                       const unsigned depth,
-                       const hpx::naming::id_type donePromise) {
+                       const unsigned depth) {
     hpx::threads::executors::default_executor exe(hpx::threads::thread_priority_critical,
                                                   hpx::threads::thread_stacksize_huge);
-    hpx::util::function<void(),false> fn = hpx::util::bind(SubTreeTask::fn_ptr(), initNode, depth, donePromise);
+    hpx::util::function<void(),false> fn = hpx::util::bind(SubTreeTask::fn_ptr(), initNode, depth);
     auto f = hpx::util::bind(&Workstealing::Scheduler::scheduler, fn);
     exe.add(f);
   }
@@ -284,72 +245,83 @@ struct StackStealing {
     &StackStealing<Generator, Args...>::addWork,
     addWorkAct>::type {};
 
+  // Initial tasks beyond a locality's workers wait in its SearchManager, which
+  // hands them out before stealing from stacks
+  static void seedWork (const Node initNode,
+                        const unsigned depth) {
+    std::static_pointer_cast<Policy>(Workstealing::Scheduler::local_policy)->addwork(initNode, depth);
+  }
+  struct seedWorkAct : hpx::actions::make_action<
+    decltype(&StackStealing<Generator, Args...>::seedWork),
+    &StackStealing<Generator, Args...>::seedWork,
+    seedWorkAct>::type {};
+
+  // Task i goes to localities[targets[i]]. The first workers[l] tasks a
+  // locality is given each start a new scheduler there, any more are seeded.
+  // given counts the tasks each locality received
   static void spawnInitialWork(const unsigned depthRequired,
-                               const unsigned tasksRequired,
+                               const std::vector<hpx::naming::id_type> & localities,
+                               const std::vector<unsigned> & targets,
+                               const std::vector<unsigned> & workers,
+                               std::vector<unsigned> & given,
                                int & stackDepth,
                                int & depth,
                                const Space & space,
-                               GeneratorStack<Generator> & generatorStack,
-                               Enum & acc,
-                               std::vector<hpx::future<void> > & futures){
+                               SearchStack<Generator, inPlace> & generatorStack,
+                               Enum & acc){
 
     auto reg = Registry<Space, Node, Bound, Enum>::gReg;
-    auto localities = util::findOtherLocalities();
-    localities.push_back(hpx::find_here());
+    const auto tasksRequired = targets.size();
 
     auto tasksSpawned = 0;
     while (stackDepth >= 0) {
-      // If there's still children at this stackDepth we move into them
-      if (generatorStack[stackDepth].seen < generatorStack[stackDepth].gen.numChildren) {
-
-        // Get the next child at this stackDepth
-        generatorStack[stackDepth + 1].node = generatorStack[stackDepth].gen.next();
-        auto & child = generatorStack[stackDepth + 1].node;
-
-        generatorStack[stackDepth].seen++;
-
-        // Going down
-        stackDepth++;
-        depth++;
-
-        // Push anything at this depth as a task
-        if (stackDepth == depthRequired) {
-          hpx::promise<void> prom;
-          auto f = prom.get_future();
-          auto pid = prom.get_id();
-          futures.push_back(std::move(f));
-
-          // This needs to go to localities no managers now
-          auto mgr = tasksSpawned % localities.size();
-          hpx::async<addWorkAct>(localities[mgr], child, depth, pid);
+      if (!generatorStack.hasNext(stackDepth)) {
+        generatorStack.up(stackDepth, &Process::subtreeFinished);
+        depth--;
+        continue;
+      }
 
-          stackDepth--;
-          depth--;
-          tasksSpawned++;
+      // Push anything at this depth as a task
+      if (stackDepth + 1 == depthRequired) {
+        generatorStack.take(stackDepth, 1, stackDepth, [&](const Node & c) {
+            auto l = targets[tasksSpawned];
+            Termination::taskCreated();
+            if (given[l] < workers[l]) {
+              hpx::apply<addWorkAct>(localities[l], c, depth + 1);
+            } else {
+              hpx::apply<seedWorkAct>(localities[l], c, depth + 1);
+            }
+            given[l]++;
+          });
+        tasksSpawned++;
 
-          // We keep a spare thread for ourselves to execute as
-          if (tasksSpawned == tasksRequired) {
-            break;
-          }
-        } else {
-          // Need to process nodes we don't spawn to ensure correct enumeration etc
-          auto pn = ProcessNode<Space, Node, Args...>::processNode(reg->params, space, child, acc);
-          if (pn == ProcessNodeRet::Exit) { return; }
-          else if (pn == ProcessNodeRet::Prune) { continue; }
-          else if (pn == ProcessNodeRet::Break) {
-            stackDepth--;
-            depth--;
-            continue;
-          }
-          // Get the child's generator
-          const auto childGen = Generator(space, child);
-          generatorStack[stackDepth].seen = 0;
-          generatorStack[stackDepth].gen = childGen;
+        // We keep a spare thread for ourselves to execute as
+        if (tasksSpawned == tasksRequired) {
+          break;
         }
-      } else {
-        stackDepth--;
+        continue;
+      }
+
+      // Need to process nodes we don't spawn to ensure correct enumeration etc
+      const auto & child = generatorStack.next(stackDepth);
+      auto pn = Process::processNode(reg->params, space, child, acc);
+      if (pn == ProcessNodeRet::Exit) { return; }
+      else if (pn == ProcessNodeRet::Prune) {
+        generatorStack.skip(stackDepth);
+        continue;
+      }
+      else if (pn == ProcessNodeRet::Break) {
+        generatorStack.skip(stackDepth);
+        generatorStack.up(stackDepth, &Process::subtreeFinished);
         depth--;
+        continue;
       }
+
+      // Going down
+      const auto childGen = Generator(space, child);
+      stackDepth++;
+      depth++;
+      generatorStack.enter(stackDepth, childGen);
     }
   }
 
@@ -357,18 +329,27 @@ struct StackStealing {
                        const Node & root,
                        const API::Params<Bound> & params) {
 
-    // FIXME: Assumes homogeneous machines
+    // One initial task per worker (the master's last worker runs the main
+    // stack), split between localities by their share of the workers and
+    // speed, see util::LocalityCapacity. A faster locality gets more tasks
+    // than it has workers and a slower one fewer
+    auto localities = util::findOtherLocalities();
+    localities.push_back(hpx::find_here());
+    auto capacities = hpx::lcos::broadcast<util::getLocalCapacity_act>(localities).get();
+
     unsigned totalThreads = 0;
-    if (hpx::get_os_thread_count() == 1) {
-      totalThreads = hpx::find_all_localities().size();
-    } else {
-      totalThreads = hpx::find_all_localities().size() * (hpx::get_os_thread_count() - 1);
+    std::vector<double> shares;
+    std::vector<unsigned> workers;
+    for (const auto & c : capacities) {
+      totalThreads += c.workers;
+      shares.push_back(c.share());
+      workers.push_back(c.workers);
     }
+    workers.back()--;
+    std::vector<unsigned> given(localities.size(), 0);
 
     // Master stack
-    StackElem<Generator> rootElem(space, root);
-
-    GeneratorStack<Generator> genStack(maxStackDepth, rootElem);
+    SearchStack<Generator, inPlace> genStack(space, root, maxStackDepth);
 
     Enum acc;
     acc.accumulate(root);
@@ -376,10 +357,29 @@ struct StackStealing {
     auto stackDepth = 0;
     auto depth = 1;
 
-    std::vector<hpx::future<void> > futures;
     if (totalThreads > 1) {
       auto depthRequired = getRequiredSpawnDepth(space, root, params, totalThreads);
-      spawnInitialWork(depthRequired, totalThreads - 1, stackDepth, depth, space, genStack, acc, futures);
+      auto targets = util::weightedDistribution(shares, util::weightedCounts(shares, totalThreads - 1));
+      spawnInitialWork(depthRequired, localities, targets, workers, given, stackDepth, depth, space, genStack, acc);
+
+      // Workers without an initial task (the tree may also have had fewer
+      // nodes than tasks) start out stealing
+      for (auto i = 0; i < localities.size(); ++i) {
+        if (given[i] < workers[i]) {
+          hpx::apply<Workstealing::Scheduler::startSchedulers_act>(localities[i], workers[i] - given[i]);
+        }
+      }
+    }
+
+    if constexpr(verbose) {
+      std::vector<unsigned> byId(localities.size(), 0);
+      for (auto i = 0; i < localities.size(); ++i) {
+        byId[hpx::naming::get_locality_id_from_id(localities[i])] = given[i];
+      }
+      for (auto i = 0; i < byId.size(); ++i) {
+        hpx::cout << (boost::format("Initial tasks on locality %1%: %2%\n") % i % byId[i]);
+      }
+      hpx::cout << hpx::flush;
     }
 
     // Register the rest of the work from the main thread with the search manager
@@ -387,34 +387,37 @@ struct StackStealing {
     auto stealRequest  = std::get<0>(searchMgrInfo);
 
     // Continue the actual work
-    hpx::promise<void> prom;
-    auto f = prom.get_future();
-    auto pid = prom.get_id();
+    Termination::taskCreated();
 
     // Launch initialising thread as a new Scheduler
     if (totalThreads == 1) {
-      runTaskFromStack(1, space, genStack, stealRequest, acc, pid, std::get<1>(searchMgrInfo), stackDepth, depth);
+      runTaskFromStack(1, space, genStack, stealRequest, acc, std::get<1>(searchMgrInfo), stackDepth, depth);
     } else {
       hpx::threads::executors::default_executor exe(hpx::threads::thread_priority_critical,
                                                     hpx::threads::thread_stacksize_huge);
-      hpx::util::function<void(), false> fn = hpx::util::bind(&runTaskFromStack, 1, space, genStack, stealRequest, acc, pid, std::get<1>(searchMgrInfo), stackDepth, depth);
+      hpx::util::function<void(), false> fn = hpx::util::bind(&runTaskFromStack, 1, space, genStack, stealRequest, acc, std::get<1>(searchMgrInfo), stackDepth, depth);
       auto f = hpx::util::bind(&Workstealing::Scheduler::scheduler, fn);
       exe.add(f);
     }
 
-    futures.push_back(std::move(f));
-    hpx::wait_all(futures);
+    Termination::waitForTermination();
   }
 
   static auto search (const Space & space,
                       const Node & root,
                       const API::Params<Bound> params = API::Params<Bound>()) {
+    static_assert(!inPlace || isInPlaceGenerator<Generator>::value, "InPlace requires a generator providing nextMove, apply and undo");
+
     if constexpr(verbose) {
       printSkeletonDetails(params);
     }
 
     hpx::wait_all(hpx::lcos::broadcast<InitRegistryAct<Space, Node, Bound, Enum> >(
         hpx::find_all_localities(), space, root, params));
+    hpx::wait_all(hpx::lcos::broadcast<Termination::reset_act>(hpx::find_all_localities()));
+    hpx::wait_all(hpx::lcos::broadcast<Anytime::reset_act>(hpx::find_all_localities()));
+    startWorkerStats<Verbose>();
+    startTrace(params);
 
     Policy::initPolicy();
 
@@ -423,30 +426,57 @@ struct StackStealing {
       hpx::wait_all(hpx::lcos::broadcast<UpdateGlobalIncumbentAct<Space, Node, Bound, Enum> >(
           hpx::find_all_localities(), inc));
       initIncumbent<Space, Node, Bound, Enum, Objcmp, Verbose>(root, params.initialBound);
+      if constexpr(collectSolutions) {
+        initSolutions<Space, Node, Bound, Enum, Objcmp, Verbose>(params.numSolutions, params.initialBound);
+      }
+      if constexpr(!std::is_same<incumbentCb, nullFn__>::value) {
+        setIncumbentCallback<Space, Node, Bound, Enum, Objcmp, Verbose>(&incumbentCb::invoke);
+      }
     }
 
+    estimateTreeSize<Generator, Bound, Verbose>(space, root, params);
+    if constexpr(useNogoods) {
+      startNogoods<nogoodKey, Bound>(params);
+    }
+    if constexpr(useTransposition) {
+      startTransposition<transpositionKey, Bound>(params);
+    }
+    watchBudget<Space, Node, Bound, Enum>(params);
+
     doSearch(space, root, params);
 
+    Anytime::stopWatch();
+    Estimator::stopReport();
+    if constexpr(isOptimisation) {
+      recordBoundGap<Space, Node, Bound, Enum, Objcmp, boundFn>(
+          Registry<Space, Node, Bound, Enum>::gReg->localBound.load(), Anytime::exhausted());
+    }
+
+    if constexpr(useNogoods) {
+      reportNogoods<nogoodKey, Verbose>();
+    }
+    if constexpr(useTransposition) {
+      reportTransposition<transpositionKey, Verbose>();
+    }
+
     hpx::wait_all(hpx::lcos::broadcast<Workstealing::Scheduler::stopSchedulers_act>(
         hpx::find_all_localities()));
 
-    hpx::cout << hpx::flush;
+    reportWorkerStats<Verbose>();
+    writeTrace(params);
 
-    if (verbose >= 3) {
-      for (const auto &l : hpx::find_all_localities()) {
-        // We don't broadcast here to avoid racy output.
-        hpx::async<Workstealing::Policies::SearchManagerPerf::printChunkSizeList_act>(l).get();
-      }
-    }
+    hpx::cout << hpx::flush;
 
     // Return the right thing
     if constexpr(isEnumeration) {
       return combineEnumerators<Space, Node, Bound, Enum>();
+    } else if constexpr(isOptimisation && collectSolutions) {
+      return withFold<Space, Node, Bound, Enum>(getSolutions<Space, Node, Bound, Enum, Objcmp, Verbose>());
     } else if constexpr(isOptimisation || isDecision) {
       auto reg = Registry<Space, Node, Bound, Enum>::gReg;
 
       typedef typename Incumbent::GetIncumbentAct<Node, Bound, Objcmp, Verbose> getInc;
-      return hpx::async<getInc>(reg->globalIncumbent).get();
+      return withFold<Space, Node, Bound, Enum>(hpx::async<getInc>(reg->globalIncumbent).get());
     } else {
       static_assert(isEnumeration || isOptimisation || isDecision, "Please provide a supported search type: Enumeration, Optimisation, Decision");
     }
@@ -0,0 +1,92 @@
+#include "Anytime.hpp"
+
+#include <numeric>
+
+#include <hpx/hpx.hpp>
+#include <hpx/lcos/broadcast.hpp>
+#include <hpx/lcos/local/condition_variable.hpp>
+#include <hpx/lcos/local/mutex.hpp>
+
+namespace YewPar { namespace Anytime {
+
+std::uint64_t getNodes() {
+  return detail::nodes.load();
+}
+
+void reset() {
+  detail::epoch++;
+  detail::nodes = 0;
+  detail::exhausted = false;
+}
+
+// Time between budget checks (milliseconds)
+static constexpr std::uint64_t pollInterval = 10;
+
+static hpx::lcos::local::mutex mtx;
+static hpx::lcos::local::condition_variable finished_cv;
+static bool watching = false;
+static hpx::future<void> watcher;
+
+static void watch(const std::uint64_t timeout,
+                  const std::uint64_t nodeLimit,
+                  hpx::util::function<void(), false> stop) {
+  auto localities = hpx::find_all_localities();
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout);
+
+  std::unique_lock<hpx::lcos::local::mutex> l(mtx);
+  while (watching) {
+    finished_cv.wait_for(l, std::chrono::milliseconds(pollInterval));
+    if (!watching) {
+      return;
+    }
+
+    auto spent = timeout > 0 && std::chrono::steady_clock::now() >= deadline;
+    if (!spent && nodeLimit > 0) {
+      l.unlock();
+      std::uint64_t nodes;
+      if (localities.size() == 1) {
+        nodes = getNodes();
+      } else {
+        auto ns = hpx::lcos::broadcast<getNodes_act>(localities).get();
+        nodes = std::accumulate(ns.begin(), ns.end(), std::uint64_t(0));
+      }
+      spent = nodes >= nodeLimit;
+      l.lock();
+    }
+
+    if (spent) {
+      watching = false;
+      l.unlock();
+      markExhausted();
+      stop();
+      return;
+    }
+  }
+}
+
+void startWatch(const std::uint64_t timeout,
+                const std::uint64_t nodeLimit,
+                hpx::util::function<void(), false> stop) {
+  if (timeout == 0 && nodeLimit == 0) {
+    return;
+  }
+
+  {
+    std::lock_guard<hpx::lcos::local::mutex> l(mtx);
+    watching = true;
+  }
+  watcher = hpx::async(&watch, timeout, nodeLimit, std::move(stop));
+}
+
+void stopWatch() {
+  {
+    std::lock_guard<hpx::lcos::local::mutex> l(mtx);
+    watching = false;
+    finished_cv.notify_all();
+  }
+  if (watcher.valid()) {
+    watcher.get();
+  }
+}
+
+}}
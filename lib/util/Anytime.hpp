@@ -0,0 +1,108 @@
+#ifndef YEWPAR_ANYTIME_HPP
+#define YEWPAR_ANYTIME_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#include "hpx/runtime/actions/plain_action.hpp"
+#include "hpx/util/function.hpp"
+
+namespace YewPar { namespace Anytime {
+
+// Support for stopping a search once a wall-clock (milliseconds) or node budget
+// has been spent. The skeletons then return whatever they have found so far.
+//
+// Parallel skeletons count nodes per locality and a watcher on the master
+// locality polls the counts (and the clock) and stops the search when either
+// budget runs out. Counts are batched per worker so the node budget is
+// approximate: it may be overrun by up to countBatch nodes per worker.
+
+static constexpr std::uint64_t countBatch = 1024;
+
+namespace detail {
+inline std::atomic<std::uint64_t> nodes(0);
+inline std::atomic<bool> exhausted(false);
+// Bumped by reset so workers drop nodes batched during an earlier search
+inline std::atomic<std::uint64_t> epoch(0);
+}
+
+inline void countNode() {
+  thread_local std::uint64_t n = 0;
+  thread_local std::uint64_t epoch = 0;
+  auto e = detail::epoch.load(std::memory_order_relaxed);
+  if (epoch != e) {
+    epoch = e;
+    n = 0;
+  }
+  if (++n == countBatch) {
+    detail::nodes += n;
+    n = 0;
+  }
+}
+
+std::uint64_t getNodes();
+HPX_DEFINE_PLAIN_ACTION(getNodes, getNodes_act);
+
+// Clears the node count (and exhausted flag) ready for a new search
+void reset();
+HPX_DEFINE_PLAIN_ACTION(reset, reset_act);
+
+// Start watching the budgets on the master locality. stop is called (once) if
+// either budget runs out. A zero budget is unlimited; if both are zero this
+// does nothing
+void startWatch(const std::uint64_t timeout,
+                const std::uint64_t nodeLimit,
+                hpx::util::function<void(), false> stop);
+
+// Stop watching, must be called once the search has finished
+void stopWatch();
+
+// Did the last search run out of budget? Only meaningful on the master locality
+inline bool exhausted() {
+  return detail::exhausted.load();
+}
+
+inline void markExhausted() {
+  detail::exhausted.store(true);
+}
+
+// Sequential (single thread) version of the budget for Seq
+class LocalBudget {
+ private:
+  std::uint64_t nodeLimit;
+  std::uint64_t nodes = 0;
+  bool timed;
+  std::chrono::steady_clock::time_point deadline;
+  bool spent = false;
+
+ public:
+  LocalBudget(const std::uint64_t timeout, const std::uint64_t nodeLimit) :
+      nodeLimit(nodeLimit),
+      timed(timeout > 0),
+      deadline(std::chrono::steady_clock::now() + std::chrono::milliseconds(timeout)) {}
+
+  // Count a node and return true if the budget is (now) spent. The clock is
+  // only checked every countBatch nodes
+  bool spend() {
+    if (spent) {
+      return true;
+    }
+
+    ++nodes;
+    if (nodeLimit > 0 && nodes >= nodeLimit) {
+      spent = true;
+    } else if (timed && nodes % countBatch == 0 && std::chrono::steady_clock::now() >= deadline) {
+      spent = true;
+    }
+    return spent;
+  }
+
+  bool exhausted() const {
+    return spent;
+  }
+};
+
+}}
+
+#endif
@@ -0,0 +1,16 @@
+#ifndef YEWPAR_BITWISE_NODE_HPP
+#define YEWPAR_BITWISE_NODE_HPP
+
+#include <type_traits>
+
+#include <hpx/traits/is_bitwise_serializable.hpp>
+
+// Mark a trivially copyable node (or space) type so that HPX serialises it
+// with a single memcpy on every spawn/steal rather than member by member.
+// Must be used at global scope.
+#define YEWPAR_BITWISE_NODE(T)                                          \
+  static_assert(std::is_trivially_copyable<T>::value,                   \
+                #T " must be trivially copyable to be serialised bitwise"); \
+  HPX_IS_BITWISE_SERIALIZABLE(T)
+
+#endif
@@ -0,0 +1,88 @@
+#include "Checkpoint.hpp"
+
+#include <chrono>
+#include <numeric>
+
+#include <hpx/hpx.hpp>
+#include <hpx/lcos/broadcast.hpp>
+#include <hpx/lcos/local/condition_variable.hpp>
+#include <hpx/lcos/local/mutex.hpp>
+
+namespace YewPar { namespace Checkpoint {
+
+static hpx::lcos::local::mutex mtx;
+static hpx::lcos::local::condition_variable finished_cv;
+static bool checkpointing = false;
+static hpx::future<void> checkpointer;
+
+std::uint64_t getOpened(unsigned epoch) {
+  return detail::opened[epoch & 1].load();
+}
+
+std::uint64_t getClosed(unsigned epoch) {
+  return detail::closed[epoch & 1].load();
+}
+
+void reset() {
+  detail::epoch = 0;
+  detail::splitEpoch = 0;
+  for (auto i = 0; i < 2; ++i) {
+    detail::opened[i] = 0;
+    detail::closed[i] = 0;
+  }
+}
+
+// As Termination::countOutstanding, the closed wave must finish before the
+// opened wave starts
+std::uint64_t countUncovered(unsigned epoch) {
+  auto localities = hpx::find_all_localities();
+
+  auto cs = hpx::lcos::broadcast<getClosed_act>(localities, epoch - 1).get();
+  auto closed = std::accumulate(cs.begin(), cs.end(), std::uint64_t(0));
+
+  auto os = hpx::lcos::broadcast<getOpened_act>(localities, epoch - 1).get();
+  auto opened = std::accumulate(os.begin(), os.end(), std::uint64_t(0));
+
+  return opened - closed;
+}
+
+static void periodic(const std::uint64_t interval,
+                     hpx::util::function<void(), false> takeCheckpoint) {
+  std::unique_lock<hpx::lcos::local::mutex> l(mtx);
+  while (checkpointing) {
+    finished_cv.wait_for(l, std::chrono::milliseconds(interval));
+    if (!checkpointing) {
+      return;
+    }
+
+    l.unlock();
+    takeCheckpoint();
+    l.lock();
+  }
+}
+
+void startPeriodic(const std::uint64_t interval,
+                   hpx::util::function<void(), false> takeCheckpoint) {
+  if (interval == 0) {
+    return;
+  }
+
+  {
+    std::lock_guard<hpx::lcos::local::mutex> l(mtx);
+    checkpointing = true;
+  }
+  checkpointer = hpx::async(&periodic, interval, std::move(takeCheckpoint));
+}
+
+void stopPeriodic() {
+  {
+    std::lock_guard<hpx::lcos::local::mutex> l(mtx);
+    checkpointing = false;
+    finished_cv.notify_all();
+  }
+  if (checkpointer.valid()) {
+    checkpointer.get();
+  }
+}
+
+}}
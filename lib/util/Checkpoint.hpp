@@ -0,0 +1,199 @@
+#ifndef YEWPAR_CHECKPOINT_HPP
+#define YEWPAR_CHECKPOINT_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <hpx/runtime/actions/plain_action.hpp>
+#include <hpx/runtime/serialization/serialize.hpp>
+#include <hpx/runtime/serialization/string.hpp>
+#include <hpx/runtime/serialization/vector.hpp>
+#include <hpx/util/function.hpp>
+
+namespace YewPar { namespace Checkpoint {
+
+// Snapshots of a running search, taken without stopping it. A snapshot is
+// consistent: every node is either fully accounted for (in the enumerator or
+// incumbent) or below one of the frontier tasks, which have not started.
+//
+// Checkpoints are numbered (epochs) and every task carries the epoch of the
+// latest checkpoint that already accounts for its subtree. While checkpoint E is
+// taken, tasks still at E - 1 ("uncovered") hand over their results when they
+// complete. Running tasks also stop searching at their next child, spawn what
+// they have left as tasks at E and list those in the frontier, while tasks that
+// haven't started yet are listed directly. The checkpoint is complete once no
+// uncovered task is left.
+//
+// Snapshots are written with the nodes' own serialize methods and don't depend
+// on the number of localities, so a search can be resumed on any number.
+// Resuming needs the same binary (and search space) as the original search.
+
+template <typename Node>
+struct FrontierTask {
+  Node node;
+  unsigned depth;
+
+  template <class Archive>
+  void serialize(Archive & ar, const unsigned int version) {
+    ar & node;
+    ar & depth;
+  }
+};
+
+template <typename Node, typename Bound, typename EnumRes>
+struct Snapshot {
+  Node root;
+  std::vector<FrontierTask<Node> > frontier;
+
+  // Enumeration: everything accumulated so far
+  EnumRes enumerated;
+
+  // Optimisation: the incumbent so far
+  Node incumbent;
+  Bound bound;
+
+  template <class Archive>
+  void serialize(Archive & ar, const unsigned int version) {
+    ar & root;
+    ar & frontier;
+    ar & enumerated;
+    ar & incumbent;
+    ar & bound;
+  }
+};
+
+static constexpr char magic[4] = {'Y', 'P', 'C', 'K'};
+static constexpr std::uint32_t version = 1;
+
+// Write the snapshot to a temporary file first so a failure part way through
+// never destroys the previous checkpoint
+template <typename T>
+void write(const std::string & file, const T & snapshot) {
+  std::vector<char> buf;
+  {
+    hpx::serialization::output_archive ar(buf);
+    ar << snapshot;
+  }
+
+  auto tmp = file + ".tmp";
+  {
+    std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+    if (!out) {
+      throw std::runtime_error("Unable to open checkpoint file: " + tmp);
+    }
+    std::uint64_t size = buf.size();
+    out.write(magic, sizeof(magic));
+    out.write(reinterpret_cast<const char *>(&version), sizeof(version));
+    out.write(reinterpret_cast<const char *>(&size), sizeof(size));
+    out.write(buf.data(), buf.size());
+    if (!out) {
+      throw std::runtime_error("Failed writing checkpoint file: " + tmp);
+    }
+  }
+
+  if (std::rename(tmp.c_str(), file.c_str()) != 0) {
+    throw std::runtime_error("Unable to replace checkpoint file: " + file);
+  }
+}
+
+template <typename T>
+T read(const std::string & file) {
+  std::ifstream in(file, std::ios::binary);
+  if (!in) {
+    throw std::runtime_error("Unable to open checkpoint file: " + file);
+  }
+
+  char m[sizeof(magic)];
+  std::uint32_t v;
+  std::uint64_t size;
+  in.read(m, sizeof(m));
+  in.read(reinterpret_cast<char *>(&v), sizeof(v));
+  in.read(reinterpret_cast<char *>(&size), sizeof(size));
+  if (!in || !std::equal(std::begin(m), std::end(m), std::begin(magic)) || v != version) {
+    throw std::runtime_error("Not a checkpoint file: " + file);
+  }
+
+  std::vector<char> buf(size);
+  in.read(buf.data(), size);
+  if (!in) {
+    throw std::runtime_error("Truncated checkpoint file: " + file);
+  }
+
+  T snapshot;
+  hpx::serialization::input_archive ar(buf, size);
+  ar >> snapshot;
+  return snapshot;
+}
+
+namespace detail {
+// Latest checkpoint begun on this locality
+inline std::atomic<unsigned> epoch(0);
+// Latest checkpoint running tasks on this locality should split for
+inline std::atomic<unsigned> splitEpoch(0);
+// Tasks opened and closed (completed, or moved to a later epoch) by the
+// parity of their epoch. Only epochs E - 1 and E can be alive during
+// checkpoint E
+inline std::atomic<std::uint64_t> opened[2];
+inline std::atomic<std::uint64_t> closed[2];
+}
+
+inline unsigned begun() {
+  return detail::epoch.load();
+}
+
+inline unsigned splitEpoch() {
+  return detail::splitEpoch.load(std::memory_order_relaxed);
+}
+
+// Tasks completing from now on owe their results to checkpoint "epoch"
+inline void begin(const unsigned epoch) {
+  detail::epoch = epoch;
+}
+
+// Only once every locality has begun the checkpoint, as tasks spawned by a
+// split must not be counted in any locality's results from before it
+inline void startSplitting(const unsigned epoch) {
+  detail::splitEpoch = epoch;
+}
+
+inline void taskOpened(const unsigned epoch, const std::uint64_t n = 1) {
+  detail::opened[epoch & 1] += n;
+}
+
+inline void taskClosed(const unsigned epoch, const std::uint64_t n = 1) {
+  detail::closed[epoch & 1] += n;
+}
+
+std::uint64_t getOpened(unsigned epoch);
+HPX_DEFINE_PLAIN_ACTION(getOpened, getOpened_act);
+
+std::uint64_t getClosed(unsigned epoch);
+HPX_DEFINE_PLAIN_ACTION(getClosed, getClosed_act);
+
+// Clears the epochs and counts ready for a new search (on this locality)
+void reset();
+
+// Tasks with an epoch below "epoch" still alive, across every locality. Once
+// every locality has begun checkpoint "epoch" no new uncovered tasks are made,
+// so zero is final
+std::uint64_t countUncovered(unsigned epoch);
+
+// Call takeCheckpoint every interval milliseconds (on this locality) until
+// stopPeriodic is called. An interval of 0 does nothing
+void startPeriodic(const std::uint64_t interval,
+                   hpx::util::function<void(), false> takeCheckpoint);
+
+// Must be called once the search has finished. Waits for any checkpoint that is
+// in progress
+void stopPeriodic();
+
+}}
+
+#endif
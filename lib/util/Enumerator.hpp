@@ -1,13 +1,49 @@
 #ifndef UTIL_ENUMERATOR_HPP
 #define UTIL_ENUMERATOR_HPP
 
+#include <algorithm>
 #include <cstdint>
+#include <functional>
+#include <random>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <hpx/runtime/serialization/serialize.hpp>
+#include <hpx/runtime/serialization/vector.hpp>
 
 namespace YewPar {
 
 // Enumerators capture the ability to accumulate information about nodes over
 // the search and can be seen as a monoid.
+//
+// In Enumeration searches they see every node. They may also be given to
+// Optimisation and Decision searches, where they fold over every node the
+// search visits (after pruning) to gather statistics during the search itself,
+// see Folded.
 
+// Statically dispatched enumerator interface (CRTP). Skeletons hold
+// enumerators by their concrete type so deriving from this, rather than
+// Enumerator, lets accumulate inline into the skeleton loops.
+//
+// Derived types must provide:
+//   void accumulate(const NodeType & n);
+//   void combine(const ResultType & n);
+//   ResultType get();
+//
+// Enumerators with large (or move-only) results may also provide
+//   void combine(ResultType && n);
+//   ResultType take();
+// where take moves the result out. Skeletons use take for the final results and
+// only use get for checkpoints.
+template <typename Derived, typename NodeType, typename ResultType>
+struct StaticEnumerator {
+    using ResT = ResultType;
+};
+
+// Dynamically dispatched enumerator interface. Kept as an adapter for existing
+// enumerators, prefer StaticEnumerator for new code.
 template <typename NodeType, typename ResultType>
 struct Enumerator {
     using ResT = ResultType;
@@ -18,18 +54,195 @@ struct Enumerator {
 
 // Identity Enumerator - Don't save anything
 template <typename NodeType>
-struct IdentityEnumerator : Enumerator<NodeType, std::string> {
-    void accumulate(const NodeType & n) override {};
-    void combine(const std::string & s) override {};
-    std::string get() override { return "Identity Enumerator"; };
+struct IdentityEnumerator : StaticEnumerator<IdentityEnumerator<NodeType>, NodeType, std::string> {
+    void accumulate(const NodeType & n) {};
+    void combine(const std::string & s) {};
+    std::string get() { return "Identity Enumerator"; };
 };
 
 template <typename NodeType>
-struct CountNodesEnumerator : Enumerator<NodeType, std::uint64_t> {
+struct CountNodesEnumerator : StaticEnumerator<CountNodesEnumerator<NodeType>, NodeType, std::uint64_t> {
     std::uint64_t count = 0;
-    void accumulate(const NodeType & n) override { count++; };
-    void combine(const std::uint64_t & n) override { count += n; };
-    std::uint64_t get() override { return count; };
+    void accumulate(const NodeType & n) { count++; };
+    void combine(const std::uint64_t & n) { count += n; };
+    std::uint64_t get() { return count; };
+};
+
+// Optimisation and Decision searches given an Enumerator fold it over every
+// node they visit, and return their usual result (the incumbent or the
+// solutions) together with the fold
+template <typename NodeType, typename E>
+constexpr bool foldsNodes = !std::is_same<E, IdentityEnumerator<NodeType> >::value;
+
+template <typename Result, typename FoldT>
+struct Folded {
+  Result result;
+  FoldT fold;
+};
+
+template <typename E, typename = void>
+struct hasTake : std::false_type {};
+
+template <typename E>
+struct hasTake<E, std::void_t<decltype(std::declval<E &>().take())> > : std::true_type {};
+
+template <typename E>
+typename E::ResT takeResult(E & e) {
+  if constexpr(hasTake<E>::value) {
+    return e.take();
+  } else {
+    return e.get();
+  }
+}
+
+// Counts nodes per bucket, e.g. per depth, where KeyFn is a func mapping a node
+// to its bucket
+template <typename NodeType, typename KeyFn>
+struct HistogramEnumerator : StaticEnumerator<HistogramEnumerator<NodeType, KeyFn>, NodeType, std::vector<std::uint64_t> > {
+    std::vector<std::uint64_t> counts;
+
+    void accumulate(const NodeType & n) {
+      std::size_t k = KeyFn::invoke(n);
+      if (k >= counts.size()) {
+        counts.resize(k + 1, 0);
+      }
+      counts[k]++;
+    }
+
+    void combine(const std::vector<std::uint64_t> & other) {
+      if (other.size() > counts.size()) {
+        counts.resize(other.size(), 0);
+      }
+      for (auto i = 0; i < other.size(); ++i) {
+        counts[i] += other[i];
+      }
+    }
+
+    std::vector<std::uint64_t> get() { return counts; }
+    std::vector<std::uint64_t> take() { return std::move(counts); }
+};
+
+// Best value seen, and a node with that value
+template <typename NodeType, typename Value>
+struct Witness {
+    bool found = false;
+    Value value;
+    NodeType node;
+
+    template <class Archive>
+    void serialize(Archive & ar, const unsigned int version) {
+      ar & found;
+      ar & value;
+      ar & node;
+    }
+};
+
+// Minimum (or with Cmp = std::greater, maximum) of ValueFn over the nodes,
+// with a witness node
+template <typename NodeType, typename ValueFn, typename Cmp = std::less<typename ValueFn::return_type> >
+struct MinMaxEnumerator : StaticEnumerator<MinMaxEnumerator<NodeType, ValueFn, Cmp>, NodeType,
+                                           Witness<NodeType, typename ValueFn::return_type> > {
+    using Value = typename ValueFn::return_type;
+    Witness<NodeType, Value> best;
+
+    void accumulate(const NodeType & n) {
+      auto v = ValueFn::invoke(n);
+      if (!best.found || Cmp()(v, best.value)) {
+        best.found = true;
+        best.value = v;
+        best.node = n;
+      }
+    }
+
+    void combine(const Witness<NodeType, Value> & other) {
+      if (other.found && (!best.found || Cmp()(other.value, best.value))) {
+        best = other;
+      }
+    }
+
+    Witness<NodeType, Value> get() { return best; }
+    Witness<NodeType, Value> take() { return std::move(best); }
+};
+
+// A uniform random sample of (at most) K nodes, and how many nodes it was
+// drawn from
+template <typename NodeType>
+struct Sample {
+    std::uint64_t seen = 0;
+    std::vector<NodeType> nodes;
+
+    template <class Archive>
+    void serialize(Archive & ar, const unsigned int version) {
+      ar & seen;
+      ar & nodes;
+    }
+};
+
+// Reservoir sampling. Samples from different tasks are merged by drawing
+// without replacement from each in proportion to the nodes they represent
+template <typename NodeType, unsigned K>
+struct SampleEnumerator : StaticEnumerator<SampleEnumerator<NodeType, K>, NodeType, Sample<NodeType> > {
+    Sample<NodeType> sample;
+
+    static std::mt19937 & rng() {
+      thread_local std::mt19937 gen(std::random_device{}());
+      return gen;
+    }
+
+    void accumulate(const NodeType & n) {
+      sample.seen++;
+      if (sample.nodes.size() < K) {
+        sample.nodes.push_back(n);
+        return;
+      }
+      std::uniform_int_distribution<std::uint64_t> pick(0, sample.seen - 1);
+      auto i = pick(rng());
+      if (i < K) {
+        sample.nodes[i] = n;
+      }
+    }
+
+    void combine(Sample<NodeType> && other) {
+      if (other.seen == 0) {
+        return;
+      }
+      if (sample.seen == 0) {
+        sample = std::move(other);
+        return;
+      }
+
+      auto & a = sample.nodes;
+      auto & b = other.nodes;
+      std::shuffle(a.begin(), a.end(), rng());
+      std::shuffle(b.begin(), b.end(), rng());
+
+      // Nodes not yet drawn that each side represents
+      auto na = sample.seen;
+      auto nb = other.seen;
+      std::size_t ai = 0, bi = 0;
+      std::vector<NodeType> merged;
+      while (merged.size() < K && (ai < a.size() || bi < b.size())) {
+        std::uniform_int_distribution<std::uint64_t> side(0, na + nb - 1);
+        auto fromA = bi == b.size() || (ai < a.size() && side(rng()) < na);
+        if (fromA) {
+          merged.push_back(std::move(a[ai++]));
+          na--;
+        } else {
+          merged.push_back(std::move(b[bi++]));
+          nb--;
+        }
+      }
+
+      sample.seen += other.seen;
+      sample.nodes = std::move(merged);
+    }
+
+    void combine(const Sample<NodeType> & other) {
+      combine(Sample<NodeType>(other));
+    }
+
+    Sample<NodeType> get() { return sample; }
+    Sample<NodeType> take() { return std::move(sample); }
 };
 
 } // Namespace YewPar
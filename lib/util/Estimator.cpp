@@ -0,0 +1,64 @@
+#include "Estimator.hpp"
+
+#include <chrono>
+
+#include <boost/format.hpp>
+
+#include <hpx/hpx.hpp>
+#include <hpx/include/iostreams.hpp>
+#include <hpx/lcos/local/condition_variable.hpp>
+#include <hpx/lcos/local/mutex.hpp>
+
+namespace YewPar { namespace Estimator {
+
+void reset() {
+  for (auto & d : detail::depths) {
+    d.sum = 0.0;
+    d.samples = 0;
+  }
+}
+
+static hpx::lcos::local::mutex mtx;
+static hpx::lcos::local::condition_variable finished_cv;
+static bool reporting = false;
+static hpx::future<void> reporter;
+
+static void report(const std::uint64_t interval) {
+  std::unique_lock<hpx::lcos::local::mutex> l(mtx);
+  while (reporting) {
+    finished_cv.wait_for(l, std::chrono::milliseconds(interval));
+    if (!reporting) {
+      return;
+    }
+
+    l.unlock();
+    hpx::cout << (boost::format("Progress: %.1f%% of ~%d nodes\n")
+                  % (100.0 * progress()) % static_cast<std::uint64_t>(treeEstimate())) << hpx::flush;
+    l.lock();
+  }
+}
+
+void startReport(const std::uint64_t interval) {
+  if (interval == 0 || treeEstimate() <= 0.0) {
+    return;
+  }
+
+  {
+    std::lock_guard<hpx::lcos::local::mutex> l(mtx);
+    reporting = true;
+  }
+  reporter = hpx::async(&report, interval);
+}
+
+void stopReport() {
+  {
+    std::lock_guard<hpx::lcos::local::mutex> l(mtx);
+    reporting = false;
+    finished_cv.notify_all();
+  }
+  if (reporter.valid()) {
+    reporter.get();
+  }
+}
+
+}}
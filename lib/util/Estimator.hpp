@@ -0,0 +1,232 @@
+#ifndef YEWPAR_ESTIMATOR_HPP
+#define YEWPAR_ESTIMATOR_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <vector>
+
+#include <hpx/lcos/broadcast.hpp>
+#include <hpx/runtime/actions/plain_action.hpp>
+#include <hpx/runtime/find_all_localities.hpp>
+
+#include "Anytime.hpp"
+#include "skeletons/API.hpp"
+
+namespace YewPar { namespace Estimator {
+
+// Online subtree size estimation using Knuth's estimator [1]: walk from a node
+// towards a leaf choosing a uniformly random child at each step. If the nodes
+// on the walk have b_0, b_1, ... children then b_0 * ... * b_(d-1) is an
+// unbiased estimate of the number of nodes d levels below the start. The
+// variance is high, so estimates average several probes.
+//
+// Bounds change as the search runs so probes don't prune. For optimisation
+// problems the estimates are of the unpruned tree, and so are upper bounds.
+//
+// [1] D. E. Knuth. Estimating the efficiency of backtrack programs.
+//     Mathematics of Computation 29(129), 1975.
+
+// Running mean number of nodes at each depth (relative to where probes start)
+class DepthEstimates {
+ private:
+  std::vector<double> sums;
+  std::uint64_t probes = 0;
+
+ public:
+  void add(const std::vector<double> & probe) {
+    if (probe.size() > sums.size()) {
+      sums.resize(probe.size(), 0.0);
+    }
+    for (auto i = 0; i < probe.size(); ++i) {
+      sums[i] += probe[i];
+    }
+    ++probes;
+  }
+
+  std::uint64_t numProbes() const {
+    return probes;
+  }
+
+  unsigned maxDepth() const {
+    return sums.size();
+  }
+
+  double atDepth(const unsigned d) const {
+    if (probes == 0 || d >= sums.size()) {
+      return 0.0;
+    }
+    return sums[d] / probes;
+  }
+
+  double total() const {
+    if (probes == 0) {
+      return 0.0;
+    }
+    return std::accumulate(sums.begin(), sums.end(), 0.0) / probes;
+  }
+};
+
+// Each worker has its own random source
+inline std::mt19937 & threadRng() {
+  thread_local std::mt19937 rng(std::random_device{}());
+  return rng;
+}
+
+// A single random probe from n, going at most maxDepth levels down
+template <typename Generator>
+std::vector<double> probe(const typename Generator::Spacetype & space,
+                          const typename Generator::Nodetype & n,
+                          const unsigned maxDepth,
+                          std::mt19937 & rng) {
+  std::vector<double> widths { 1.0 };
+  auto node = n;
+  double width = 1.0;
+
+  for (auto d = 0; d < maxDepth; ++d) {
+    Generator gen(space, node);
+    if (gen.numChildren == 0) {
+      break;
+    }
+
+    width *= gen.numChildren;
+    widths.push_back(width);
+
+    std::uniform_int_distribution<int> pick(0, gen.numChildren - 1);
+    for (auto k = pick(rng); k > 0; --k) {
+      gen.next();
+    }
+    node = gen.next();
+  }
+
+  return widths;
+}
+
+template <typename Generator>
+DepthEstimates estimate(const typename Generator::Spacetype & space,
+                        const typename Generator::Nodetype & n,
+                        const unsigned maxDepth,
+                        const unsigned probes,
+                        std::mt19937 & rng = threadRng()) {
+  DepthEstimates est;
+  for (auto i = 0; i < probes; ++i) {
+    est.add(probe<Generator>(space, n, maxDepth, rng));
+  }
+  return est;
+}
+
+// Probes never go further than this below their start, and a depth stops
+// being probed once it has this many samples (see subtreeSize)
+static constexpr unsigned maxProbeDepth = 64;
+static constexpr std::uint64_t samplesPerDepth = 32;
+static constexpr unsigned maxTrackedDepth = 256;
+
+// Online estimates, per locality: the running mean estimated size of subtrees
+// rooted at each depth. Depths are those tasks are created with by the
+// skeleton asking
+namespace detail {
+struct DepthSamples {
+  std::atomic<double> sum {0.0};
+  std::atomic<std::uint64_t> samples {0};
+};
+inline DepthSamples depths[maxTrackedDepth];
+}
+
+inline void record(const unsigned depth, const double nodes) {
+  if (depth >= maxTrackedDepth) {
+    return;
+  }
+  auto & d = detail::depths[depth];
+  auto sum = d.sum.load();
+  while (!d.sum.compare_exchange_weak(sum, sum + nodes)) {}
+  d.samples++;
+}
+
+inline std::uint64_t samples(const unsigned depth) {
+  return depth < maxTrackedDepth ? detail::depths[depth].samples.load() : 0;
+}
+
+// Mean estimated subtree size at depth, negative if there are no samples yet
+inline double meanSubtreeSize(const unsigned depth) {
+  auto n = samples(depth);
+  if (n == 0) {
+    return -1.0;
+  }
+  return detail::depths[depth].sum.load() / n;
+}
+
+// Estimated size of the subtree below n, created at depth. n is probed (and
+// its depth's estimate refined) until the depth has samplesPerDepth samples,
+// after which the depth's mean is used, so the cost of probing is bounded
+template <typename Generator, typename Bound>
+double subtreeSize(const typename Generator::Spacetype & space,
+                   const typename Generator::Nodetype & n,
+                   const unsigned depth,
+                   const Skeletons::API::Params<Bound> & params) {
+  if (params.estimatorProbes == 0) {
+    return -1.0;
+  }
+  if (samples(depth) >= samplesPerDepth) {
+    return meanSubtreeSize(depth);
+  }
+
+  auto below = params.maxDepth > depth ? params.maxDepth - depth : 0;
+  auto est = estimate<Generator>(space, n, std::min(below, maxProbeDepth), params.estimatorProbes).total();
+  record(depth, est);
+  return est;
+}
+
+// Should a subtree created at depth stay with the worker that has it rather
+// than be given away? Only once its depth has an estimate below minTaskNodes
+template <typename Bound>
+bool keepLocal(const unsigned depth, const Skeletons::API::Params<Bound> & params) {
+  if (params.minTaskNodes == 0 || params.estimatorProbes == 0) {
+    return false;
+  }
+  auto est = meanSubtreeSize(depth);
+  return est >= 0.0 && est < params.minTaskNodes;
+}
+
+// Clears the online estimates (on this locality) ready for a new search
+void reset();
+HPX_DEFINE_PLAIN_ACTION(reset, reset_act);
+
+// Whole tree estimate, used for progress reporting on the master locality
+namespace detail {
+inline std::atomic<double> treeEstimate(0.0);
+}
+
+inline void setTreeEstimate(const double nodes) {
+  detail::treeEstimate.store(nodes);
+}
+
+inline double treeEstimate() {
+  return detail::treeEstimate.load();
+}
+
+// Estimated fraction (0-1) of the tree searched so far. Only meaningful once
+// setTreeEstimate has been called and while nodes are being counted (see
+// Params::estimatorProbes)
+inline double progress() {
+  auto est = treeEstimate();
+  if (est <= 0.0) {
+    return 0.0;
+  }
+
+  auto ns = hpx::lcos::broadcast<Anytime::getNodes_act>(hpx::find_all_localities()).get();
+  auto nodes = std::accumulate(ns.begin(), ns.end(), std::uint64_t(0));
+  return std::min(1.0, nodes / est);
+}
+
+// Print progress() every interval milliseconds (on the master locality) until
+// stopReport is called
+void startReport(const std::uint64_t interval);
+
+// Must be called once the search has finished
+void stopReport();
+
+}}
+
+#endif
@@ -3,12 +3,17 @@
 
 #include <functional>
 #include <memory>
+#include <vector>
 
 #include <hpx/include/components.hpp>
 #include <hpx/include/iostreams.hpp>
 
 #include <boost/format.hpp>
 
+#include <hpx/util/tuple.hpp>
+
+#include "SolutionSet.hpp"
+
 namespace YewPar {
 
 struct Incumbent : public hpx::components::locking_hook<
@@ -45,6 +50,13 @@ struct Incumbent : public hpx::components::locking_hook<
     Node incumbentNode;
     Bound bnd;
 
+    // Only used when collecting more than a single solution
+    SolutionSet<Node, Bound, Cmp> solutions;
+
+    // Called with each improved incumbent. Runs while the component is locked
+    // so should return quickly
+    std::function<void(const Node &)> callback;
+
   public:
     void initialiseIncumbent(Node n, Bound b) {
       incumbentNode = n;
@@ -59,12 +71,46 @@ struct Incumbent : public hpx::components::locking_hook<
         if constexpr(verbose >= 1) {
           hpx::cout << (boost::format("New Incumbent Bound: %1%\n") % incumbentNode.getObj()) << hpx::flush;
         }
+        if (callback) {
+          callback(incumbentNode);
+        }
       }
     }
 
+    void setCallback(std::function<void(const Node &)> cb) {
+      callback = std::move(cb);
+    }
+
     Node getIncumbent() const {
       return incumbentNode;
     }
+
+    void initialiseSolutions(unsigned k, Bound b) {
+      solutions = SolutionSet<Node, Bound, Cmp>(k, b);
+    }
+
+    // Returns whether the pruning bound changed, and its new value
+    hpx::util::tuple<bool, Bound> addSolution(Node n) {
+      auto changed = solutions.add(n);
+      Cmp cmp;
+      if (!solutions.solutions().empty() &&
+          cmp(solutions.solutions().front().getObj(), incumbentNode.getObj())) {
+        incumbentNode = solutions.solutions().front();
+        if (callback) {
+          callback(incumbentNode);
+        }
+      }
+      if constexpr(verbose >= 1) {
+        if (changed) {
+          hpx::cout << (boost::format("New Solutions Bound: %1%\n") % solutions.bound()) << hpx::flush;
+        }
+      }
+      return hpx::util::make_tuple(changed, solutions.bound());
+    }
+
+    std::vector<Node> getSolutions() const {
+      return solutions.solutions();
+    }
   };
 
   template<typename Node, typename Bound, typename Cmp, typename Verbose>
@@ -81,6 +127,14 @@ struct Incumbent : public hpx::components::locking_hook<
     cmp->updateIncumbent(incumbent);
   }
 
+  // Local only (callbacks can't be serialised), not exposed as an action
+  template<typename Node, typename Bound, typename Cmp, typename Verbose>
+  void setCallback(std::function<void(const Node &)> cb) {
+    auto p = ptr.get();
+    auto cmp = static_cast<Incumbent::IncumbentComp<Node, Bound, Cmp, Verbose>*>(p);
+    cmp->setCallback(std::move(cb));
+  }
+
   template<typename Node, typename Bound, typename Cmp, typename Verbose>
   Node getIncumbent() const {
     auto p = ptr.get();
@@ -88,6 +142,27 @@ struct Incumbent : public hpx::components::locking_hook<
     return cmp->getIncumbent();
   }
 
+  template<typename Node, typename Bound, typename Cmp, typename Verbose>
+  void initialiseSolutions(unsigned k, Bound b) {
+    auto p = ptr.get();
+    auto cmp = static_cast<Incumbent::IncumbentComp<Node, Bound, Cmp, Verbose>*>(p);
+    cmp->initialiseSolutions(k, b);
+  }
+
+  template<typename Node, typename Bound, typename Cmp, typename Verbose>
+  hpx::util::tuple<bool, Bound> addSolution(Node n) {
+    auto p = ptr.get();
+    auto cmp = static_cast<Incumbent::IncumbentComp<Node, Bound, Cmp, Verbose>*>(p);
+    return cmp->addSolution(n);
+  }
+
+  template<typename Node, typename Bound, typename Cmp, typename Verbose>
+  std::vector<Node> getSolutions() const {
+    auto p = ptr.get();
+    auto cmp = static_cast<Incumbent::IncumbentComp<Node, Bound, Cmp, Verbose>*>(p);
+    return cmp->getSolutions();
+  }
+
   template<typename Node, typename Bound, typename Cmp, typename Verbose>
   struct UpdateIncumbentAct : hpx::actions::make_action<
     decltype(&Incumbent::updateIncumbent<Node, Bound, Cmp, Verbose>),
@@ -105,6 +180,24 @@ struct Incumbent : public hpx::components::locking_hook<
     decltype(&Incumbent::getIncumbent<Node, Bound, Cmp, Verbose>),
     &Incumbent::getIncumbent<Node, Bound, Cmp, Verbose>,
     GetIncumbentAct<Node, Bound, Cmp, Verbose> >::type {};
+
+  template<typename Node, typename Bound, typename Cmp, typename Verbose>
+  struct InitialiseSolutionsAct : hpx::actions::make_action<
+    decltype(&Incumbent::initialiseSolutions<Node, Bound, Cmp, Verbose>),
+    &Incumbent::initialiseSolutions<Node, Bound, Cmp, Verbose>,
+    InitialiseSolutionsAct<Node, Bound, Cmp, Verbose> >::type {};
+
+  template<typename Node, typename Bound, typename Cmp, typename Verbose>
+  struct AddSolutionAct : hpx::actions::make_action<
+    decltype(&Incumbent::addSolution<Node, Bound, Cmp, Verbose>),
+    &Incumbent::addSolution<Node, Bound, Cmp, Verbose>,
+    AddSolutionAct<Node, Bound, Cmp, Verbose> >::type {};
+
+  template<typename Node, typename Bound, typename Cmp, typename Verbose>
+  struct GetSolutionsAct : hpx::actions::make_action<
+    decltype(&Incumbent::getSolutions<Node, Bound, Cmp, Verbose>),
+    &Incumbent::getSolutions<Node, Bound, Cmp, Verbose>,
+    GetSolutionsAct<Node, Bound, Cmp, Verbose> >::type {};
 };
 
 }
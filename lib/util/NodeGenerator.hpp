@@ -1,32 +1,163 @@
 #ifndef UTIL_LAZY_NODEGENERATOR_HPP
 #define UTIL_LAZY_NODEGENERATOR_HPP
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
 namespace YewPar {
 
 #include <hpx/util/tuple.hpp>
 
-template <typename NodeType, typename Space>
-struct NodeGenerator {
+// Statically dispatched generator interface (CRTP). Skeletons always call
+// next() on the concrete Generator type so deriving from this, rather than
+// NodeGenerator, lets child generation inline into the skeleton loops.
+//
+// Derived types must provide: NodeType next();
+template <typename Derived, typename NodeType, typename Space>
+struct StaticNodeGenerator {
   using Nodetype  = NodeType;
   using Spacetype = Space;
 
   unsigned numChildren;
 
-  // When called, return the next child element
-  // Pre condition: numChildren < number of next Calls
-  virtual NodeType next() = 0;
-
   // Quickly skip to the nth child if possible Useful for recompute based
   // skeletons where we send a path in the tree rather than a particular node
   NodeType nth(unsigned n) {
     NodeType c;
     for (auto i = 0; i <= n; ++i) {
-      c = next();
+      c = static_cast<Derived *>(this)->next();
     }
     return c;
   };
 };
 
+// Dynamically dispatched generator interface. Kept as an adapter for existing
+// generators, prefer StaticNodeGenerator for new code.
+template <typename NodeType, typename Space>
+struct NodeGenerator : StaticNodeGenerator<NodeGenerator<NodeType, Space>, NodeType, Space> {
+  // When called, return the next child element
+  // Pre condition: numChildren < number of next Calls
+  virtual NodeType next() = 0;
+};
+
+// Optional batched child generation. As well as next(), generators may provide
+//
+//   unsigned nextBatch(NodeType * out, unsigned n);
+//
+// which writes (at most) the next n children to out and returns how many were
+// written, leaving the generator as if that many next() calls had been made.
+// This allows all siblings to be computed in one pass with shared state.
+template <typename Generator, typename = void>
+struct hasNextBatch : std::false_type {};
+
+template <typename Generator>
+struct hasNextBatch<Generator, std::void_t<decltype(
+    std::declval<Generator &>().nextBatch(std::declval<typename Generator::Nodetype *>(), 0u))> >
+    : std::true_type {};
+
+// Pulls the (remaining) children of a generator, a chunk at a time with
+// nextBatch where the generator supports it (and nodes can be default
+// constructed for it to write to), and one at a time with next() otherwise.
+// Chunks live in the ChildBuffer itself (at most about 1KiB of nodes), so
+// nothing is allocated per expansion and a search that stops part way through
+// a level (e.g. a PruneLevel break) only generates a chunk it doesn't use.
+template <typename Generator>
+class ChildBuffer {
+ private:
+  using NodeType = typename Generator::Nodetype;
+
+  static constexpr bool batched =
+      hasNextBatch<Generator>::value && std::is_default_constructible<NodeType>::value;
+  static constexpr unsigned chunk =
+      std::max<std::size_t>(1, std::min<std::size_t>(8, 1024 / sizeof(NodeType)));
+
+  struct NoChunk {};
+
+  Generator & gen;
+  // Children not yet returned by next()
+  unsigned remaining;
+  std::conditional_t<batched, std::array<NodeType, chunk>, NoChunk> children;
+  unsigned pos = 0;
+  unsigned filled = 0;
+
+ public:
+  ChildBuffer(Generator & gen) : ChildBuffer(gen, gen.numChildren) {}
+
+  ChildBuffer(Generator & gen, unsigned remaining) : gen(gen), remaining(remaining) {}
+
+  NodeType next() {
+    assert(remaining > 0 && "ChildBuffer::next called with no children left");
+    --remaining;
+
+    if constexpr(batched) {
+      if (pos == filled) {
+        filled = gen.nextBatch(children.data(), std::min(chunk, remaining + 1));
+        pos = 0;
+        assert(filled > 0 && "nextBatch returned no children");
+      }
+      return std::move(children[pos++]);
+    } else {
+      return gen.next();
+    }
+  }
+};
+
+// Optional in-place expansion. Generators may also describe children as moves
+// applied to (and later undone from) a single mutable node:
+//
+//   using Movetype = ...;
+//   Movetype nextMove();
+//   static void apply(const Space & s, NodeType & n, const Movetype & m);
+//   static void undo(const Space & s, NodeType & n, const Movetype & m);
+//
+// nextMove() advances the generator exactly as next() would, and undo must
+// exactly reverse apply. Since work may be spawned from a generator while its
+// node is deeper in the tree, nextMove() must not inspect the node it was
+// constructed from.
+template <typename Generator, typename = void>
+struct isInPlaceGenerator : std::false_type {};
+
+template <typename Generator>
+struct isInPlaceGenerator<Generator, std::void_t<
+  typename Generator::Movetype,
+  decltype(std::declval<Generator &>().nextMove()),
+  decltype(Generator::apply(std::declval<const typename Generator::Spacetype &>(),
+                            std::declval<typename Generator::Nodetype &>(),
+                            std::declval<const typename Generator::Movetype &>())),
+  decltype(Generator::undo(std::declval<const typename Generator::Spacetype &>(),
+                           std::declval<typename Generator::Nodetype &>(),
+                           std::declval<const typename Generator::Movetype &>()))> >
+    : std::true_type {};
+
+// Applies a move to a node for the lifetime of the scope
+template <typename Generator>
+struct ScopedMove {
+  using Space = typename Generator::Spacetype;
+  using Node  = typename Generator::Nodetype;
+  using Move  = typename Generator::Movetype;
+
+  const Space & space;
+  Node & node;
+  const Move move;
+
+  ScopedMove(const Space & space, Node & node, const Move & move)
+      : space(space), node(node), move(move) {
+    Generator::apply(space, node, move);
+  }
+
+  ~ScopedMove() {
+    Generator::undo(space, node, move);
+  }
+
+  ScopedMove(const ScopedMove &) = delete;
+  ScopedMove & operator=(const ScopedMove &) = delete;
+};
+
 }
 
 #endif
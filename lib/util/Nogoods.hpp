@@ -0,0 +1,156 @@
+#ifndef YEWPAR_NOGOODS_HPP
+#define YEWPAR_NOGOODS_HPP
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <hpx/lcos/broadcast.hpp>
+#include <hpx/lcos/local/mutex.hpp>
+#include <hpx/runtime/actions/plain_action.hpp>
+#include <hpx/runtime/find_all_localities.hpp>
+#include <hpx/runtime/serialization/vector.hpp>
+
+namespace YewPar { namespace Nogoods {
+
+// Nogoods are canonical keys of nodes whose subtrees are known to hold nothing
+// of interest: no solution (Decision) or nothing better than the incumbent at
+// the time (Optimisation, where the incumbent only improves so a nogood stays
+// valid). Any node with the same key as a nogood can be pruned.
+//
+// KeyFn is a func mapping a node to its key. Nodes with equal keys must have
+// equivalent subtrees, e.g. the same remaining candidates and depth, so the key
+// should capture everything the generator depends on. Keys need std::hash,
+// operator== and (for sharing between localities) serialize.
+//
+// Each locality has its own store, split into shards to keep workers from
+// contending. Shards are capped: a full shard is emptied, which only loses
+// pruning opportunities. New nogoods are batched and sent to the other
+// localities every exchangeBatch insertions.
+template <typename KeyFn>
+struct Store {
+  using Key = typename KeyFn::return_type;
+  using MutexT = hpx::lcos::local::mutex;
+
+  static constexpr unsigned numShards = 64;
+
+  struct Shard {
+    MutexT mtx;
+    std::unordered_set<Key> keys;
+  };
+
+  static inline std::array<Shard, numShards> shards;
+  static inline std::size_t shardCapacity = 1;
+
+  static inline bool exchange = false;
+  static inline unsigned exchangeBatch = 0;
+  static inline MutexT outboxMtx;
+  static inline std::vector<Key> outbox;
+
+  static inline std::atomic<std::uint64_t> hits {0};
+
+  static Shard & shardFor(const Key & k) {
+    // Fibonacci hashing, so the shard doesn't depend on the same low bits the
+    // shard's own table uses
+    std::uint64_t h = std::hash<Key>()(k);
+    return shards[(h * 0x9E3779B97F4A7C15ull) >> 58];
+  }
+
+  static void init(std::uint64_t capacity, unsigned batch) {
+    for (auto & s : shards) {
+      std::lock_guard<MutexT> l(s.mtx);
+      s.keys.clear();
+    }
+    shardCapacity = std::max<std::uint64_t>(capacity / numShards, 1);
+
+    exchangeBatch = batch;
+    exchange = batch > 0 && hpx::find_all_localities().size() > 1;
+    {
+      std::lock_guard<MutexT> l(outboxMtx);
+      outbox.clear();
+    }
+
+    hits = 0;
+  }
+  struct InitAct : hpx::actions::make_action<decltype(&init), &init, InitAct>::type {};
+
+  static bool contains(const Key & k) {
+    auto & s = shardFor(k);
+    std::lock_guard<MutexT> l(s.mtx);
+    if (s.keys.find(k) != s.keys.end()) {
+      hits++;
+      return true;
+    }
+    return false;
+  }
+
+  static bool insertLocal(const Key & k) {
+    auto & s = shardFor(k);
+    std::lock_guard<MutexT> l(s.mtx);
+    if (s.keys.size() >= shardCapacity) {
+      s.keys.clear();
+    }
+    return s.keys.insert(k).second;
+  }
+
+  static void receive(std::vector<Key> keys) {
+    for (const auto & k : keys) {
+      insertLocal(k);
+    }
+  }
+  struct ReceiveAct : hpx::actions::make_action<decltype(&receive), &receive, ReceiveAct>::type {};
+
+  static void send(const std::vector<Key> & keys) {
+    for (const auto & l : hpx::find_remote_localities()) {
+      hpx::apply<ReceiveAct>(l, keys);
+    }
+  }
+
+  // Record a nogood (from any worker)
+  static void add(const Key & k) {
+    if (!insertLocal(k) || !exchange) {
+      return;
+    }
+
+    std::vector<Key> batch;
+    {
+      std::lock_guard<MutexT> l(outboxMtx);
+      outbox.push_back(k);
+      if (outbox.size() < exchangeBatch) {
+        return;
+      }
+      batch.swap(outbox);
+    }
+    send(batch);
+  }
+
+  // Number of nodes pruned by this locality's store
+  static std::uint64_t getHits() {
+    return hits;
+  }
+  struct GetHitsAct : hpx::actions::make_action<decltype(&getHits), &getHits, GetHitsAct>::type {};
+
+  // Start a new search on every locality
+  static void start(std::uint64_t capacity, unsigned batch) {
+    hpx::wait_all(hpx::lcos::broadcast<InitAct>(hpx::find_all_localities(), capacity, batch));
+  }
+
+  static std::uint64_t totalHits() {
+    auto hs = hpx::lcos::broadcast<GetHitsAct>(hpx::find_all_localities()).get();
+    std::uint64_t total = 0;
+    for (auto h : hs) {
+      total += h;
+    }
+    return total;
+  }
+};
+
+}}
+
+#endif
@@ -6,14 +6,22 @@
 #include <cstdint>
 #include <iterator>
 #include <memory>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 #include <hpx/runtime/actions/basic_action.hpp>
+#include <hpx/lcos/broadcast.hpp>
+#include <hpx/runtime/find_localities.hpp>
 #include <hpx/traits/action_stacksize.hpp>
 #include <hpx/lcos/local/mutex.hpp>
 
 #include "skeletons/API.hpp"
 #include "Enumerator.hpp"
+#include "TerminationDetection.hpp"
+#include "func.hpp"
+#include "workstealing/policies/Policy.hpp"
+#include "workstealing/SchedulerPerf.hpp"
 
 namespace YewPar {
 
@@ -31,6 +39,27 @@ struct Registry {
   std::atomic<Bound> localBound;
   hpx::naming::id_type globalIncumbent;
 
+  // Anytime optimisation (master locality only): how far the incumbent may be
+  // from optimal once the search ends, 0 if the search proved it optimal. Only
+  // set for numeric bounds with a BoundFunction
+  Bound boundGap {};
+
+  // Anytime optimisation: best bound of the nodes this locality left
+  // unexplored when the budget stopped the search. Under mtx
+  bool anyOpen = false;
+  Bound openBound {};
+
+  // Budget skeleton, adaptive backtrack budgets. One per worker, along with the
+  // worker's scheduler counters when it last adapted its budget. Only the
+  // worker itself touches its entry
+  struct alignas(64) WorkerBudget {
+    unsigned budget;
+    std::uint64_t failedGets;
+    std::uint64_t busy;
+    std::uint64_t tasks;
+  };
+  std::unique_ptr<WorkerBudget[]> workerBudgets;
+
   // Decision problems
   std::atomic<bool> stopSearch {false};
   hpx::naming::id_type foundPromiseId;
@@ -50,13 +79,37 @@ struct Registry {
     this->root = root;
     this->params = params;
     this->localBound = params.initialBound;
+    this->boundGap = Bound();
+    this->resetOpen();
+    this->stopSearch = false;
+    resetWorkerBudgets(params.backtrackBudget);
     this->acc = Enumerator();
   }
 
+  void resetWorkerBudgets(const unsigned budget) {
+    auto n = Workstealing::SchedulerPerf::numWorkers() + 1;
+    workerBudgets.reset(new WorkerBudget[n]);
+    auto failedGets = Workstealing::SchedulerPerf::localFailedGets();
+    for (auto i = 0u; i < n; ++i) {
+      auto & c = Workstealing::SchedulerPerf::workerCounters(i);
+      workerBudgets[i] = {budget, failedGets, c.busy.load(), c.tasks.load()};
+    }
+  }
+
+  // The calling worker's budget
+  WorkerBudget & workerBudget() {
+    auto w = hpx::get_worker_thread_num();
+    auto n = Workstealing::SchedulerPerf::numWorkers();
+    return workerBudgets[w < n ? w : n];
+  }
+
   // Counting
+  // The result is taken (moved out where the enumerator supports it) before
+  // locking, so the lock is only held to combine it
   void updateEnumerator(Enumerator & e) {
+    auto res = takeResult(e);
     std::lock_guard<MutexT> l(mtx);
-    acc.combine(e.get());
+    acc.combine(std::move(res));
   }
 
   using ResT = typename Enumerator::ResT;
@@ -64,6 +117,12 @@ struct Registry {
     return acc.get();
   }
 
+  // As getEnumeratorVal, but moves the result out. Only once the search is over
+  ResT takeEnumeratorVal() {
+    std::lock_guard<MutexT> l(mtx);
+    return takeResult(acc);
+  }
+
   // BNB
   template <typename Cmp>
   void updateRegistryBound(Bound bnd) {
@@ -80,8 +139,46 @@ struct Registry {
     }
   }
 
+  // Cancels the search on this locality: queued tasks are dropped and anything
+  // waiting for the search to terminate is released
   void setStopSearchFlag() {
     stopSearch.store(true);
+    Termination::cancel();
+    if (Workstealing::Scheduler::local_policy) {
+      Workstealing::Scheduler::local_policy->cancel();
+    }
+  }
+
+  // Stops the search once its budget is spent. Queued tasks aren't dropped:
+  // they still run, but only record their roots with recordOpen and finish,
+  // so termination is detected as usual
+  void setBudgetStopFlag() {
+    stopSearch.store(true);
+  }
+
+  template <typename Cmp>
+  void recordOpen(const Bound & bnd) {
+    std::lock_guard<MutexT> l(mtx);
+    Cmp cmp;
+    if (!anyOpen || cmp(bnd, openBound)) {
+      openBound = bnd;
+      anyOpen = true;
+    }
+  }
+
+  void resetOpen() {
+    std::lock_guard<MutexT> l(mtx);
+    anyOpen = false;
+    openBound = Bound();
+  }
+
+  // Empty if nothing was left open
+  std::vector<Bound> getOpenBound() {
+    std::lock_guard<MutexT> l(mtx);
+    if (anyOpen) {
+      return {openBound};
+    }
+    return {};
   }
 
 };
@@ -106,6 +203,67 @@ template <typename Space, typename Node, typename Bound, typename Enumerator>
 struct GetEnumeratorValAct : hpx::actions::make_direct_action<
   decltype(&getEnumeratorVal<Space, Node, Bound, Enumerator>), &getEnumeratorVal<Space, Node, Bound, Enumerator>, GetEnumeratorValAct<Space, Node, Bound, Enumerator> >::type {};
 
+template <typename Space, typename Node, typename Bound, typename Enumerator>
+typename Enumerator::ResT takeEnumeratorVal() {
+  return Registry<Space, Node, Bound, Enumerator>::gReg->takeEnumeratorVal();
+}
+template <typename Space, typename Node, typename Bound, typename Enumerator>
+struct TakeEnumeratorValAct : hpx::actions::make_direct_action<
+  decltype(&takeEnumeratorVal<Space, Node, Bound, Enumerator>), &takeEnumeratorVal<Space, Node, Bound, Enumerator>, TakeEnumeratorValAct<Space, Node, Bound, Enumerator> >::type {};
+
+template <typename Space, typename Node, typename Bound, typename Enumerator>
+std::vector<Bound> getOpenBound() {
+  return Registry<Space, Node, Bound, Enumerator>::gReg->getOpenBound();
+}
+template <typename Space, typename Node, typename Bound, typename Enumerator>
+struct GetOpenBoundAct : hpx::actions::make_direct_action<
+  decltype(&getOpenBound<Space, Node, Bound, Enumerator>), &getOpenBound<Space, Node, Bound, Enumerator>, GetOpenBoundAct<Space, Node, Bound, Enumerator> >::type {};
+
+// When the budget runs out the skeletons record the bounds of the nodes left
+// unexplored: the children still on generator stacks, the roots of tasks that
+// never ran, etc. Anything better than the incumbent lies below one of them, so
+// the best of their bounds limits how far from optimal the incumbent can be.
+//
+// For an exhausted search a gap of 0 means nothing left open could beat the
+// incumbent, i.e. it was already optimal (but not necessarily proved so by the
+// time the budget ran out). A search that ran to completion proved its
+// incumbent optimal, so its gap is always 0. Called once the search has
+// terminated, on the master locality. Sequential searches only record open
+// nodes on this locality so don't need to ask the others
+template<typename Space, typename Node, typename Bound, typename Enum, typename Cmp, typename BoundFn>
+static void recordBoundGap(const Bound & incumbent, const bool exhausted, const bool distributed = true) {
+  if constexpr(std::is_arithmetic<Bound>::value && !std::is_same<BoundFn, nullFn__>::value) {
+    auto reg = Registry<Space, Node, Bound, Enum>::gReg;
+    reg->boundGap = Bound();
+    if (!exhausted) {
+      return;
+    }
+
+    Cmp cmp;
+    std::vector<std::vector<Bound> > opens;
+    if (distributed) {
+      opens = hpx::lcos::broadcast<GetOpenBoundAct<Space, Node, Bound, Enum> >(
+          hpx::find_all_localities()).get();
+    } else {
+      opens.push_back(reg->getOpenBound());
+    }
+    for (const auto & open : opens) {
+      for (const auto & bnd : open) {
+        if (cmp(bnd, incumbent)) {
+          auto gap = bnd > incumbent ? bnd - incumbent : incumbent - bnd;
+          reg->boundGap = std::max(reg->boundGap, gap);
+        }
+      }
+    }
+  }
+}
+
+// Bound gap of the last (optimisation) search, on the master locality
+template <typename Space, typename Node, typename Bound, typename Enumerator = IdentityEnumerator<Node> >
+Bound getBoundGap() {
+  return Registry<Space, Node, Bound, Enumerator>::gReg->boundGap;
+}
+
 template <typename Space, typename Node, typename Bound, typename Enumerator>
 void setStopSearchFlag() {
   Registry<Space, Node, Bound, Enumerator>::gReg->setStopSearchFlag();
@@ -114,6 +272,14 @@ template <typename Space, typename Node, typename Bound, typename Enumerator>
 struct SetStopFlagAct : hpx::actions::make_direct_action<
   decltype(&setStopSearchFlag<Space, Node, Bound, Enumerator>), &setStopSearchFlag<Space, Node, Bound, Enumerator>, SetStopFlagAct<Space, Node, Bound, Enumerator> >::type {};
 
+template <typename Space, typename Node, typename Bound, typename Enumerator>
+void setBudgetStopFlag() {
+  Registry<Space, Node, Bound, Enumerator>::gReg->setBudgetStopFlag();
+}
+template <typename Space, typename Node, typename Bound, typename Enumerator>
+struct SetBudgetStopAct : hpx::actions::make_direct_action<
+  decltype(&setBudgetStopFlag<Space, Node, Bound, Enumerator>), &setBudgetStopFlag<Space, Node, Bound, Enumerator>, SetBudgetStopAct<Space, Node, Bound, Enumerator> >::type {};
+
 template <typename Space, typename Node, typename Bound, typename Enumerator, typename Cmp>
 void updateRegistryBound(Bound bnd) {
   auto reg = Registry<Space, Node, Bound, Enumerator>::gReg;
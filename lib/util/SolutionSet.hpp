@@ -0,0 +1,90 @@
+#ifndef YEWPAR_SOLUTIONSET_HPP
+#define YEWPAR_SOLUTIONSET_HPP
+
+#include <algorithm>
+#include <vector>
+
+namespace YewPar {
+
+// Collects the k best solutions of an optimisation search, or when k == 0
+// every solution tied with the optimum. Solutions are kept best first.
+//
+// Pruning must then be done against bound() rather than the best objective:
+// with k > 0 it is the k-th best objective (once k solutions are known) and
+// nodes that can't beat it are pruned. When collecting ties it is the best
+// objective, and only nodes that are strictly worse can be pruned.
+template <typename Node, typename Bound, typename Cmp>
+class SolutionSet {
+ private:
+  unsigned k;
+  Bound initialBound;
+  std::vector<Node> sols;
+
+ public:
+  SolutionSet() : k(1), initialBound() {}
+  SolutionSet(unsigned k, Bound initialBound) : k(k), initialBound(initialBound) {}
+
+  bool collectTies() const {
+    return k == 0;
+  }
+
+  Bound bound() const {
+    if (collectTies()) {
+      return sols.empty() ? initialBound : sols.front().getObj();
+    }
+    return sols.size() < k ? initialBound : sols.back().getObj();
+  }
+
+  const std::vector<Node> & solutions() const {
+    return sols;
+  }
+
+  // Should a node with (upper) bound bnd be pruned given the current bound
+  static bool prune(const Bound & bnd, const Bound & current, const bool collectTies) {
+    Cmp cmp;
+    return collectTies ? cmp(current, bnd) : !cmp(bnd, current);
+  }
+
+  // Is a solution with objective obj worth adding given the current bound
+  static bool improves(const Bound & obj, const Bound & current, const bool collectTies) {
+    Cmp cmp;
+    return collectTies ? !cmp(current, obj) : cmp(obj, current);
+  }
+
+  // Returns true if the bound changed as a result of adding n
+  bool add(const Node & n) {
+    Cmp cmp;
+    const auto obj = n.getObj();
+    const auto before = bound();
+
+    // Nothing is a solution unless it beats the initial bound
+    if (!cmp(obj, initialBound)) {
+      return false;
+    }
+
+    if (collectTies()) {
+      if (sols.empty() || cmp(obj, sols.front().getObj())) {
+        sols.clear();
+        sols.push_back(n);
+      } else if (obj == sols.front().getObj()) {
+        sols.push_back(n);
+      }
+    } else {
+      auto pos = std::upper_bound(sols.begin(), sols.end(), obj,
+                                  [](const Bound & o, const Node & s) { Cmp cmp; return cmp(o, s.getObj()); });
+      if (pos == sols.end() && sols.size() == k) {
+        return false;
+      }
+      sols.insert(pos, n);
+      if (sols.size() > k) {
+        sols.pop_back();
+      }
+    }
+
+    return bound() != before;
+  }
+};
+
+}
+
+#endif
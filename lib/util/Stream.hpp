@@ -0,0 +1,220 @@
+#ifndef YEWPAR_STREAM_HPP
+#define YEWPAR_STREAM_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <hpx/lcos/broadcast.hpp>
+#include <hpx/runtime/actions/plain_action.hpp>
+#include <hpx/runtime/get_locality_id.hpp>
+#include <hpx/runtime/get_os_thread_count.hpp>
+#include <hpx/runtime/get_worker_thread_num.hpp>
+#include <hpx/runtime/naming/name.hpp>
+
+#include "Enumerator.hpp"
+
+namespace YewPar { namespace Stream {
+
+// Streaming search results. Rather than folding the nodes we want (e.g. every
+// solution) into one enumerator value that has to be gathered on the master,
+// each worker appends them to its own buffer in a sink, which is drained
+// whenever it fills up. Only the number of streamed nodes goes through the
+// enumerator.
+//
+// Full buffers are drained by the worker that filled them, so a slow sink slows
+// the search down rather than letting buffers grow: no more than BatchSize
+// nodes per worker are ever held in memory.
+//
+// Sinks are per locality and must be started (on every locality) before the
+// search and finished after it:
+//
+//   Sink::start(...);
+//   Skeleton<..., API::Enumerator<StreamEnumerator<Node, Pred, Sink>>>::search(...);
+//   Sink::finish(...);
+
+// Per worker buffers shared by the sinks below. Drain is called with full (or,
+// when finishing, partly full) buffers as drain(worker, nodes)
+template <typename NodeType, typename Drain, std::size_t BatchSize>
+struct WorkerBuffers {
+  static inline std::vector<std::vector<NodeType> > buffers;
+
+  static void open() {
+    buffers.clear();
+    buffers.resize(hpx::get_os_thread_count());
+    for (auto & b : buffers) {
+      b.reserve(BatchSize);
+    }
+  }
+
+  static void put(const NodeType & n) {
+    auto w = hpx::get_worker_thread_num();
+    auto & buf = buffers[w];
+    buf.push_back(n);
+    if (buf.size() >= BatchSize) {
+      drain(w, buf);
+    }
+  }
+
+  // Swapped out before draining in case the drain suspends and another task on
+  // this worker adds to the buffer
+  static void drain(std::size_t w, std::vector<NodeType> & buf) {
+    std::vector<NodeType> batch;
+    batch.reserve(BatchSize);
+    batch.swap(buf);
+    Drain::drain(w, batch);
+  }
+
+  static void drainAll() {
+    for (auto w = 0u; w < buffers.size(); ++w) {
+      if (!buffers[w].empty()) {
+        drain(w, buffers[w]);
+      }
+    }
+  }
+};
+
+// Writes each node as a line of text (from the func Format: std::string(const
+// NodeType &)). Every worker writes its own part file, named
+// "<file>.<locality>.<worker>", and finish concatenates the parts into <file> in
+// (locality, worker) order. On more than one locality the parts must be on a
+// shared filesystem for the merge.
+template <typename NodeType, typename Format, std::size_t BatchSize = 4096>
+struct FileSink {
+  static inline std::string file;
+  static inline std::vector<std::ofstream> parts;
+
+  static std::string partName(const std::string & f, std::uint32_t locality, std::size_t worker) {
+    return f + "." + std::to_string(locality) + "." + std::to_string(worker);
+  }
+
+  struct Writer {
+    static void drain(std::size_t w, std::vector<NodeType> & nodes) {
+      auto & out = parts[w];
+      for (const auto & n : nodes) {
+        out << Format::invoke(n) << '\n';
+      }
+    }
+  };
+
+  using Buffers = WorkerBuffers<NodeType, Writer, BatchSize>;
+
+  static void put(const NodeType & n) {
+    Buffers::put(n);
+  }
+
+  static void open(std::string f) {
+    file = f;
+    Buffers::open();
+    parts.clear();
+    parts.resize(hpx::get_os_thread_count());
+    for (auto w = 0u; w < parts.size(); ++w) {
+      parts[w].open(partName(file, hpx::get_locality_id(), w), std::ios::trunc);
+      if (!parts[w]) {
+        throw std::runtime_error("Unable to open stream file: " + partName(file, hpx::get_locality_id(), w));
+      }
+    }
+  }
+  struct OpenAct : hpx::actions::make_action<decltype(&open), &open, OpenAct>::type {};
+
+  // Returns the number of part files written
+  static unsigned close() {
+    Buffers::drainAll();
+    for (auto & p : parts) {
+      p.close();
+    }
+    auto n = parts.size();
+    parts.clear();
+    return n;
+  }
+  struct CloseAct : hpx::actions::make_action<decltype(&close), &close, CloseAct>::type {};
+
+  static void start(const std::string & f) {
+    hpx::wait_all(hpx::lcos::broadcast<OpenAct>(hpx::find_all_localities(), f));
+  }
+
+  static void finish() {
+    auto localities = hpx::find_all_localities();
+    auto numParts = hpx::lcos::broadcast<CloseAct>(localities).get();
+
+    std::ofstream out(file, std::ios::trunc);
+    if (!out) {
+      throw std::runtime_error("Unable to open stream file: " + file);
+    }
+
+    for (auto i = 0u; i < localities.size(); ++i) {
+      auto loc = hpx::naming::get_locality_id_from_id(localities[i]);
+      for (auto w = 0u; w < numParts[i]; ++w) {
+        auto name = partName(file, loc, w);
+        {
+          std::ifstream in(name);
+          if (in.peek() != std::ifstream::traits_type::eof()) {
+            out << in.rdbuf();
+          }
+        }
+        std::remove(name.c_str());
+      }
+    }
+  }
+};
+
+// Passes each batch of nodes to the func Fn: void(const std::vector<NodeType> &)
+// on the locality (and worker) that found them. Batches from different workers
+// may be passed concurrently
+template <typename NodeType, typename Fn, std::size_t BatchSize = 1024>
+struct CallbackSink {
+  struct Caller {
+    static void drain(std::size_t w, std::vector<NodeType> & nodes) {
+      Fn::invoke(nodes);
+    }
+  };
+
+  using Buffers = WorkerBuffers<NodeType, Caller, BatchSize>;
+
+  static void put(const NodeType & n) {
+    Buffers::put(n);
+  }
+
+  static void open() {
+    Buffers::open();
+  }
+  struct OpenAct : hpx::actions::make_action<decltype(&open), &open, OpenAct>::type {};
+
+  static void close() {
+    Buffers::drainAll();
+  }
+  struct CloseAct : hpx::actions::make_action<decltype(&close), &close, CloseAct>::type {};
+
+  static void start() {
+    hpx::wait_all(hpx::lcos::broadcast<OpenAct>(hpx::find_all_localities()));
+  }
+
+  static void finish() {
+    hpx::wait_all(hpx::lcos::broadcast<CloseAct>(hpx::find_all_localities()));
+  }
+};
+
+// Streams every node satisfying the func Pred: bool(const NodeType &) to Sink.
+// The search result is the number of nodes streamed
+template <typename NodeType, typename Pred, typename Sink>
+struct StreamEnumerator : StaticEnumerator<StreamEnumerator<NodeType, Pred, Sink>, NodeType, std::uint64_t> {
+  std::uint64_t count = 0;
+
+  void accumulate(const NodeType & n) {
+    if (Pred::invoke(n)) {
+      Sink::put(n);
+      count++;
+    }
+  }
+
+  void combine(const std::uint64_t & other) { count += other; }
+
+  std::uint64_t get() { return count; }
+};
+
+}}
+
+#endif
@@ -0,0 +1,139 @@
+#ifndef YEWPAR_TASK_POOL_HPP
+#define YEWPAR_TASK_POOL_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#include <boost/lockfree/stack.hpp>
+
+#include <hpx/runtime/naming/id_type.hpp>
+#include <hpx/runtime/serialization/serialize.hpp>
+
+namespace YewPar { namespace util {
+
+// Recycled, fixed size task records for the work pools.
+//
+// Binding a node (and the task's other arguments) into an
+// hpx::util::function allocates a new closure on every spawn, as it is larger
+// than the function's small object buffer. A PooledTask is instead a single
+// pointer to a Record taken from a per-locality free list, so it is stored in
+// place and spawning a task in the steady state doesn't allocate. Records are
+// refilled in place, so nodes that own memory (e.g. vectors) keep their
+// capacity from one task to the next when copy assigned.
+//
+// Record must be default constructible and serialisable, and provide a run()
+// method that executes the task. A PooledTask may be copied (the work queues
+// copy their entries) and the record returns to the pool once the last copy is
+// gone. When a task is stolen by another locality only the record is sent and
+// the thief takes a record from its own pool to receive it.
+template <typename Record>
+class PooledTask {
+ private:
+  struct Slot {
+    Record rec;
+    std::atomic<std::uint32_t> refs;
+  };
+
+  // Slots are allocated in blocks of this many when the pool runs dry and are
+  // never freed, so later searches reuse them
+  static constexpr std::size_t blockSize = 64;
+
+  static boost::lockfree::stack<Slot *> & freeSlots() {
+    static boost::lockfree::stack<Slot *> slots(1024);
+    return slots;
+  }
+
+  static Slot * acquire() {
+    Slot * s;
+    if (!freeSlots().pop(s)) {
+      auto block = new Slot[blockSize];
+      for (auto i = 1u; i < blockSize; ++i) {
+        freeSlots().push(&block[i]);
+      }
+      s = &block[0];
+    }
+    s->refs = 1;
+    return s;
+  }
+
+  void release() {
+    if (slot && --slot->refs == 0) {
+      freeSlots().push(slot);
+    }
+    slot = nullptr;
+  }
+
+  Slot * slot = nullptr;
+
+ public:
+  PooledTask() = default;
+
+  // Takes a record from the pool and has fill set its fields
+  template <typename Fill>
+  static PooledTask make(Fill && fill) {
+    PooledTask t;
+    t.slot = acquire();
+    fill(t.slot->rec);
+    return t;
+  }
+
+  PooledTask(const PooledTask & other) : slot(other.slot) {
+    if (slot) {
+      slot->refs++;
+    }
+  }
+
+  PooledTask(PooledTask && other) noexcept : slot(other.slot) {
+    other.slot = nullptr;
+  }
+
+  PooledTask & operator=(const PooledTask & other) {
+    if (this != &other) {
+      release();
+      slot = other.slot;
+      if (slot) {
+        slot->refs++;
+      }
+    }
+    return *this;
+  }
+
+  PooledTask & operator=(PooledTask && other) noexcept {
+    if (this != &other) {
+      release();
+      slot = other.slot;
+      other.slot = nullptr;
+    }
+    return *this;
+  }
+
+  ~PooledTask() {
+    release();
+  }
+
+  // Matches the work pools' task signature. The locality is unused since
+  // pooled tasks always run where they were taken from the pool
+  void operator()(hpx::naming::id_type) {
+    slot->rec.run();
+  }
+
+  template <class Archive>
+  void save(Archive & ar, const unsigned int version) const {
+    ar << slot->rec;
+  }
+
+  template <class Archive>
+  void load(Archive & ar, const unsigned int version) {
+    release();
+    slot = acquire();
+    ar >> slot->rec;
+  }
+
+  HPX_SERIALIZATION_SPLIT_MEMBER()
+};
+
+}}
+
+#endif
@@ -0,0 +1,84 @@
+#include "TerminationDetection.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <numeric>
+
+#include <hpx/hpx.hpp>
+#include <hpx/lcos/broadcast.hpp>
+#include <hpx/lcos/local/condition_variable.hpp>
+#include <hpx/lcos/local/mutex.hpp>
+
+namespace YewPar { namespace Termination {
+
+std::uint64_t getCreated() {
+  return detail::created.load();
+}
+
+std::uint64_t getCompleted() {
+  return detail::completed.load();
+}
+
+// Max time between termination waves (microseconds)
+static constexpr std::uint64_t maxWaveInterval = 10000;
+
+static hpx::lcos::local::mutex mtx;
+static hpx::lcos::local::condition_variable cancelled_cv;
+static bool cancelled = false;
+
+void reset() {
+  std::lock_guard<hpx::lcos::local::mutex> l(mtx);
+  detail::created   = 0;
+  detail::completed = 0;
+  cancelled = false;
+}
+
+void cancel() {
+  std::lock_guard<hpx::lcos::local::mutex> l(mtx);
+  cancelled = true;
+  cancelled_cv.notify_all();
+}
+
+std::uint64_t countOutstanding() {
+  auto localities = hpx::find_all_localities();
+
+  // The completed wave must finish before the created wave starts
+  std::uint64_t completed, created;
+  if (localities.size() == 1) {
+    completed = getCompleted();
+    created   = getCreated();
+  } else {
+    auto cs = hpx::lcos::broadcast<getCompleted_act>(localities).get();
+    completed = std::accumulate(cs.begin(), cs.end(), std::uint64_t(0));
+
+    auto ss = hpx::lcos::broadcast<getCreated_act>(localities).get();
+    created = std::accumulate(ss.begin(), ss.end(), std::uint64_t(0));
+  }
+
+  return created - completed;
+}
+
+void waitForTermination() {
+  std::uint64_t interval = 100;
+
+  std::unique_lock<hpx::lcos::local::mutex> l(mtx);
+  for (;;) {
+    if (cancelled) {
+      return;
+    }
+
+    l.unlock();
+
+    if (countOutstanding() == 0) {
+      return;
+    }
+
+    l.lock();
+    if (!cancelled) {
+      cancelled_cv.wait_for(l, std::chrono::microseconds(interval));
+    }
+    interval = std::min(interval * 2, maxWaveInterval);
+  }
+}
+
+}}
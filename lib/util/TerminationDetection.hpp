@@ -0,0 +1,67 @@
+#ifndef YEWPAR_TERMINATION_DETECTION_HPP
+#define YEWPAR_TERMINATION_DETECTION_HPP
+
+#include <atomic>
+#include <cstdint>
+
+#include "hpx/runtime/actions/plain_action.hpp"
+
+namespace YewPar { namespace Termination {
+
+// Global termination detection for the task based skeletons, using the four
+// counter method [1]. Each locality counts the tasks it creates and the tasks it
+// completes, so no per-task state or messages are needed.
+//
+// A task is counted as created by whoever makes it visible to other workers (a
+// workqueue push, a steal response or a remote spawn), before doing so, and as
+// completed by whoever runs it, after all of its effects (e.g. enumerator
+// updates) have been made. The search has finished once a wave collecting every
+// completed count followed by a wave collecting every created count gives equal
+// totals.
+//
+// This also makes task completion allocation free: completing a task is a
+// single atomic increment on the locality that ran it, with no promise, future
+// or per-parent counter to create, recycle or message. Spawning is allocation
+// free through util::PooledTask.
+//
+// [1] F. Mattern. Algorithms for distributed termination detection.
+//     Distributed Computing 2(3), 1987.
+
+namespace detail {
+inline std::atomic<std::uint64_t> created(0);
+inline std::atomic<std::uint64_t> completed(0);
+}
+
+inline void taskCreated(const std::uint64_t n = 1) {
+  detail::created += n;
+}
+
+inline void taskCompleted() {
+  detail::completed++;
+}
+
+std::uint64_t getCreated();
+HPX_DEFINE_PLAIN_ACTION(getCreated, getCreated_act);
+
+std::uint64_t getCompleted();
+HPX_DEFINE_PLAIN_ACTION(getCompleted, getCompleted_act);
+
+// Clears the counts (and any cancellation) ready for a new search
+void reset();
+HPX_DEFINE_PLAIN_ACTION(reset, reset_act);
+
+// Releases any waiter on this locality immediately, without waiting for
+// outstanding tasks. Used when the result of the search is already known
+void cancel();
+
+// Number of tasks created but not yet completed, across every locality. Only
+// exact once the system is quiescent (no task can create more)
+std::uint64_t countOutstanding();
+
+// Suspends the calling thread until every task created, on any locality, has
+// completed or the search is cancelled
+void waitForTermination();
+
+}}
+
+#endif
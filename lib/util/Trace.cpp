@@ -0,0 +1,112 @@
+#include "Trace.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include <hpx/hpx.hpp>
+#include <hpx/lcos/broadcast.hpp>
+#include <hpx/runtime/get_os_thread_count.hpp>
+
+namespace YewPar { namespace Trace {
+
+// File layout (all integers native endian):
+//   "YPTRACE\0", u32 version, u32 localities, then per locality
+//   u32 locality, u32 buffers, u64 start (system clock, ns since the epoch),
+//   then per buffer
+//   u32 worker, u32 0, u64 events recorded, u64 events kept, Event[kept]
+// A buffer's events are in the order they were recorded. The last buffer of a
+// locality is shared by threads that aren't workers.
+static constexpr char magic[8] = {'Y', 'P', 'T', 'R', 'A', 'C', 'E', '\0'};
+static constexpr std::uint32_t version = 1;
+
+static std::uint64_t startWallClock = 0;
+
+template <typename T>
+static void put(std::vector<char> & out, const T & v) {
+  auto p = reinterpret_cast<const char *>(&v);
+  out.insert(out.end(), p, p + sizeof(T));
+}
+
+void start(std::uint64_t eventsPerWorker) {
+  detail::enabled.store(false);
+
+  std::uint64_t capacity = 1;
+  while (capacity < eventsPerWorker) {
+    capacity <<= 1;
+  }
+
+  detail::numWorkers = hpx::get_os_thread_count();
+  detail::mask = capacity - 1;
+  detail::buffers.reset(new detail::Buffer[detail::numWorkers + 1]);
+  for (auto i = 0u; i <= detail::numWorkers; ++i) {
+    detail::buffers[i].events.resize(capacity);
+  }
+
+  startWallClock = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::system_clock::now().time_since_epoch()).count();
+  detail::start = std::chrono::steady_clock::now();
+  detail::enabled.store(true);
+}
+
+std::vector<char> collect() {
+  detail::enabled.store(false);
+
+  std::vector<char> out;
+  if (!detail::buffers) {
+    return out;
+  }
+
+  put<std::uint32_t>(out, hpx::get_locality_id());
+  put<std::uint32_t>(out, detail::numWorkers + 1);
+  put<std::uint64_t>(out, startWallClock);
+
+  for (auto i = 0u; i <= detail::numWorkers; ++i) {
+    const auto & b = detail::buffers[i];
+    auto capacity = detail::mask + 1;
+    auto kept = b.recorded < capacity ? b.recorded : capacity;
+
+    put<std::uint32_t>(out, i);
+    put<std::uint32_t>(out, 0);
+    put<std::uint64_t>(out, b.recorded);
+    put<std::uint64_t>(out, kept);
+
+    // Oldest first, wrapping round the ring
+    for (auto e = b.recorded - kept; e < b.recorded; ++e) {
+      put(out, b.events[e & detail::mask]);
+    }
+  }
+
+  // Buffers are kept until the next start in case a late event is still being
+  // written
+  return out;
+}
+
+void write(const std::string & file) {
+  auto all = hpx::lcos::broadcast<collect_act>(hpx::find_all_localities()).get();
+
+  std::uint32_t localities = 0;
+  for (const auto & l : all) {
+    if (!l.empty()) {
+      ++localities;
+    }
+  }
+
+  std::vector<char> header(magic, magic + sizeof(magic));
+  put(header, version);
+  put(header, localities);
+
+  std::ofstream out(file, std::ios::binary | std::ios::trunc);
+  if (!out) {
+    throw std::runtime_error("Unable to open trace file: " + file);
+  }
+  out.write(header.data(), header.size());
+  for (const auto & l : all) {
+    out.write(l.data(), l.size());
+  }
+  if (!out) {
+    throw std::runtime_error("Failed writing trace file: " + file);
+  }
+}
+
+}}
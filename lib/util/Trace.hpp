@@ -0,0 +1,157 @@
+#ifndef YEWPAR_TRACE_HPP
+#define YEWPAR_TRACE_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "hpx/runtime/actions/plain_action.hpp"
+#include "hpx/runtime/get_worker_thread_num.hpp"
+#include "hpx/runtime/naming/name.hpp"
+#include "hpx/runtime/serialization/vector.hpp"
+
+namespace YewPar { namespace Trace {
+
+// Opt-in recording of what each worker does during a search, for offline
+// visualisation with apps/bench/trace-view.py (Gantt charts of task execution
+// and heatmaps of the depths being searched over time).
+//
+// Every worker appends fixed size events to its own ring buffer, so recording
+// needs no synchronisation; once full the oldest events are overwritten and a
+// long search keeps its most recent events. Buffers are gathered on the master
+// locality and written to a single file when the search ends. When tracing is
+// off recording an event costs one relaxed load.
+
+enum class EventType : std::uint8_t {
+  TaskStart = 0,
+  TaskEnd,
+  Steal,
+  Spawn,
+  Incumbent
+};
+
+// Written to the trace file as is (native, little endian on every supported
+// platform)
+struct Event {
+  // Nanoseconds since tracing started on this locality
+  std::uint64_t time;
+  // Steal: tasks stolen (0 if failed), Spawn: priority, Incumbent: bound
+  std::int64_t value;
+  // TaskStart/TaskEnd/Spawn: depth, Steal: victim locality
+  std::uint32_t arg;
+  std::uint16_t worker;
+  EventType type;
+  std::uint8_t pad;
+};
+static_assert(sizeof(Event) == 24, "Trace events are 24 bytes on file");
+
+// arg for events without a depth, and for steals from this locality
+static constexpr std::uint32_t none = 0xFFFFFFFF;
+
+namespace detail {
+struct alignas(64) Buffer {
+  std::vector<Event> events;
+  // Events ever recorded, the next is written at recorded & mask
+  std::uint64_t recorded = 0;
+};
+
+inline std::atomic<bool> enabled(false);
+inline std::chrono::steady_clock::time_point start;
+inline std::size_t numWorkers = 0;
+inline std::uint64_t mask = 0;
+// Threads that aren't HPX workers share the last buffer (and may race on it)
+inline std::unique_ptr<Buffer[]> buffers;
+
+inline std::size_t worker() {
+  thread_local std::size_t w = hpx::get_worker_thread_num();
+  return w < numWorkers ? w : numWorkers;
+}
+
+inline void record(EventType type, std::uint32_t arg, std::int64_t value) {
+  if (!enabled.load(std::memory_order_relaxed)) {
+    return;
+  }
+  auto w = worker();
+  auto & b = buffers[w];
+  auto & e = b.events[b.recorded & mask];
+  e.time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - start).count();
+  e.value = value;
+  e.arg = arg;
+  e.worker = static_cast<std::uint16_t>(w);
+  e.type = type;
+  e.pad = 0;
+  ++b.recorded;
+}
+}
+
+inline bool enabled() {
+  return detail::enabled.load(std::memory_order_relaxed);
+}
+
+// A task running from construction to destruction
+class Task {
+ private:
+  std::uint32_t depth;
+
+ public:
+  explicit Task(unsigned depth) : depth(depth) {
+    detail::record(EventType::TaskStart, depth, 0);
+  }
+
+  ~Task() {
+    detail::record(EventType::TaskEnd, depth, 0);
+  }
+
+  Task(const Task &) = delete;
+  Task & operator=(const Task &) = delete;
+};
+
+inline void spawn(std::uint32_t depth, std::int64_t priority = 0) {
+  detail::record(EventType::Spawn, depth, priority);
+}
+
+// A steal attempt, from victim or from this locality if victim is invalid
+inline void steal(const hpx::naming::id_type & victim, std::size_t tasks) {
+  if (!enabled()) {
+    return;
+  }
+  auto loc = victim ? hpx::naming::get_locality_id_from_id(victim) : none;
+  detail::record(EventType::Steal, loc, static_cast<std::int64_t>(tasks));
+}
+
+inline void steal(std::size_t tasks) {
+  detail::record(EventType::Steal, none, static_cast<std::int64_t>(tasks));
+}
+
+// Bounds are only recorded if they are numbers
+template <typename Bound>
+inline void incumbent(const Bound & bnd) {
+  if constexpr(std::is_arithmetic<Bound>::value) {
+    detail::record(EventType::Incumbent, none, static_cast<std::int64_t>(bnd));
+  } else {
+    detail::record(EventType::Incumbent, none, 0);
+  }
+}
+
+// Clears and enables this locality's buffers, each holding eventsPerWorker
+// events (rounded up to a power of two)
+void start(std::uint64_t eventsPerWorker);
+HPX_DEFINE_PLAIN_ACTION(start, start_act);
+
+// Disables tracing and returns this locality's buffers in the file's locality
+// format
+std::vector<char> collect();
+HPX_DEFINE_PLAIN_ACTION(collect, collect_act);
+
+// Gather every locality's buffers and write them to file (on the master
+// locality). Throws std::runtime_error if the file can't be written
+void write(const std::string & file);
+
+}}
+
+#endif
@@ -0,0 +1,191 @@
+#ifndef YEWPAR_TRANSPOSITIONTABLE_HPP
+#define YEWPAR_TRANSPOSITIONTABLE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <hpx/lcos/broadcast.hpp>
+#include <hpx/runtime/actions/plain_action.hpp>
+#include <hpx/runtime/find_all_localities.hpp>
+#include <hpx/runtime/find_here.hpp>
+#include <hpx/runtime/serialization/vector.hpp>
+
+namespace YewPar { namespace Transposition {
+
+// For search spaces that are DAGs rather than trees: remembers which states have
+// been visited so a state reached again (along another path) can be skipped.
+//
+// States are identified by a 64 bit hash from the user (HashFn, a func mapping
+// a node to std::uint64_t). Equal hashes are treated as the same state, so the
+// hash should be exact (e.g. the state itself) or at least very strong.
+//
+// The table is bounded: once a bucket is full the entry that has caught the
+// fewest duplicates is replaced. A replaced state may be visited again, so
+// duplicate-free results (e.g. counting distinct states) need a table large
+// enough to never replace. Replacements are counted so this can be checked.
+
+// User hashes are often the state itself, so are spread before choosing a
+// bucket or owner (splitmix64 finaliser)
+inline std::uint64_t mix(std::uint64_t x) {
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+  return x ^ (x >> 31);
+}
+
+// Lock-free open addressing table with a fixed number of probes per bucket
+class Table {
+ public:
+  static constexpr unsigned probes = 8;
+
+  void init(std::uint64_t capacity) {
+    std::uint64_t size = probes;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    mask = size - 1;
+    keys.reset(new std::atomic<std::uint64_t>[size]);
+    hits.reset(new std::atomic<std::uint8_t>[size]);
+    for (auto i = 0u; i < size; ++i) {
+      keys[i].store(0, std::memory_order_relaxed);
+      hits[i].store(0, std::memory_order_relaxed);
+    }
+    zeroVisited.store(false, std::memory_order_relaxed);
+    duplicates = 0;
+    replaced = 0;
+  }
+
+  // Marks key as visited. Returns false if it already was
+  bool visit(std::uint64_t key) {
+    // 0 marks an empty slot, so that hash has its own flag
+    if (key == 0) {
+      if (zeroVisited.exchange(true, std::memory_order_acq_rel)) {
+        duplicates++;
+        return false;
+      }
+      return true;
+    }
+
+    auto start = mix(key) & mask;
+    auto victim = start;
+    std::uint8_t victimHits = 255;
+    for (auto i = 0u; i < probes; ++i) {
+      auto s = (start + i) & mask;
+      auto cur = keys[s].load(std::memory_order_acquire);
+      if (cur == 0 && keys[s].compare_exchange_strong(cur, key, std::memory_order_acq_rel)) {
+        hits[s].store(0, std::memory_order_relaxed);
+        return true;
+      }
+      // Either already here, or inserted by someone else while we looked
+      if (cur == key) {
+        seen(s);
+        return false;
+      }
+
+      auto h = hits[s].load(std::memory_order_relaxed);
+      if (h < victimHits) {
+        victim = s;
+        victimHits = h;
+      }
+    }
+
+    // Full bucket
+    hits[victim].store(0, std::memory_order_relaxed);
+    if (keys[victim].exchange(key, std::memory_order_acq_rel) == key) {
+      seen(victim);
+      return false;
+    }
+    replaced++;
+    return true;
+  }
+
+  std::uint64_t getDuplicates() const { return duplicates; }
+  std::uint64_t getReplaced() const { return replaced; }
+
+ private:
+  std::uint64_t mask = 0;
+  std::unique_ptr<std::atomic<std::uint64_t>[]> keys;
+  std::unique_ptr<std::atomic<std::uint8_t>[]> hits;
+  std::atomic<bool> zeroVisited {false};
+
+  std::atomic<std::uint64_t> duplicates {0};
+  std::atomic<std::uint64_t> replaced {0};
+
+  void seen(std::uint64_t s) {
+    duplicates++;
+    auto h = hits[s].load(std::memory_order_relaxed);
+    if (h < 255) {
+      hits[s].store(h + 1, std::memory_order_relaxed);
+    }
+  }
+};
+
+// One table per locality. When distributed every state is owned by one locality
+// (by hash) and checked there, so no state is visited twice anywhere, at the
+// cost of a round trip for each state owned elsewhere. Otherwise each locality
+// only skips the duplicates it has seen itself.
+template <typename HashFn>
+struct Store {
+  static inline Table table;
+  static inline bool distributed = false;
+  static inline std::vector<hpx::naming::id_type> localities;
+  static inline std::size_t here = 0;
+
+  static void init(std::uint64_t capacity, bool dist) {
+    localities = hpx::find_all_localities();
+    distributed = dist && localities.size() > 1;
+    for (auto i = 0u; i < localities.size(); ++i) {
+      if (localities[i] == hpx::find_here()) {
+        here = i;
+      }
+    }
+
+    // Each locality only holds its share of the states
+    table.init(distributed ? capacity / localities.size() : capacity);
+  }
+  struct InitAct : hpx::actions::make_action<decltype(&init), &init, InitAct>::type {};
+
+  static bool visitLocal(std::uint64_t key) {
+    return table.visit(key);
+  }
+  struct VisitAct : hpx::actions::make_action<decltype(&visitLocal), &visitLocal, VisitAct>::type {};
+
+  template <typename Node>
+  static bool visit(const Node & n) {
+    std::uint64_t key = HashFn::invoke(n);
+    if (distributed) {
+      // High bits, the table buckets on the low ones
+      auto owner = (mix(key) >> 32) % localities.size();
+      if (owner != here) {
+        return hpx::async<VisitAct>(localities[owner], key).get();
+      }
+    }
+    return table.visit(key);
+  }
+
+  static void start(std::uint64_t capacity, bool dist) {
+    hpx::wait_all(hpx::lcos::broadcast<InitAct>(hpx::find_all_localities(), capacity, dist));
+  }
+
+  static std::vector<std::uint64_t> getStats() {
+    return { table.getDuplicates(), table.getReplaced() };
+  }
+  struct GetStatsAct : hpx::actions::make_action<decltype(&getStats), &getStats, GetStatsAct>::type {};
+
+  // Duplicates skipped and entries replaced, over all localities
+  static std::pair<std::uint64_t, std::uint64_t> totalStats() {
+    auto stats = hpx::lcos::broadcast<GetStatsAct>(hpx::find_all_localities()).get();
+    std::pair<std::uint64_t, std::uint64_t> total {0, 0};
+    for (const auto & s : stats) {
+      total.first += s[0];
+      total.second += s[1];
+    }
+    return total;
+  }
+};
+
+}}
+
+#endif
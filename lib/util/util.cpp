@@ -1,5 +1,10 @@
 #include "util.hpp"
 
+#include <algorithm>
+#include <numeric>
+#include <sstream>
+#include <string>
+
 #include <hpx/hpx.hpp>
 
 namespace YewPar { namespace util {
@@ -16,4 +21,79 @@ std::vector<hpx::naming::id_type> findOtherLocalities () {
   return locs;
 }
 
+LocalityCapacity getLocalCapacity() {
+  LocalityCapacity cap;
+  cap.workers = hpx::get_os_thread_count() == 1 ? 1 : hpx::get_os_thread_count() - 1;
+  cap.weight = std::stod(hpx::get_config_entry("yewpar.locality_weight", "1"));
+
+  std::istringstream weights(hpx::get_config_entry("yewpar.locality_weights", ""));
+  std::string w;
+  for (auto i = 0u; std::getline(weights, w, ','); ++i) {
+    if (i == hpx::get_locality_id()) {
+      cap.weight = std::stod(w);
+      break;
+    }
+  }
+
+  if (cap.weight <= 0) {
+    cap.weight = 1;
+  }
+  return cap;
+}
+
+std::vector<unsigned> weightedCounts(const std::vector<double> & shares,
+                                     const unsigned n) {
+  auto total = std::accumulate(shares.begin(), shares.end(), 0.0);
+  std::vector<unsigned> counts(shares.size(), 0);
+  std::vector<double> remainders(shares.size(), 0.0);
+
+  auto given = 0u;
+  for (auto i = 0; i < shares.size(); ++i) {
+    auto exact = n * shares[i] / total;
+    counts[i] = static_cast<unsigned>(exact);
+    remainders[i] = exact - counts[i];
+    given += counts[i];
+  }
+
+  // What rounding down left over goes to the largest remainders
+  while (given < n) {
+    auto best = std::max_element(remainders.begin(), remainders.end()) - remainders.begin();
+    counts[best]++;
+    remainders[best] = -1.0;
+    given++;
+  }
+
+  return counts;
+}
+
+std::vector<unsigned> weightedDistribution(const std::vector<double> & shares,
+                                           const std::vector<unsigned> & slots) {
+  auto n = std::accumulate(slots.begin(), slots.end(), 0u);
+  std::vector<unsigned> dist;
+  dist.reserve(n);
+
+  std::vector<unsigned> remaining(slots);
+  std::vector<double> current(shares.size(), 0.0);
+  for (auto t = 0; t < n; ++t) {
+    // Only localities with free slots take part in each round
+    auto total = 0.0;
+    auto best = -1;
+    for (auto i = 0; i < shares.size(); ++i) {
+      if (remaining[i] == 0) {
+        continue;
+      }
+      current[i] += shares[i];
+      total += shares[i];
+      if (best < 0 || current[i] > current[best]) {
+        best = i;
+      }
+    }
+    current[best] -= total;
+    remaining[best]--;
+    dist.push_back(best);
+  }
+
+  return dist;
+}
+
 }}
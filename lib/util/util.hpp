@@ -4,6 +4,7 @@
 #include <vector>
 
 #include <hpx/runtime/find_here.hpp>
+#include <hpx/runtime/actions/plain_action.hpp>
 
 namespace YewPar { namespace util {
 
@@ -12,6 +13,41 @@ bool isColocated(hpx::naming::id_type & id);
 // Find all localities except the one the function is called on
 std::vector<hpx::naming::id_type> findOtherLocalities ();
 
+// How much work a locality can take: the number of workers it runs searches
+// with, and a relative speed set per locality with
+// --hpx:ini=yewpar.locality_weight=W (default 1). Localities started with the
+// same command line (e.g. by hpxrun.py) can instead be given one weight each,
+// by locality id, with --hpx:ini=yewpar.locality_weights=W0,W1,...
+struct LocalityCapacity {
+  unsigned workers;
+  double weight;
+
+  double share() const {
+    return workers * weight;
+  }
+
+  template <class Archive>
+  void serialize(Archive & ar, const unsigned int version) {
+    ar & workers;
+    ar & weight;
+  }
+};
+
+LocalityCapacity getLocalCapacity();
+HPX_DEFINE_PLAIN_ACTION(getLocalCapacity, getLocalCapacity_act);
+
+// Split n tasks between localities in proportion to their shares (largest
+// remainder rounding). Returns the number of tasks for each locality
+std::vector<unsigned> weightedCounts(const std::vector<double> & shares,
+                                     const unsigned n);
+
+// Order tasks between localities, where locality i takes exactly slots[i]
+// tasks, using smooth weighted round-robin on the shares. Early tasks are
+// spread out and localities with larger shares receive theirs sooner. Returns
+// the index of the locality for each task
+std::vector<unsigned> weightedDistribution(const std::vector<double> & shares,
+                                           const std::vector<unsigned> & slots);
+
 }}
 
 #endif
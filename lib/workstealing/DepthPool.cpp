@@ -2,14 +2,17 @@
 
 #include <hpx/include/components.hpp>
 
+#include <mutex>
+
 namespace workstealing {
 
 DepthPool::fnType DepthPool::steal() {
+  std::lock_guard<mutex_t> l(mtx);
   DepthPool::fnType task;
 
   for (auto i = 0; i <= lowest; ++i) {
     if (!pools[i].empty()) {
-      auto task = pools[i].front();
+      auto task = std::move(pools[i].front());
       pools[i].pop();
       return task;
     }
@@ -18,11 +21,12 @@ DepthPool::fnType DepthPool::steal() {
 }
 
 DepthPool::fnType DepthPool::getLocal() {
+  std::lock_guard<mutex_t> l(mtx);
   DepthPool::fnType task;
   if (pools[lowest].empty()) {
     return nullptr;
   } else {
-    task = pools[lowest].front();
+    task = std::move(pools[lowest].front());
     pools[lowest].pop();
   }
 
@@ -39,19 +43,28 @@ DepthPool::fnType DepthPool::getLocal() {
 }
 
 void DepthPool::addWork(DepthPool::fnType task, unsigned depth) {
+  std::lock_guard<mutex_t> l(mtx);
   // Resize if we need to. We don't want this to happen too often, so we double it if we need to.
   if (depth >= max_depth) {
     max_depth = max_depth * 2;
     pools.resize(max_depth);
   }
 
-  pools[depth].push(task);
+  pools[depth].push(std::move(task));
 
   if (depth > lowest) {
     lowest = depth;
   }
 }
 
+void DepthPool::clear() {
+  std::lock_guard<mutex_t> l(mtx);
+  for (auto i = 0; i <= lowest; ++i) {
+    pools[i] = std::queue<fnType>();
+  }
+  lowest = 0;
+}
+
 }
 
 HPX_REGISTER_COMPONENT_MODULE();
@@ -63,3 +76,4 @@ HPX_REGISTER_COMPONENT(DepthPool_type, DepthPool);
 HPX_REGISTER_ACTION(workstealing::DepthPool::getLocal_action, DepthPool_getLocal_action);
 HPX_REGISTER_ACTION(workstealing::DepthPool::steal_action, DepthPool_steal_action);
 HPX_REGISTER_ACTION(workstealing::DepthPool::addWork_action, DepthPool_addWork_action);
+HPX_REGISTER_ACTION(workstealing::DepthPool::clear_action, DepthPool_clear_action);
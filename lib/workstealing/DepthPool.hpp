@@ -8,6 +8,7 @@
 #include <hpx/runtime/actions/basic_action.hpp>
 #include <hpx/runtime/actions/component_action.hpp>
 #include <hpx/util/function.hpp>
+#include <hpx/lcos/local/spinlock.hpp>
 namespace hpx { namespace naming { struct id_type; } }
 
 namespace workstealing {
@@ -16,11 +17,14 @@ namespace workstealing {
 // This allows high vs low tasks to be distinguished while maintaining heuristics as much as possible.
 // In particular a sequential user should see tasks in the same order as a sequential thread
 // Currently only supports access by a single thread at a time as it's very non trivial to implement lock-free.
-class DepthPool : public hpx::components::locking_hook<
-  hpx::components::component_base<DepthPool>> {
+// The lock is held by the pool itself (rather than a locking_hook) so the local policy can call it directly.
+class DepthPool : public hpx::components::component_base<DepthPool> {
  private:
   using fnType = hpx::util::function<void(hpx::naming::id_type)>;
 
+  using mutex_t = hpx::lcos::local::spinlock;
+  mutex_t mtx;
+
   std::vector< std::queue<fnType> > pools;
 
   // For quicker access
@@ -40,11 +44,14 @@ class DepthPool : public hpx::components::locking_hook<
   HPX_DEFINE_COMPONENT_ACTION(DepthPool, steal);
   void addWork(fnType task, unsigned depth);
   HPX_DEFINE_COMPONENT_ACTION(DepthPool, addWork);
+  void clear();
+  HPX_DEFINE_COMPONENT_ACTION(DepthPool, clear);
 };
 }
 
 HPX_REGISTER_ACTION_DECLARATION(workstealing::DepthPool::getLocal_action, DepthPool_getLocal_action);
 HPX_REGISTER_ACTION_DECLARATION(workstealing::DepthPool::steal_action, DepthPool_steal_action);
 HPX_REGISTER_ACTION_DECLARATION(workstealing::DepthPool::addWork_action, DepthPool_addWork_action);
+HPX_REGISTER_ACTION_DECLARATION(workstealing::DepthPool::clear_action, DepthPool_clear_action);
 
 #endif
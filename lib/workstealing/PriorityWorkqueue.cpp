@@ -33,6 +33,10 @@ void PriorityWorkqueue::addWork(int priority, funcType task) {
 bool PriorityWorkqueue::workRemaining() {
   return tasks.empty();
 }
+
+void PriorityWorkqueue::clear() {
+  tasks = decltype(tasks)();
+}
 }
 HPX_REGISTER_COMPONENT_MODULE();
 
@@ -43,3 +47,4 @@ HPX_REGISTER_COMPONENT(workqueue_type, priority_workqueue);
 HPX_REGISTER_ACTION(workstealing::PriorityWorkqueue::steal_action, workqueue_prio_steal_action);
 HPX_REGISTER_ACTION(workstealing::PriorityWorkqueue::addWork_action, workqueue_prio_addWork_action);
 HPX_REGISTER_ACTION(workstealing::PriorityWorkqueue::workRemaining_action, workqueue_prio_workRemaining_action);
+HPX_REGISTER_ACTION(workstealing::PriorityWorkqueue::clear_action, workqueue_prio_clear_action);
@@ -50,11 +50,14 @@ namespace workstealing
       HPX_DEFINE_COMPONENT_ACTION(PriorityWorkqueue, addWork);
       bool workRemaining();
       HPX_DEFINE_COMPONENT_ACTION(PriorityWorkqueue, workRemaining);
+      void clear();
+      HPX_DEFINE_COMPONENT_ACTION(PriorityWorkqueue, clear);
     };
 }
 
 HPX_REGISTER_ACTION_DECLARATION(workstealing::PriorityWorkqueue::steal_action, workqueue_prio_steal_action);
 HPX_REGISTER_ACTION_DECLARATION(workstealing::PriorityWorkqueue::addWork_action, workqueue_prio_addWork_action);
 HPX_REGISTER_ACTION_DECLARATION(workstealing::PriorityWorkqueue::workRemaining_action, workqueue_prio_workRemaining_action);
+HPX_REGISTER_ACTION_DECLARATION(workstealing::PriorityWorkqueue::clear_action, workqueue_prio_clear_action);
 
 #endif
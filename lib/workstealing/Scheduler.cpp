@@ -5,11 +5,15 @@
 
 #include "Scheduler.hpp"
 #include "ExponentialBackoff.hpp"
+#include "SchedulerPerf.hpp"
 
 namespace Workstealing { namespace Scheduler {
 
+static std::atomic<unsigned> numIdle(0);
+
 void scheduler(hpx::util::function<void(), false> initialTask) {
   workstealing::ExponentialBackoff backoff;
+  bool idle = false;
 
   if (!local_policy) {
     std::cerr << "No local policy set when calling scheduler. Returning\n";
@@ -23,7 +27,9 @@ void scheduler(hpx::util::function<void(), false> initialTask) {
 
   // If we are pre-initialised then run that task first then enter the scheduler in this thread
   if (initialTask) {
+    auto taskStart = SchedulerPerf::Clock::now();
     initialTask();
+    SchedulerPerf::addBusy(SchedulerPerf::elapsedNs(taskStart));
   }
 
   for (;;) {
@@ -31,17 +37,36 @@ void scheduler(hpx::util::function<void(), false> initialTask) {
       break;
     }
 
+    auto getWorkStart = SchedulerPerf::Clock::now();
     auto task = local_policy->getWork();
+    SchedulerPerf::addGetWork(SchedulerPerf::elapsedNs(getWorkStart));
 
     if (task) {
+      if (idle) {
+        idle = false;
+        numIdle--;
+      }
       backoff.reset();
+      auto taskStart = SchedulerPerf::Clock::now();
       task();
+      SchedulerPerf::addBusy(SchedulerPerf::elapsedNs(taskStart));
     } else {
+      if (!idle) {
+        idle = true;
+        numIdle++;
+      }
+      SchedulerPerf::countFailedGetWork();
       backoff.failed();
+      auto sleepStart = SchedulerPerf::Clock::now();
       hpx::this_thread::suspend(backoff.getSleepTime());
+      SchedulerPerf::addBackoff(SchedulerPerf::elapsedNs(sleepStart));
     }
   }
 
+  if (idle) {
+    numIdle--;
+  }
+
   {
     // Signal exit
     std::unique_lock<hpx::lcos::local::mutex> l(mtx);
@@ -61,6 +86,10 @@ void stopSchedulers() {
   }
 }
 
+unsigned idleSchedulers() {
+  return numIdle.load();
+}
+
 void startSchedulers(unsigned n) {
   hpx::threads::executors::default_executor exe(hpx::threads::thread_priority_critical,
                                                 hpx::threads::thread_stacksize_huge);
@@ -10,20 +10,20 @@
 namespace Workstealing { namespace Scheduler {
 
 // Used to stop all schedulers
-std::atomic<bool> running(true);
+inline std::atomic<bool> running(true);
 
-hpx::lcos::local::mutex mtx;
-hpx::lcos::local::condition_variable exit_cv;
-unsigned numRunningSchedulers;
-
-// Implementation policy
-std::shared_ptr<Policy> local_policy;
+inline hpx::lcos::local::mutex mtx;
+inline hpx::lcos::local::condition_variable exit_cv;
+inline unsigned numRunningSchedulers;
 
 void stopSchedulers();
 HPX_DEFINE_PLAIN_ACTION(stopSchedulers, stopSchedulers_act);
 
 void scheduler(hpx::util::function<void(), false> initialTask);
 
+// Number of schedulers on this locality currently failing to find work
+unsigned idleSchedulers();
+
 // Start "n" uninitialised schedulers
 void startSchedulers(unsigned n);
 HPX_DEFINE_PLAIN_ACTION(startSchedulers, startSchedulers_act);
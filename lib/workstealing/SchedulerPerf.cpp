@@ -0,0 +1,241 @@
+#include "SchedulerPerf.hpp"
+
+#include <algorithm>
+
+#include <hpx/include/iostreams.hpp>
+#include <hpx/lcos/broadcast.hpp>
+#include <hpx/lcos/local/spinlock.hpp>
+#include <hpx/performance_counters/manage_counter_type.hpp>
+#include <hpx/runtime/config_entry.hpp>
+#include <hpx/runtime/find_all_localities.hpp>
+
+#include <boost/format.hpp>
+
+namespace Workstealing { namespace SchedulerPerf {
+
+static WorkerSummary summarise(const WorkerCounters & c) {
+  WorkerSummary s;
+  s.busy = c.busy.load(std::memory_order_relaxed);
+  s.getWork = c.getWork.load(std::memory_order_relaxed);
+  s.backoff = c.backoff.load(std::memory_order_relaxed);
+  s.tasks = c.tasks.load(std::memory_order_relaxed);
+  s.nodes = c.nodes.load(std::memory_order_relaxed);
+  for (auto i = 0u; i < latencyBuckets; ++i) {
+    s.localSteals.push_back(c.localSteals[i].load(std::memory_order_relaxed));
+    s.distributedSteals.push_back(c.distributedSteals[i].load(std::memory_order_relaxed));
+  }
+  return s;
+}
+
+std::vector<WorkerSummary> getWorkerSummaries() {
+  std::vector<WorkerSummary> res;
+  for (auto i = 0u; i < numWorkers(); ++i) {
+    res.push_back(summarise(workerCounters(i)));
+  }
+  return res;
+}
+
+static WorkerSummary since(const WorkerSummary & now, const WorkerSummary & before) {
+  WorkerSummary s;
+  s.busy = now.busy - before.busy;
+  s.getWork = now.getWork - before.getWork;
+  s.backoff = now.backoff - before.backoff;
+  s.tasks = now.tasks - before.tasks;
+  s.nodes = now.nodes - before.nodes;
+  for (auto i = 0u; i < latencyBuckets; ++i) {
+    s.localSteals.push_back(now.localSteals[i] - before.localSteals[i]);
+    s.distributedSteals.push_back(now.distributedSteals[i] - before.distributedSteals[i]);
+  }
+  return s;
+}
+
+void setNodeCounts(bool on) {
+  detail::countNodes = on || hpx::get_config_entry("yewpar.count_nodes", "0") == "1";
+}
+
+static std::vector<std::vector<WorkerSummary> > summaryBaseline;
+
+void startSummary() {
+  summaryBaseline = hpx::lcos::broadcast<getWorkerSummaries_act>(hpx::find_all_localities()).get();
+}
+
+void printSummary() {
+  auto locs = hpx::find_all_localities();
+  auto all = hpx::lcos::broadcast<getWorkerSummaries_act>(locs).get();
+
+  auto ms = [](std::uint64_t ns) { return ns / 1e6; };
+
+  std::vector<std::uint64_t> localSteals(latencyBuckets, 0);
+  std::vector<std::uint64_t> distributedSteals(latencyBuckets, 0);
+
+  hpx::cout << "Worker times (ms):\n";
+  hpx::cout << boost::format("%|8| %|6| %|12| %|12| %|12| %|10| %|14|\n")
+      % "Locality" % "Worker" % "Busy" % "GetWork" % "Backoff" % "Tasks" % "Nodes";
+  for (auto l = 0u; l < all.size(); ++l) {
+    for (auto w = 0u; w < all[l].size(); ++w) {
+      auto s = all[l][w];
+      if (l < summaryBaseline.size() && w < summaryBaseline[l].size()) {
+        s = since(s, summaryBaseline[l][w]);
+      }
+      hpx::cout << boost::format("%|8| %|6| %|12.1f| %|12.1f| %|12.1f| %|10| %|14|\n")
+          % hpx::naming::get_locality_id_from_id(locs[l]) % w
+          % ms(s.busy) % ms(s.getWork) % ms(s.backoff) % s.tasks % s.nodes;
+      for (auto i = 0u; i < latencyBuckets; ++i) {
+        localSteals[i] += s.localSteals[i];
+        distributedSteals[i] += s.distributedSteals[i];
+      }
+    }
+  }
+
+  // Only up to the slowest steal seen
+  unsigned buckets = 0;
+  for (auto i = 0u; i < latencyBuckets; ++i) {
+    if (localSteals[i] > 0 || distributedSteals[i] > 0) {
+      buckets = i + 1;
+    }
+  }
+
+  if (buckets > 0) {
+    hpx::cout << "Steal latency (attempts):\n";
+    hpx::cout << boost::format("%|12|") % "";
+    for (auto i = 0u; i < buckets; ++i) {
+      auto label = i + 1 == latencyBuckets ? (boost::format(">=%1%us") % (1u << (i - 1))).str()
+                                           : (boost::format("<%1%us") % (1u << i)).str();
+      hpx::cout << boost::format(" %|10|") % label;
+    }
+    hpx::cout << "\n";
+
+    hpx::cout << boost::format("%|12|") % "local";
+    for (auto i = 0u; i < buckets; ++i) {
+      hpx::cout << boost::format(" %|10|") % localSteals[i];
+    }
+    hpx::cout << "\n";
+
+    hpx::cout << boost::format("%|12|") % "distributed";
+    for (auto i = 0u; i < buckets; ++i) {
+      hpx::cout << boost::format(" %|10|") % distributedSteals[i];
+    }
+    hpx::cout << "\n";
+  }
+  hpx::cout << hpx::flush;
+}
+
+// Resetting an HPX counter moves its baseline rather than clearing the workers'
+// counters, which only their own worker writes
+class Baseline {
+ private:
+  hpx::lcos::local::spinlock mtx;
+  std::vector<std::uint64_t> base;
+
+ public:
+  std::vector<std::int64_t> read(const std::vector<std::uint64_t> & current, bool reset) {
+    std::lock_guard<hpx::lcos::local::spinlock> l(mtx);
+    base.resize(current.size(), 0);
+    std::vector<std::int64_t> res;
+    for (auto i = 0u; i < current.size(); ++i) {
+      res.push_back(current[i] - base[i]);
+    }
+    if (reset) {
+      base = current;
+    }
+    return res;
+  }
+};
+
+// Includes the counters shared by threads that aren't workers
+template <std::atomic<std::uint64_t> WorkerCounters::* Field>
+std::int64_t getTotal(bool reset) {
+  static Baseline baseline;
+  std::uint64_t total = 0;
+  for (auto i = 0u; i <= numWorkers(); ++i) {
+    total += (workerCounters(i).*Field).load(std::memory_order_relaxed);
+  }
+  return baseline.read({total}, reset)[0];
+}
+
+template <std::atomic<std::uint64_t> WorkerCounters::* Field>
+std::vector<std::int64_t> getPerWorker(bool reset) {
+  static Baseline baseline;
+  std::vector<std::uint64_t> values;
+  for (auto i = 0u; i < numWorkers(); ++i) {
+    values.push_back((workerCounters(i).*Field).load(std::memory_order_relaxed));
+  }
+  return baseline.read(values, reset);
+}
+
+template <std::array<std::atomic<std::uint64_t>, latencyBuckets> WorkerCounters::* Field>
+std::vector<std::int64_t> getLatencies(bool reset) {
+  static Baseline baseline;
+  std::vector<std::uint64_t> values(latencyBuckets, 0);
+  for (auto i = 0u; i <= numWorkers(); ++i) {
+    for (auto b = 0u; b < latencyBuckets; ++b) {
+      values[b] += (workerCounters(i).*Field)[b].load(std::memory_order_relaxed);
+    }
+  }
+  return baseline.read(values, reset);
+}
+
+void registerPerformanceCounters() {
+  hpx::performance_counters::install_counter_type(
+      "/workstealing/Scheduler/busyTime",
+      &getTotal<&WorkerCounters::busy>,
+      "Returns the time workers on this locality spent running tasks",
+      "ns");
+
+  hpx::performance_counters::install_counter_type(
+      "/workstealing/Scheduler/getWorkTime",
+      &getTotal<&WorkerCounters::getWork>,
+      "Returns the time workers on this locality spent looking for work (including steals)",
+      "ns");
+
+  hpx::performance_counters::install_counter_type(
+      "/workstealing/Scheduler/backoffTime",
+      &getTotal<&WorkerCounters::backoff>,
+      "Returns the time workers on this locality spent sleeping after failing to find work",
+      "ns");
+
+  hpx::performance_counters::install_counter_type(
+      "/workstealing/Scheduler/tasks",
+      &getTotal<&WorkerCounters::tasks>,
+      "Returns the number of tasks run on this locality");
+
+  hpx::performance_counters::install_counter_type(
+      "/workstealing/Scheduler/nodes",
+      &getTotal<&WorkerCounters::nodes>,
+      "Returns the number of search nodes processed on this locality (needs yewpar.count_nodes=1)");
+
+  hpx::performance_counters::install_counter_type(
+      "/workstealing/Scheduler/busyTimePerWorker",
+      &getPerWorker<&WorkerCounters::busy>,
+      "Returns the time each worker on this locality spent running tasks",
+      "ns");
+
+  hpx::performance_counters::install_counter_type(
+      "/workstealing/Scheduler/getWorkTimePerWorker",
+      &getPerWorker<&WorkerCounters::getWork>,
+      "Returns the time each worker on this locality spent looking for work",
+      "ns");
+
+  hpx::performance_counters::install_counter_type(
+      "/workstealing/Scheduler/backoffTimePerWorker",
+      &getPerWorker<&WorkerCounters::backoff>,
+      "Returns the time each worker on this locality spent sleeping after failing to find work",
+      "ns");
+
+  hpx::performance_counters::install_counter_type(
+      "/workstealing/Scheduler/nodesPerWorker",
+      &getPerWorker<&WorkerCounters::nodes>,
+      "Returns the number of search nodes processed by each worker on this locality (needs yewpar.count_nodes=1)");
+
+  hpx::performance_counters::install_counter_type(
+      "/workstealing/Scheduler/localStealLatency",
+      &getLatencies<&WorkerCounters::localSteals>,
+      "Returns a histogram of local steal attempt times, bucketed by powers of two microseconds");
+
+  hpx::performance_counters::install_counter_type(
+      "/workstealing/Scheduler/distributedStealLatency",
+      &getLatencies<&WorkerCounters::distributedSteals>,
+      "Returns a histogram of distributed steal attempt times, bucketed by powers of two microseconds");
+}
+
+}}
@@ -0,0 +1,204 @@
+#ifndef YEWPAR_SCHEDULERPERF_HPP
+#define YEWPAR_SCHEDULERPERF_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "hpx/runtime/actions/plain_action.hpp"
+#include "hpx/runtime/get_os_thread_count.hpp"
+#include "hpx/runtime/get_worker_thread_num.hpp"
+#include "hpx/runtime/serialization/vector.hpp"
+
+namespace Workstealing { namespace SchedulerPerf {
+
+// Time based accounting of the schedulers: how long each worker (OS thread)
+// spends running tasks, asking its policy for work (getWork, including steals),
+// and sleeping in the backoff after failing to get any. Nodes processed per
+// worker and the round trip time of every steal attempt are also recorded, so
+// poor scaling can be put down to starvation, contention or overhead.
+//
+// Each worker only ever writes its own counters, so updates are plain relaxed
+// stores rather than atomic read-modify-writes (except for the counters shared
+// by threads that aren't workers). Readers may see values a little out of date
+// while a search runs.
+//
+// Nodes are only counted when asked for, as this is once per node rather than
+// once per task: with worker stats (MoreVerbose) or, e.g. for the performance
+// counters, with --hpx:ini=yewpar.count_nodes=1. Seq doesn't run on the
+// schedulers so its nodes are never counted.
+
+using Clock = std::chrono::steady_clock;
+
+// Steal latencies are bucketed by powers of two microseconds: bucket 0 is under
+// 1us, bucket b under 2^b us, and the last bucket takes everything slower
+static constexpr unsigned latencyBuckets = 20;
+
+struct alignas(64) WorkerCounters {
+  // Nanoseconds
+  std::atomic<std::uint64_t> busy;
+  std::atomic<std::uint64_t> getWork;
+  std::atomic<std::uint64_t> backoff;
+
+  std::atomic<std::uint64_t> tasks;
+  std::atomic<std::uint64_t> nodes;
+  // getWork calls that found nothing
+  std::atomic<std::uint64_t> failedGets;
+
+  std::array<std::atomic<std::uint64_t>, latencyBuckets> localSteals;
+  std::array<std::atomic<std::uint64_t>, latencyBuckets> distributedSteals;
+
+  WorkerCounters() : busy(0), getWork(0), backoff(0), tasks(0), nodes(0), failedGets(0) {
+    for (auto & c : localSteals) { c.store(0); }
+    for (auto & c : distributedSteals) { c.store(0); }
+  }
+};
+
+namespace detail {
+inline std::once_flag allocated;
+inline std::size_t numWorkers = 0;
+inline std::unique_ptr<WorkerCounters[]> counters;
+
+// Threads that aren't HPX workers share one extra set of counters at the end
+inline void allocate() {
+  std::call_once(allocated, []() {
+    numWorkers = hpx::get_os_thread_count();
+    counters.reset(new WorkerCounters[numWorkers + 1]);
+  });
+}
+
+inline thread_local WorkerCounters * current = nullptr;
+
+inline std::atomic<bool> countNodes(false);
+
+// Only the calling thread writes its own worker's counters, but threads that
+// aren't workers share theirs so must update them atomically
+inline void add(std::atomic<std::uint64_t> & c, std::uint64_t v) {
+  if (current == &counters[numWorkers]) {
+    c.fetch_add(v, std::memory_order_relaxed);
+  } else {
+    c.store(c.load(std::memory_order_relaxed) + v, std::memory_order_relaxed);
+  }
+}
+}
+
+inline std::size_t numWorkers() {
+  detail::allocate();
+  return detail::numWorkers;
+}
+
+inline WorkerCounters & workerCounters(std::size_t worker) {
+  detail::allocate();
+  return detail::counters[worker < detail::numWorkers ? worker : detail::numWorkers];
+}
+
+// Counters of the calling worker
+inline WorkerCounters & local() {
+  if (!detail::current) {
+    detail::current = &workerCounters(hpx::get_worker_thread_num());
+  }
+  return *detail::current;
+}
+
+inline std::uint64_t elapsedNs(Clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+}
+
+inline unsigned latencyBucket(std::uint64_t ns) {
+  auto us = ns / 1000;
+  unsigned b = 0;
+  while (us > 0 && b < latencyBuckets - 1) {
+    us >>= 1;
+    ++b;
+  }
+  return b;
+}
+
+inline bool countingNodes() {
+  return detail::countNodes.load(std::memory_order_relaxed);
+}
+
+inline void countNode() {
+  detail::add(local().nodes, 1);
+}
+
+// Turn node counting on or off on this locality for the next search (it is
+// always on with yewpar.count_nodes=1)
+void setNodeCounts(bool on);
+HPX_DEFINE_PLAIN_ACTION(setNodeCounts, setNodeCounts_act);
+
+inline void addBusy(std::uint64_t ns) {
+  auto & c = local();
+  detail::add(c.busy, ns);
+  detail::add(c.tasks, 1);
+}
+
+inline void addGetWork(std::uint64_t ns) {
+  detail::add(local().getWork, ns);
+}
+
+inline void addBackoff(std::uint64_t ns) {
+  detail::add(local().backoff, ns);
+}
+
+inline void countFailedGetWork() {
+  detail::add(local().failedGets, 1);
+}
+
+// Times any worker on this locality has looked for work and found none
+inline std::uint64_t localFailedGets() {
+  std::uint64_t total = 0;
+  for (auto i = 0u; i <= numWorkers(); ++i) {
+    total += detail::counters[i].failedGets.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+inline void recordSteal(bool distributed, std::uint64_t ns) {
+  auto & c = local();
+  auto b = latencyBucket(ns);
+  detail::add(distributed ? c.distributedSteals[b] : c.localSteals[b], 1);
+}
+
+// A worker's counters as plain values, for sending to the master locality
+struct WorkerSummary {
+  std::uint64_t busy = 0;
+  std::uint64_t getWork = 0;
+  std::uint64_t backoff = 0;
+  std::uint64_t tasks = 0;
+  std::uint64_t nodes = 0;
+  std::vector<std::uint64_t> localSteals;
+  std::vector<std::uint64_t> distributedSteals;
+
+  template <class Archive>
+  void serialize(Archive & ar, const unsigned int version) {
+    ar & busy;
+    ar & getWork;
+    ar & backoff;
+    ar & tasks;
+    ar & nodes;
+    ar & localSteals;
+    ar & distributedSteals;
+  }
+};
+
+std::vector<WorkerSummary> getWorkerSummaries();
+HPX_DEFINE_PLAIN_ACTION(getWorkerSummaries, getWorkerSummaries_act);
+
+// Remember every locality's counters so printSummary only covers what follows
+// (on the master locality)
+void startSummary();
+
+// Print each worker's time split and the steal latency histograms since
+// startSummary (on the master locality)
+void printSummary();
+
+void registerPerformanceCounters();
+
+}}
+
+#endif
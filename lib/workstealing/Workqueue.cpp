@@ -34,7 +34,12 @@ namespace workstealing
   }
 
   void Workqueue::addWork(funcType task) {
-    tasks.push_left(task);
+    tasks.push_left(std::move(task));
+  }
+
+  void Workqueue::clear() {
+    funcType task;
+    while (tasks.pop_left(task)) {}
   }
 }
 HPX_REGISTER_COMPONENT_MODULE();
@@ -46,3 +51,4 @@ HPX_REGISTER_COMPONENT(Workqueue_type, Workqueue);
 HPX_REGISTER_ACTION(workstealing::Workqueue::getLocal_action, Workqueue_getLocal_action);
 HPX_REGISTER_ACTION(workstealing::Workqueue::steal_action, Workqueue_steal_action);
 HPX_REGISTER_ACTION(workstealing::Workqueue::addWork_action, Workqueue_addWork_action);
+HPX_REGISTER_ACTION(workstealing::Workqueue::clear_action, Workqueue_clear_action);
@@ -28,11 +28,14 @@ namespace workstealing
       HPX_DEFINE_COMPONENT_ACTION(Workqueue, steal);
       void addWork(funcType task);
       HPX_DEFINE_COMPONENT_ACTION(Workqueue, addWork);
+      void clear();
+      HPX_DEFINE_COMPONENT_ACTION(Workqueue, clear);
     };
 }
 
 HPX_REGISTER_ACTION_DECLARATION(workstealing::Workqueue::getLocal_action, Workqueue_getLocal_action);
 HPX_REGISTER_ACTION_DECLARATION(workstealing::Workqueue::steal_action, Workqueue_steal_action);
 HPX_REGISTER_ACTION_DECLARATION(workstealing::Workqueue::addWork_action, Workqueue_addWork_action);
+HPX_REGISTER_ACTION_DECLARATION(workstealing::Workqueue::clear_action, Workqueue_clear_action);
 
 #endif
@@ -2,11 +2,14 @@
 
 #include <hpx/util/function.hpp>
 #include <hpx/runtime/find_here.hpp>
+#include <hpx/runtime/get_ptr.hpp>
 #include <hpx/performance_counters/manage_counter_type.hpp>
 
 #include <memory>
 
 #include "util/util.hpp"
+#include "workstealing/SchedulerPerf.hpp"
+#include "util/Trace.hpp"
 
 namespace Workstealing { namespace Policies {
 
@@ -66,6 +69,7 @@ void registerPerformanceCounters() {
 
 DepthPoolPolicy::DepthPoolPolicy(hpx::naming::id_type workpool) {
   local_workpool = workpool;
+  local_pool = hpx::get_ptr<workstealing::DepthPool>(workpool).get();
   last_remote = hpx::find_here();
 
   std::random_device rd;
@@ -76,7 +80,10 @@ hpx::util::function<void(), false> DepthPoolPolicy::getWork() {
   std::unique_lock<mutex_t> l(mtx);
 
   hpx::util::function<void(hpx::naming::id_type)> task;
-  task = hpx::async<workstealing::DepthPool::getLocal_action>(local_workpool).get();
+  auto stealStart = SchedulerPerf::Clock::now();
+  task = local_pool->getLocal();
+  SchedulerPerf::recordSteal(false, SchedulerPerf::elapsedNs(stealStart));
+  YewPar::Trace::steal(task ? 1 : 0);
 
   if (task) {
     DepthPoolPolicyPerf::perf_localSteals++;
@@ -88,7 +95,10 @@ hpx::util::function<void(), false> DepthPoolPolicy::getWork() {
   if (!distributed_workpools.empty()) {
     // Last steal optimisation
     if (last_remote != hpx::find_here()) {
+      stealStart = SchedulerPerf::Clock::now();
       task = hpx::async<workstealing::DepthPool::steal_action>(last_remote).get();
+      SchedulerPerf::recordSteal(true, SchedulerPerf::elapsedNs(stealStart));
+      YewPar::Trace::steal(last_remote, task ? 1 : 0);
       if (task) {
         DepthPoolPolicyPerf::perf_distributedSteals++;
         return hpx::util::bind(task, hpx::find_here());
@@ -102,7 +112,10 @@ hpx::util::function<void(), false> DepthPoolPolicy::getWork() {
     std::uniform_int_distribution<int> rand(0, distributed_workpools.size() - 1);
     auto victim = distributed_workpools.begin();
     std::advance(victim, rand(randGenerator));
+    stealStart = SchedulerPerf::Clock::now();
     task = hpx::async<workstealing::DepthPool::steal_action>(*victim).get();
+    SchedulerPerf::recordSteal(true, SchedulerPerf::elapsedNs(stealStart));
+    YewPar::Trace::steal(*victim, task ? 1 : 0);
 
     if (task) {
       last_remote = *victim;
@@ -119,7 +132,12 @@ hpx::util::function<void(), false> DepthPoolPolicy::getWork() {
 void DepthPoolPolicy::addwork(hpx::util::function<void(hpx::naming::id_type)> task, unsigned depth) {
   std::unique_lock<mutex_t> l(mtx);
   DepthPoolPolicyPerf::perf_spawns++;
-  hpx::apply<workstealing::DepthPool::addWork_action>(local_workpool, task, depth);
+  YewPar::Trace::spawn(depth);
+  local_pool->addWork(std::move(task), depth);
+}
+
+void DepthPoolPolicy::cancel() {
+  hpx::apply<workstealing::DepthPool::clear_action>(local_workpool);
 }
 
 void DepthPoolPolicy::registerDistributedDepthPools(std::vector<hpx::naming::id_type> workpools) {
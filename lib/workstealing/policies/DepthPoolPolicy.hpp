@@ -14,11 +14,10 @@
 
 #include "../DepthPool.hpp"
 
+#include <memory>
 #include <random>
 #include <vector>
 
-namespace Workstealing { namespace Scheduler {extern std::shared_ptr<Policy> local_policy; }}
-
 namespace Workstealing { namespace Policies {
 
 namespace DepthPoolPolicyPerf {
@@ -31,6 +30,8 @@ class DepthPoolPolicy : public Policy {
 
  private:
   hpx::naming::id_type local_workpool;
+  // Local spawns and takes use the pool directly rather than through actions
+  std::shared_ptr<workstealing::DepthPool> local_pool;
   hpx::naming::id_type last_remote;
   std::vector<hpx::naming::id_type> distributed_workpools;
 
@@ -48,6 +49,8 @@ class DepthPoolPolicy : public Policy {
 
   void addwork(hpx::util::function<void(hpx::naming::id_type)> task, unsigned depth);
 
+  void cancel() override;
+
   void registerDistributedDepthPools(std::vector<hpx::naming::id_type> workpools);
 
   static void setDepthPool(hpx::naming::id_type localworkpool) {
@@ -1,12 +1,24 @@
 #ifndef YEWPAR_POLICY_HPP
 #define YEWPAR_POLICY_HPP
 
+#include <memory>
+
 #include <hpx/util/function.hpp>
 
 class Policy {
  public:
   // Scheduler hook point
   virtual hpx::util::function<void(), false> getWork() = 0;
+
+  // Called when the search is cancelled, queued work may be dropped
+  virtual void cancel() {}
 };
 
+namespace Workstealing { namespace Scheduler {
+
+// Implementation policy of this locality's schedulers
+inline std::shared_ptr<Policy> local_policy;
+
+}}
+
 #endif
@@ -8,8 +8,8 @@
 
 #include "Policy.hpp"
 #include "workstealing/PriorityWorkqueue.hpp"
-
-namespace Workstealing { namespace Scheduler {extern std::shared_ptr<Policy> local_policy; }}
+#include "workstealing/SchedulerPerf.hpp"
+#include "util/Trace.hpp"
 
 namespace Workstealing { namespace Policies {
 
@@ -39,7 +39,11 @@ class PriorityOrderedPolicy : public Policy {
     std::unique_lock<mutex_t> l(mtx);
 
     hpx::util::function<void(hpx::naming::id_type)> task;
+    auto stealStart = SchedulerPerf::Clock::now();
     task = hpx::async<workstealing::PriorityWorkqueue::steal_action>(globalWorkqueue).get();
+    SchedulerPerf::recordSteal(hpx::naming::get_locality_id_from_id(globalWorkqueue) != hpx::get_locality_id(),
+                               SchedulerPerf::elapsedNs(stealStart));
+    YewPar::Trace::steal(globalWorkqueue, task ? 1 : 0);
     if (task) {
       PriorityOrderedPerf::perf_steals++;
       return hpx::util::bind(task, hpx::find_here());
@@ -52,7 +56,13 @@ class PriorityOrderedPolicy : public Policy {
   void addwork(int priority, hpx::util::function<void(hpx::naming::id_type)> task) {
     std::unique_lock<mutex_t> l(mtx);
     PriorityOrderedPerf::perf_spawns++;
-    hpx::apply<workstealing::PriorityWorkqueue::addWork_action>(globalWorkqueue, priority, task);
+    YewPar::Trace::spawn(YewPar::Trace::none, priority);
+    hpx::apply<workstealing::PriorityWorkqueue::addWork_action>(globalWorkqueue, priority, std::move(task));
+  }
+
+  // The queue is shared, so every locality cancelling clears it again
+  void cancel() override {
+    hpx::apply<workstealing::PriorityWorkqueue::clear_action>(globalWorkqueue);
   }
 
   hpx::future<bool> workRemaining() {
@@ -2,9 +2,6 @@
 #include "hpx/runtime/components/component_factory_base.hpp"  // for HPX_REG...
 #include "hpx/runtime/components/static_factory_data.hpp"     // for static_...
 
-#include <hpx/include/iostreams.hpp>
-#include <boost/format.hpp>
-
 HPX_REGISTER_COMPONENT_MODULE();
 
 namespace Workstealing { namespace Policies { namespace SearchManagerPerf {
@@ -46,26 +43,4 @@ void registerPerformanceCounters() {
                                                   );
 }
 
-// Debugging information that doesn't fit a counter format
-void printDistributedStealsList() {
-  for (const auto &p : distributedStealsList) {
-    hpx::cout
-        << (boost::format("Steal %1% - %2% , success: %3%")
-            % static_cast<std::int64_t>(hpx::get_locality_id())
-            % static_cast<std::int64_t>(hpx::naming::get_locality_id_from_id(p.first))
-            % p.second)
-        << hpx::endl;
-  }
-}
-
-void printChunkSizeList() {
-  for (const auto &c : chunkSizeList) {
-    hpx::cout
-        << (boost::format("%1% Stole Chunk of Size %2%")
-            % static_cast<std::int64_t>(hpx::get_locality_id())
-            % c)
-        << hpx::endl;
-  }
-}
-
 }}}
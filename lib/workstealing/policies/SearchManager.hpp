@@ -1,6 +1,7 @@
 #ifndef YEWPAR_SEARCHMANAGER_COMPONENT_HPP
 #define YEWPAR_SEARCHMANAGER_COMPONENT_HPP
 
+#include <algorithm>
 #include <iterator>                                              // for advance
 #include <memory>                                                // for allo...
 #include <random>                                                // for defa...
@@ -47,8 +48,8 @@
 
 #include "Policy.hpp"
 #include "util/util.hpp"
-
-namespace Workstealing { namespace Scheduler {extern std::shared_ptr<Policy> local_policy; }}
+#include "workstealing/SchedulerPerf.hpp"
+#include "util/Trace.hpp"
 
 namespace Workstealing { namespace Policies {
 
@@ -59,18 +60,8 @@ std::atomic<std::uint64_t> perf_distributedSteals(0);
 std::atomic<std::uint64_t> perf_failedLocalSteals(0);
 std::atomic<std::uint64_t> perf_failedDistributedSteals(0);
 
-std::vector<std::pair<hpx::naming::id_type, bool> > distributedStealsList;
-
-std::vector<std::uint32_t> chunkSizeList;
-
 void registerPerformanceCounters();
 
-void printDistributedStealsList();
-HPX_DEFINE_PLAIN_ACTION(printDistributedStealsList, printDistributedStealsList_act);
-
-void printChunkSizeList();
-HPX_DEFINE_PLAIN_ACTION(printChunkSizeList, printChunkSizeList_act);
-
 }}}
 
 namespace Workstealing { namespace Policies {
@@ -107,7 +98,7 @@ struct SearchManager : public hpx::components::component_base<SearchManager> {
    private:
 
     // Information returned on a steal from a thread
-    using Task = hpx::util::tuple<SearchInfo, int, hpx::naming::id_type>;
+    using Task = hpx::util::tuple<SearchInfo, int>;
 
     // We return an empty vector here to signal no tasks
     using Response = std::vector<Task>;
@@ -143,6 +134,36 @@ struct SearchManager : public hpx::components::component_base<SearchManager> {
     // Last steal optimisation
     hpx::naming::id_type last_remote;
 
+    // Eagerly spawned (seeded) tasks indexed by depth, as in the DepthPool. Local
+    // work comes from the deepest level and steals from the shallowest
+    std::vector<std::queue<Task> > seeds;
+    int deepestSeed = -1;
+
+    // Must hold mtx
+    bool popSeed(Task & task, const bool shallowest) {
+      if (deepestSeed < 0) {
+        return false;
+      }
+
+      if (shallowest) {
+        for (auto i = 0; i <= deepestSeed; ++i) {
+          if (!seeds[i].empty()) {
+            task = std::move(seeds[i].front());
+            seeds[i].pop();
+            break;
+          }
+        }
+      } else {
+        task = std::move(seeds[deepestSeed].front());
+        seeds[deepestSeed].pop();
+      }
+
+      while (deepestSeed >= 0 && seeds[deepestSeed].empty()) {
+        --deepestSeed;
+      }
+      return true;
+    }
+
     // Try to steal from a thread on another (random) locality
     Response tryDistributedSteal(std::unique_lock<MutexT> & l) {
       // We only allow one distributed steal to happen at a time (to make sure we
@@ -166,16 +187,17 @@ struct SearchManager : public hpx::components::component_base<SearchManager> {
       }
 
       l.unlock();
+      auto stealStart = SchedulerPerf::Clock::now();
       auto res = hpx::async<GetDistributedWorkAct<SearchInfo, FuncToCall, Args...> >(victim).get();
+      SchedulerPerf::recordSteal(true, SchedulerPerf::elapsedNs(stealStart));
       l.lock();
 
       isStealingDistributed = false;
 
+      YewPar::Trace::steal(victim, res.size());
       if (!res.empty()) {
-        SearchManagerPerf::distributedStealsList.push_back(std::make_pair(victim, true));
         last_remote = victim;
       } else {
-        SearchManagerPerf::distributedStealsList.push_back(std::make_pair(victim, false));
         last_remote = hpx::find_here();
       }
 
@@ -208,6 +230,10 @@ struct SearchManager : public hpx::components::component_base<SearchManager> {
     // back up for serializing over the network
     Response getDistributedWork() {
       std::unique_lock<MutexT> l(mtx);
+      Task task;
+      if (popSeed(task, true)) {
+        return {task};
+      }
       return getLocalWork(l);
     }
 
@@ -256,9 +282,16 @@ struct SearchManager : public hpx::components::component_base<SearchManager> {
       // Return from task buffer first if anything exists
       Task task;
       if (taskBuffer.pop_right(task)) {
-        SearchInfo searchInfo; int depth; hpx::naming::id_type prom;
-        hpx::util::tie(searchInfo, depth, prom) = task;
-        return hpx::util::bind(FuncToCall::fn_ptr(), searchInfo, depth, prom);
+        SearchInfo searchInfo; int depth;
+        hpx::util::tie(searchInfo, depth) = task;
+        return hpx::util::bind(FuncToCall::fn_ptr(), std::move(searchInfo), depth);
+      }
+
+      // Then any seeded tasks, before interrupting running threads
+      if (popSeed(task, false)) {
+        SearchInfo searchInfo; int depth;
+        hpx::util::tie(searchInfo, depth) = task;
+        return hpx::util::bind(FuncToCall::fn_ptr(), std::move(searchInfo), depth);
       }
 
       Response maybeStolen;
@@ -277,7 +310,10 @@ struct SearchManager : public hpx::components::component_base<SearchManager> {
           return nullptr;
         }
       } else {
+        auto stealStart = SchedulerPerf::Clock::now();
         maybeStolen = getLocalWork(l);
+        SchedulerPerf::recordSteal(false, SchedulerPerf::elapsedNs(stealStart));
+        YewPar::Trace::steal(maybeStolen.size());
         if (!maybeStolen.empty()) {
           SearchManagerPerf::perf_localSteals++;
         } else {
@@ -287,12 +323,10 @@ struct SearchManager : public hpx::components::component_base<SearchManager> {
       }
 
       if (!maybeStolen.empty()) {
-        SearchManagerPerf::chunkSizeList.emplace_back(maybeStolen.size());
-
         // Take off the first task and queue up anything else that was returned
         auto first = maybeStolen[0];
-        SearchInfo searchInfo; int depth; hpx::naming::id_type prom;
-        hpx::util::tie(searchInfo, depth, prom) = first;
+        SearchInfo searchInfo; int depth;
+        hpx::util::tie(searchInfo, depth) = first;
 
         auto itr = maybeStolen.begin();
         ++itr;
@@ -300,8 +334,31 @@ struct SearchManager : public hpx::components::component_base<SearchManager> {
           taskBuffer.push_left(std::move(*itr));
         }
 
-        return hpx::util::bind(FuncToCall::fn_ptr(), searchInfo, depth, prom);
+        return hpx::util::bind(FuncToCall::fn_ptr(), std::move(searchInfo), depth);
+      }
+    }
+
+    // Drop any chunked tasks still waiting to run. Running threads stop
+    // themselves (answering any in-flight steal) once they see the stop flag
+    void cancel() override {
+      Task task;
+      while (taskBuffer.pop_right(task)) {}
+
+      std::lock_guard<MutexT> l(mtx);
+      seeds.clear();
+      deepestSeed = -1;
+    }
+
+    // Seed a task to run at depth (for skeletons that spawn eagerly before
+    // stealing from stacks). The caller must count it with Termination::taskCreated
+    void addwork(SearchInfo searchInfo, const int depth) {
+      std::lock_guard<MutexT> l(mtx);
+      if (depth >= static_cast<int>(seeds.size())) {
+        seeds.resize(depth + 1);
       }
+      YewPar::Trace::spawn(depth);
+      seeds[depth].push(hpx::util::make_tuple(std::move(searchInfo), depth));
+      deepestSeed = std::max(deepestSeed, depth);
     }
 
     // Signal the searchManager that a local thread is now finished working and should be removed from active
@@ -313,7 +370,7 @@ struct SearchManager : public hpx::components::component_base<SearchManager> {
         // A steal must be in progress on this id so cancel it before finishing
         // Canceled steals (-1 flag) are already removed from active
         auto & state = inactive[activeId];
-        std::vector<Task> noSteal {hpx::util::make_tuple(SearchInfo(), -1, hpx::find_here())};
+        std::vector<Task> noSteal {hpx::util::make_tuple(SearchInfo(), -1)};
         std::get<1>(*state).set(noSteal);
         inactive.erase(activeId);
       }
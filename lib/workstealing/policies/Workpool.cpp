@@ -2,11 +2,14 @@
 
 #include <hpx/util/function.hpp>
 #include <hpx/runtime/find_here.hpp>
+#include <hpx/runtime/get_ptr.hpp>
 #include <hpx/performance_counters/manage_counter_type.hpp>
 
 #include <memory>
 
 #include "util/util.hpp"
+#include "workstealing/SchedulerPerf.hpp"
+#include "util/Trace.hpp"
 
 namespace Workstealing { namespace Policies {
 
@@ -67,6 +70,7 @@ void registerPerformanceCounters() {
 
 Workpool::Workpool(hpx::naming::id_type localQueue) {
   local_workqueue = localQueue;
+  local_queue = hpx::get_ptr<workstealing::Workqueue>(localQueue).get();
   last_remote = hpx::find_here();
 
   std::random_device rd;
@@ -77,7 +81,10 @@ hpx::util::function<void(), false> Workpool::getWork() {
   std::unique_lock<mutex_t> l(mtx);
 
   hpx::util::function<void(hpx::naming::id_type)> task;
-  task = hpx::async<workstealing::Workqueue::getLocal_action>(local_workqueue).get();
+  auto stealStart = SchedulerPerf::Clock::now();
+  task = local_queue->getLocal();
+  SchedulerPerf::recordSteal(false, SchedulerPerf::elapsedNs(stealStart));
+  YewPar::Trace::steal(task ? 1 : 0);
 
   if (task) {
     WorkpoolPerf::perf_localSteals++;
@@ -89,7 +96,10 @@ hpx::util::function<void(), false> Workpool::getWork() {
   if (!distributed_workqueues.empty()) {
     // Last steal optimisation
     if (last_remote != hpx::find_here()) {
+      stealStart = SchedulerPerf::Clock::now();
       task = hpx::async<workstealing::Workqueue::steal_action>(last_remote).get();
+      SchedulerPerf::recordSteal(true, SchedulerPerf::elapsedNs(stealStart));
+      YewPar::Trace::steal(last_remote, task ? 1 : 0);
       if (task) {
         WorkpoolPerf::perf_distributedSteals++;
         return hpx::util::bind(task, hpx::find_here());
@@ -103,7 +113,10 @@ hpx::util::function<void(), false> Workpool::getWork() {
     std::uniform_int_distribution<int> rand(0, distributed_workqueues.size() - 1);
     auto victim = distributed_workqueues.begin();
     std::advance(victim, rand(randGenerator));
+    stealStart = SchedulerPerf::Clock::now();
     task = hpx::async<workstealing::Workqueue::steal_action>(*victim).get();
+    SchedulerPerf::recordSteal(true, SchedulerPerf::elapsedNs(stealStart));
+    YewPar::Trace::steal(*victim, task ? 1 : 0);
 
     if (task) {
       last_remote = *victim;
@@ -120,7 +133,12 @@ hpx::util::function<void(), false> Workpool::getWork() {
 void Workpool::addwork(hpx::util::function<void(hpx::naming::id_type)> task) {
   std::unique_lock<mutex_t> l(mtx);
   WorkpoolPerf::perf_spawns++;
-  hpx::apply<workstealing::Workqueue::addWork_action>(local_workqueue, task);
+  YewPar::Trace::spawn(YewPar::Trace::none);
+  local_queue->addWork(std::move(task));
+}
+
+void Workpool::cancel() {
+  hpx::apply<workstealing::Workqueue::clear_action>(local_workqueue);
 }
 
 void Workpool::registerDistributedWorkqueues(std::vector<hpx::naming::id_type> workqueues) {
@@ -14,11 +14,10 @@
 
 #include "workstealing/Workqueue.hpp"
 
+#include <memory>
 #include <random>
 #include <vector>
 
-namespace Workstealing { namespace Scheduler {extern std::shared_ptr<Policy> local_policy; }}
-
 namespace Workstealing { namespace Policies {
 
 namespace WorkpoolPerf {
@@ -28,8 +27,9 @@ void registerPerformanceCounters();
 class Workpool : public Policy {
 
  private:
-  // TODO: Pointer to local_workqueue instead of calling actions from the local version
   hpx::naming::id_type local_workqueue;
+  // Local spawns and takes use the queue directly rather than through actions
+  std::shared_ptr<workstealing::Workqueue> local_queue;
   hpx::naming::id_type last_remote;
   std::vector<hpx::naming::id_type> distributed_workqueues;
 
@@ -48,6 +48,8 @@ class Workpool : public Policy {
 
   void addwork(hpx::util::function<void(hpx::naming::id_type)> task);
 
+  void cancel() override;
+
   void registerDistributedWorkqueues(std::vector<hpx::naming::id_type> workqueues);
 
   static void setWorkqueue(hpx::naming::id_type localWorkqueue) {